@@ -0,0 +1,152 @@
+#pragma once
+
+#include <unordered_map>
+#include "Math/Geometry/AABBRect.hpp"
+#include "Math/Collision/Raycast.hpp"
+#include "Math/Collision/CollisionFilter.hpp"
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            class AABBTree
+            {
+            private:
+                struct Bounds
+                {
+                    double left = 0;
+                    double top = 0;
+                    double right = 0;
+                    double bottom = 0;
+                };
+
+                // 节点存放在连续的节点池中,以下标互相引用
+                struct Node
+                {
+                    Bounds bounds;
+                    size_t parent = 0;
+                    size_t children[2] = {0, 0};
+                    // 叶节点对应的对象下标,非叶节点为NULL_NODE
+                    size_t object = 0;
+                    // 叶节点高度为0,空闲节点为-1
+                    int height = -1;
+
+                    bool is_leaf() const;
+                };
+
+                std::vector<Node> _nodes;
+                std::vector<size_t> _free_nodes;
+                size_t _root = NULL_NODE;
+                std::vector<Geometry::GeometryObject *> _objects;
+                // 对象实际的AABB矩形,叶节点中保存的是扩大后的边界
+                std::vector<Geometry::AABBRect> _rects;
+                std::vector<size_t> _leaves;
+                std::vector<size_t> _free_indexs;
+                std::unordered_map<Geometry::GeometryObject *, size_t> _indexs;
+                // 以句柄为下标的碰撞层,在宽相位中先于GJK检测筛选对象对
+                CollisionFilter _filter;
+                // 叶节点矩形相对对象尺寸的扩大比例
+                double _margin = 0.1;
+
+                static double perimeter(const Bounds &bounds);
+
+                static Bounds merge(const Bounds &bounds0, const Bounds &bounds1);
+
+                static bool is_contained(const Bounds &outer, const Bounds &inner);
+
+                static bool is_overlapped(const Bounds &bounds0, const Bounds &bounds1);
+
+                static Bounds to_bounds(const Geometry::AABBRect &rect);
+
+                Bounds fatten(const Bounds &bounds) const;
+
+                size_t allocate_node();
+
+                void free_node(const size_t node);
+
+                void insert_leaf(const size_t leaf);
+
+                void remove_leaf(const size_t leaf);
+
+                size_t balance(const size_t node);
+
+                void insert_object(const size_t index);
+
+                // 自顶向下按中位数二分构建整棵树
+                size_t build_nodes(std::vector<size_t> &leaves, const size_t begin, const size_t end);
+
+                void rebuild();
+
+                void collect_candidates(const Bounds &bounds, std::vector<size_t> &indexs, std::vector<size_t> &nodes) const;
+
+                // narrow为false时只做AABB检测
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat, const bool narrow) const;
+
+            public:
+                static constexpr size_t NULL_NODE = static_cast<size_t>(-1);
+
+                AABBTree();
+
+                AABBTree(const std::vector<Geometry::GeometryObject *> &objects);
+
+                AABBTree(const std::initializer_list<Geometry::GeometryObject *> &objects);
+
+                AABBTree(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
+                void build(const std::vector<Geometry::GeometryObject *> &objects);
+
+                void build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
+                void build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects);
+
+                // 返回对象的句柄,对象删除前句柄保持不变
+                size_t append(Geometry::GeometryObject *object);
+
+                void remove(Geometry::GeometryObject *object);
+
+                // 对象仍在扩大后的矩形内时不调整树结构
+                void update(Geometry::GeometryObject *object);
+
+                void update();
+
+                bool has(Geometry::GeometryObject *object) const;
+
+                void clear();
+
+                double margin() const;
+
+                // 修改扩大比例,对之后插入或移出扩大矩形的对象生效
+                void set_margin(const double value);
+
+                // 树的层数,空树为0
+                int height() const;
+
+                bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const;
+
+                bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
+
+                // 对象不在检测器中时为默认层
+                const CollisionLayer &layer(const Geometry::GeometryObject *object) const;
+
+                // 对象不在检测器中时忽略,build与clear后全部对象恢复为默认层
+                void set_layer(Geometry::GeometryObject *object, const CollisionLayer &layer);
+
+                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const;
+
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const;
+
+                // AABB矩形相交的对象对,不做GJK检测,每对只输出一次
+                bool find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const;
+
+                // 按进入节点的先后顺序访问节点,剩余节点都不早于已找到的交点时停止
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit) const;
+
+                // 射线穿过的全部对象,按t升序追加到hits
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const;
+            };
+        }
+    }
+}
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <tuple>
+#include <algorithm>
 #include "Math/Geometry/AllGeometryObjects.hpp"
+#include "Math/Geometry/Algorithm.hpp"
 
 
 namespace ToyGameEngine
@@ -11,6 +14,11 @@ namespace ToyGameEngine
         {
             void gjk_furthest_point(const Geometry::Polygon &polygon, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result);
 
+            // convex为true时从下标为index的点开始沿投影增大的方向爬山搜索,否则逐点比较投影,返回支撑点的下标
+            // convex由调用者在一次检测开始时确定,不在每次求支撑点时判断
+            size_t gjk_furthest_point(const Geometry::Polygon &polygon, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result,
+                const size_t index, const bool convex);
+
             void gjk_furthest_point(const Geometry::Polyline &polyline, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result);
 
             void gjk_furthest_point(const Geometry::Bezier &bezier, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result);
@@ -25,75 +33,176 @@ namespace ToyGameEngine
 
             void gjk_furthest_point(const Geometry::Point &point, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result);
 
+            // 按对象类型调用对应的gjk_furthest_point
+            void gjk_furthest_point(const Geometry::GeometryObject *object, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result);
+
 
             Geometry::Vector edge_direciton(const Geometry::Point &start, const Geometry::Point &end, const bool to_origin);
 
+            // 线段上距离原点最近的点
+            Geometry::Point closest_to_origin(const Geometry::Point &start, const Geometry::Point &end);
+
 
             bool is_point_inside(const Geometry::Point &point, const Geometry::Polygon &polygon);
 
 
+            // GJK与EPA迭代中的支撑函数
+            template <typename T>
+            class SupportMapping
+            {
+            private:
+                const T &_shape;
+
+            public:
+                SupportMapping(const T &shape)
+                    : _shape(shape) {}
+
+                SupportMapping(const T &shape, size_t &)
+                    : _shape(shape) {}
+
+                void operator()(const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result) const
+                {
+                    Collision::gjk_furthest_point(_shape, start, end, result);
+                }
+            };
+
+            // 保存上次的支撑点下标,相邻两次迭代的方向相近,从上次的支撑点开始只需移动几步
+            template <>
+            class SupportMapping<Geometry::Polygon>
+            {
+            private:
+                const Geometry::Polygon &_polygon;
+                size_t _start = 0;
+                size_t &_index;
+                // 一次检测中多边形不变,构造时确定凸性
+                const bool _convex;
+
+            public:
+                SupportMapping(const Geometry::Polygon &polygon)
+                    : _polygon(polygon), _index(_start), _convex(polygon.is_convex()) {}
+
+                // index保存在调用者处,下次检测同一对象时从该点开始
+                SupportMapping(const Geometry::Polygon &polygon, size_t &index)
+                    : _polygon(polygon), _index(index), _convex(polygon.is_convex()) {}
+
+                void operator()(const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result)
+                {
+                    _index = Collision::gjk_furthest_point(_polygon, start, end, result, _index, _convex);
+                }
+            };
+
+
+            // 同一对对象在相邻两次GJK与EPA之间保存的结果,下次检测从上次的结果开始,对象移动不大时一两次迭代即可结束
+            // directions与axis都是Minkowski差points0 - points1上的方向,使用时两个对象的顺序应与上次相同
+            struct GJKCache
+            {
+                // 上次最后的线段两端对应的搜索方向
+                Geometry::Vector directions[2];
+                // 上次不相交时的分离轴,Minkowski差在该方向上的支撑点投影仍小于0时不必迭代
+                Geometry::Vector axis;
+                // 两个对象上次的支撑点下标
+                size_t indexs[2] = {0, 0};
+                bool separated = false;
+                bool valid = false;
+
+                void clear();
+            };
+
+
             template <typename L, typename R>
-            bool gjk(const L &points0, const R &point1)
+            bool gjk(const L &points0, const R &points1, GJKCache &cache)
             {
-                Geometry::Point start = points0.average_point(), end = points0.average_point(), point0, point1;
+                Collision::SupportMapping<L> support0(points0, cache.indexs[0]);
+                Collision::SupportMapping<R> support1(points1, cache.indexs[1]);
+                Geometry::Point start, end, point0, point1; // end为原点(0,0)
                 Geometry::Triangle triangle, last_triangle;
+                // triangle中各点对应的搜索方向
+                Geometry::Vector directions[3];
                 double distance[3];
 
-                if (start.x == end.x)
+                if (cache.valid)
                 {
-                    start.x += 1;
+                    if (cache.separated)
+                    {
+                        support0(end, cache.axis, point0);
+                        support1(cache.axis, end, point1);
+                        if (cache.axis * (point0 - point1) < 0)
+                        {
+                            return false;
+                        }
+                    }
+                    directions[0] = cache.directions[0];
+                    directions[1] = cache.directions[1];
                 }
-                if (start.y == end.y)
+                else
                 {
-                    start.y += 1;
+                    directions[0].x = directions[0].y = -1;
+                    directions[1].x = directions[1].y = 1;
                 }
-                Collision::gjk_furthest_point(points0, start, end, point0);
-                Collision::gjk_furthest_point(points1, end, start, point1);
+                support0(end, directions[0], point0);
+                support1(directions[0], end, point1);
                 triangle[0] = point0 - point1;
-                Collision::gjk_furthest_point(points0, end, start, point0);
-                Collision::gjk_furthest_point(points1, start, end, point1);
+                support0(end, directions[1], point0);
+                support1(directions[1], end, point1);
                 triangle[1] = point0 - point1;
-                end.clear(); // 现在是原点(0,0)了
-                Geometry::foot_point(triangle[0], triangle[1], end, start, true);
+                if (triangle[0] == triangle[1])
+                {
+                    directions[1].x = -directions[0].x;
+                    directions[1].y = -directions[0].y;
+                    support0(end, directions[1], point0);
+                    support1(directions[1], end, point1);
+                    triangle[1] = point0 - point1;
+                }
+                start = Collision::closest_to_origin(triangle[0], triangle[1]);
+                cache.valid = true;
+                cache.separated = false;
 
                 while (true)
                 {
-                    if (start.x == 0)
-                    {
-                        start.x = 1;
-                    }
-                    if (start.y == 0)
+                    // 原点在线段上,两者接触
+                    if (start.x == 0 && start.y == 0)
                     {
-                        start.y = 1;
+                        cache.directions[0] = directions[0];
+                        cache.directions[1] = directions[1];
+                        return true;
                     }
-                    Collision::gjk_furthest_point(points0, start, end, point0);
-                    Collision::gjk_furthest_point(points1, end, start, point1);
+                    directions[2] = end - start;
+                    support0(start, end, point0);
+                    support1(end, start, point1);
                     triangle[2] = point0 - point1;
 
-                    if (triangle[2] * (point0 - point1) < 0)
+                    // 支撑点在搜索方向上的投影小于0,原点在Minkowski差之外
+                    if (directions[2] * triangle[2] < 0)
                     {
-                        return false;
+                        cache.axis = directions[2];
+                        cache.separated = true;
+                        break;
                     }
 
                     if (Geometry::is_inside(end, triangle, true))
                     {
+                        cache.directions[0] = directions[0];
+                        cache.directions[1] = directions[1];
                         return true;
                     }
                     else if (last_triangle[0] == triangle[0] && last_triangle[1] == triangle[1]
                         && last_triangle[2] == triangle[2])
                     {
-                        return false;
+                        cache.axis = directions[2];
+                        cache.separated = true;
+                        break;
                     }
 
-                    distance[0] = Geometry::distance_square(end, triangle[0], triangle[1], true);
-                    distance[1] = Geometry::distance_square(end, triangle[1], triangle[2], true);
-                    distance[2] = Geometry::distance_square(end, triangle[0], triangle[2], true);
+                    distance[0] = Geometry::distance_square(end, triangle[0], triangle[1]);
+                    distance[1] = Geometry::distance_square(end, triangle[1], triangle[2]);
+                    distance[2] = Geometry::distance_square(end, triangle[0], triangle[2]);
                     last_triangle = triangle;
                     if (distance[0] <= distance[1])
                     {
                         if (distance[0] > distance[2])
                         {
                             triangle[1] = triangle[2];
+                            directions[1] = directions[2];
                         }
                     }
                     else
@@ -101,14 +210,26 @@ namespace ToyGameEngine
                         if (distance[1] <= distance[2])
                         {
                             triangle[0] = triangle[2];
+                            directions[0] = directions[2];
                         }
                         else
                         {
                             triangle[1] = triangle[2];
+                            directions[1] = directions[2];
                         }
                     }
-                    Geometry::foot_point(triangle[0], triangle[1], end, start, true);
+                    start = Collision::closest_to_origin(triangle[0], triangle[1]);
                 }
+                cache.directions[0] = directions[0];
+                cache.directions[1] = directions[1];
+                return false;
+            }
+
+            template <typename L, typename R>
+            bool gjk(const L &points0, const R &points1)
+            {
+                Collision::GJKCache cache;
+                return Collision::gjk(points0, points1, cache);
             }
 
             bool gjk(const Geometry::Circle &circle0, const Geometry::Circle &circle1);
@@ -135,31 +256,71 @@ namespace ToyGameEngine
 
             bool gjk(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1);
 
+            // 圆与封闭图形的碰撞有专门的实现,不使用cache
+            bool gjk(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, GJKCache &cache);
+
+            // object0平移(tx * t, ty * t)后与object1接触时的最小t,t在[0, 1]内,point为接触点,normal为由object1指向object0的单位法向量
+            // 按GJK射线投射在两者的Minkowski差上求解,开始时已重叠的返回t为0,normal为-(tx, ty)方向;开始时接触且向外移动的不算碰撞
+            bool shape_cast(const Geometry::GeometryObject *object0, const Geometry::GeometryObject *object1, const double tx, const double ty,
+                double &t, Geometry::Point &point, Geometry::Vector &normal);
+
+            // object0与object1的距离,point0与point1为两者上距离最近的点,相交时返回0且point0与point1相同
+            // 按GJK在两者的Minkowski差上求解,非凸图形按凸包计算;可确定距离大于threshold时提前结束并返回-1,不修改point0与point1
+            double gjk_distance(const Geometry::GeometryObject *object0, const Geometry::GeometryObject *object1, Geometry::Point &point0,
+                Geometry::Point &point1, const double threshold = DBL_MAX);
+
 
             template <typename L, typename R>
-            double epa(const L &points0, const R &points1, Geometry::Vector &vec)
+            double epa(const L &points0, const R &points1, Geometry::Vector &vec, GJKCache &cache)
             {
-                Geometry::Point start = points0.average_point(), end = points1.average_point();
+                Collision::SupportMapping<L> support0(points0, cache.indexs[0]);
+                Collision::SupportMapping<R> support1(points1, cache.indexs[1]);
+                Geometry::Point start, end;
                 Geometry::Point point0, point1, point2;
                 Geometry::Triangle triangle, last_triangle;
+                Geometry::Vector directions[3];
                 double distance[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
+                const bool warm = cache.valid;
 
-                if (start.x == end.x)
+                if (cache.valid)
                 {
-                    start.x += 1;
+                    if (cache.separated)
+                    {
+                        support0(end, cache.axis, point0);
+                        support1(cache.axis, end, point1);
+                        if (cache.axis * (point0 - point1) < 0)
+                        {
+                            return -1;
+                        }
+                    }
+                    directions[0] = cache.directions[0];
+                    directions[1] = cache.directions[1];
                 }
-                if (start.y == end.y)
+                else
                 {
-                    start.y += 1;
+                    start = points0.average_point();
+                    end = points1.average_point();
+                    if (start.x == end.x)
+                    {
+                        start.x += 1;
+                    }
+                    if (start.y == end.y)
+                    {
+                        start.y += 1;
+                    }
+                    directions[0] = end - start;
+                    directions[1] = start - end;
+                    end.clear(); // 现在是原点(0,0)了
                 }
-                Collision::gjk_furthest_point(points0, start, end, point0);
-                Collision::gjk_furthest_point(points1, end, start, point1);
+                support0(end, directions[0], point0);
+                support1(directions[0], end, point1);
                 triangle[0] = point0 - point1;
-                Collision::gjk_furthest_point(points0, end, start, point0);
-                Collision::gjk_furthest_point(points1, start, end, point1);
+                support0(end, directions[1], point0);
+                support1(directions[1], end, point1);
                 triangle[1] = point0 - point1;
-                end.clear(); // 现在是原点(0,0)了
                 start = Collision::edge_direciton(triangle[0], triangle[1], false);
+                cache.valid = true;
+                cache.separated = false;
 
                 while (true)
                 {
@@ -171,12 +332,25 @@ namespace ToyGameEngine
                     {
                         start.y = 1;
                     }
-                    Collision::gjk_furthest_point(points0, start, end, point0);
-                    Collision::gjk_furthest_point(points1, end, start, point1);
+                    directions[2] = end - start;
+                    support0(start, end, point0);
+                    support1(end, start, point1);
                     triangle[2] = point0 - point1;
 
-                    if (triangle[2] * (point0 - point1) < 0)
+                    // 从缓存的方向开始时单纯形可能停滞在不包含原点的位置,改为从头搜索
+                    if (warm && last_triangle[0] == triangle[0] && last_triangle[1] == triangle[1] && last_triangle[2] == triangle[2])
+                    {
+                        cache.clear();
+                        return Collision::epa(points0, points1, vec, cache);
+                    }
+                    // 支撑点在搜索方向上的投影小于0,原点在Minkowski差之外
+                    if (directions[2] * triangle[2] < 0 || (last_triangle[0] == triangle[0] && last_triangle[1] == triangle[1]
+                        && last_triangle[2] == triangle[2]))
                     {
+                        cache.directions[0] = directions[0];
+                        cache.directions[1] = directions[1];
+                        cache.axis = directions[2];
+                        cache.separated = true;
                         return -1;
                     }
 
@@ -184,11 +358,6 @@ namespace ToyGameEngine
                     {
                         break;
                     }
-                    else if (last_triangle[0] == triangle[0] && last_triangle[1] == triangle[1]
-                        && last_triangle[2] == triangle[2])
-                    {
-                        return -1;
-                    }
 
                     distance[0] = Geometry::distance_square(end, triangle[0], triangle[1]);
                     distance[1] = Geometry::distance_square(end, triangle[1], triangle[2]);
@@ -199,6 +368,7 @@ namespace ToyGameEngine
                         if (distance[0] > distance[2])
                         {
                             triangle[1] = triangle[2];
+                            directions[1] = directions[2];
                         }
                     }
                     else
@@ -206,21 +376,25 @@ namespace ToyGameEngine
                         if (distance[1] <= distance[2])
                         {
                             triangle[0] = triangle[2];
+                            directions[0] = directions[2];
                         }
                         else
                         {
                             triangle[1] = triangle[2];
+                            directions[1] = directions[2];
                         }
                     }
                     start = Collision::edge_direciton(triangle[0], triangle[1], false);
                 }
+                cache.directions[0] = directions[0];
+                cache.directions[1] = directions[1];
 
                 std::vector<Geometry::Point> points;
                 points.emplace_back(triangle[0]);
                 points.emplace_back(triangle[1]);
                 points.emplace_back(triangle[2]);
 
-                if (Geo::is_on_left(points[2], points[0], points[1]))
+                if (Geometry::is_on_left(points[2], points[0], points[1]))
                 {
                     std::reverse(points.begin(), points.end());
                 }
@@ -241,8 +415,8 @@ namespace ToyGameEngine
                     }
 
                     vec = Collision::edge_direciton(points[index - 1], points[index % points.size()], false);
-                    Collision::gjk_furthest_point(points0, end, vec, point0);
-                    Collision::gjk_furthest_point(points1, vec, end, point1);
+                    support0(end, vec, point0);
+                    support1(vec, end, point1);
                     point2 = point0 - point1;
                     if (vec * point2 <= 0 || points[index - 1] == point2 || points[index % points.size()] == point2)
                     {
@@ -268,20 +442,20 @@ namespace ToyGameEngine
                     }
                 }
             
-                distance[0] = Geo::distance_square(end, points.front(), points.back());
+                distance[0] = Geometry::distance_square(end, points.front(), points.back());
                 index = points.size();
                 for (size_t i = 1, count = points.size(); i < count; ++i)
                 {
-                    distance[1] = Geo::distance_square(end, points[i - 1], points[i]);
+                    distance[1] = Geometry::distance_square(end, points[i - 1], points[i]);
                     if (distance[1] < distance[0])
                     {
                         distance[0] = distance[1];
                         index = i;
                     }
                 }
-                if (!Geo::foot_point(points[index - 1], points[index % points.size()], end, vec))
+                if (!Geometry::foot_point(points[index - 1], points[index % points.size()], end, vec))
                 {
-                    if (Geo::distance_square(end, points[index - 1]) <= Geo::distance_square(end, points[index % points.size()]))
+                    if (Geometry::distance_square(end, points[index - 1]) <= Geometry::distance_square(end, points[index % points.size()]))
                     {
                         vec = points[index - 1];
                     }
@@ -294,6 +468,13 @@ namespace ToyGameEngine
                 return vec.Geometry::Point::length();
             }
 
+            template <typename L, typename R>
+            double epa(const L &points0, const R &points1, Geometry::Vector &vec)
+            {
+                Collision::GJKCache cache;
+                return Collision::epa(points0, points1, vec, cache);
+            }
+
             double epa(const Geometry::Circle &circle0, const Geometry::Circle &circle1, Geometry::Vector &vec);
 
             double epa(const Geometry::Circle &circle, const Geometry::Polygon &polygon, Geometry::Vector &vec);
@@ -318,10 +499,14 @@ namespace ToyGameEngine
 
             double epa(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Vector &vec);
 
+            double epa(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Vector &vec, GJKCache &cache);
+
 
             template <typename L, typename R>
             double epa(const L &points0, const R &points1, Geometry::Point &head, Geometry::Point &tail)
             {
+                Collision::SupportMapping<L> support0(points0);
+                Collision::SupportMapping<R> support1(points1);
                 Geometry::Point start = points0.average_point(), end = points1.average_point();
                 Geometry::Point point0, point1, point2;
                 Geometry::Triangle triangle, last_triangle;
@@ -336,12 +521,12 @@ namespace ToyGameEngine
                 {
                     start.y += 1;
                 }
-                Collision::gjk_furthest_point(points0, start, end, point0);
-                Collision::gjk_furthest_point(points1, end, start, point1);
+                support0(start, end, point0);
+                support1(end, start, point1);
                 point_pairs.emplace_back(point0, point1);
                 triangle[0] = point0 - point1;
-                Collision::gjk_furthest_point(points0, end, start, point0);
-                Collision::gjk_furthest_point(points1, start, end, point1);
+                support0(end, start, point0);
+                support1(start, end, point1);
                 point_pairs.emplace_back(point0, point1);
                 triangle[1] = point0 - point1;
                 end.clear(); // 现在是原点(0,0)了
@@ -357,8 +542,8 @@ namespace ToyGameEngine
                     {
                         start.y = 1;
                     }
-                    Collision::gjk_furthest_point(points0, start, end, point0);
-                    Collision::gjk_furthest_point(points1, end, start, point1);
+                    support0(start, end, point0);
+                    support1(end, start, point1);
                     point_pairs.emplace_back(point0, point1);
                     triangle[2] = point0 - point1;
 
@@ -411,7 +596,7 @@ namespace ToyGameEngine
                 points.emplace_back(triangle[1]);
                 points.emplace_back(triangle[2]);
 
-                if (Geo::is_on_left(points[2], points[0], points[1]))
+                if (Geometry::is_on_left(points[2], points[0], points[1]))
                 {
                     std::reverse(points.begin(), points.end());
                 }
@@ -432,8 +617,8 @@ namespace ToyGameEngine
                     }
 
                     head = Collision::edge_direciton(points[index - 1], points[index % points.size()], false);
-                    Collision::gjk_furthest_point(points0, end, head, point0);
-                    Collision::gjk_furthest_point(points1, head, end, point1);
+                    support0(end, head, point0);
+                    support1(head, end, point1);
                     point2 = point0 - point1;
                     if (head * point2 <= 0 || points[index - 1] == point2 || points[index % points.size()] == point2)
                     {
@@ -461,11 +646,11 @@ namespace ToyGameEngine
                     }
                 }
 
-                distance[0] = Geo::distance_square(end, points.front(), points.back());
+                distance[0] = Geometry::distance_square(end, points.front(), points.back());
                 index = points.size();
                 for (size_t i = 1, count = points.size(); i < count; ++i)
                 {
-                    distance[1] = Geo::distance_square(end, points[i - 1], points[i]);
+                    distance[1] = Geometry::distance_square(end, points[i - 1], points[i]);
                     if (distance[1] < distance[0])
                     {
                         distance[0] = distance[1];
@@ -504,6 +689,8 @@ namespace ToyGameEngine
             template <typename L, typename R>
             double epa(const L &points0, const R &points1, const double tx, const double ty, Geometry::Vector &vec)
             {
+                Collision::SupportMapping<L> support0(points0);
+                Collision::SupportMapping<R> support1(points1);
                 if constexpr (std::is_same_v<L, Geometry::Circle> || std::is_same_v<R, Geometry::Circle>)
                 {
                     return Collision::epa(points0, points1, vec);
@@ -522,11 +709,11 @@ namespace ToyGameEngine
                 {
                     start.y += 1;
                 }
-                Collision::gjk_furthest_point(points0, start, end, point0);
-                Collision::gjk_furthest_point(points1, end, start, point1);
+                support0(start, end, point0);
+                support1(end, start, point1);
                 triangle[0] = point0 - point1;
-                Collision::gjk_furthest_point(points0, end, start, point0);
-                Collision::gjk_furthest_point(points1, start, end, point1);
+                support0(end, start, point0);
+                support1(start, end, point1);
                 triangle[1] = point0 - point1;
                 end.clear(); // 现在是原点(0,0)了
                 start = Collision::edge_direciton(triangle[0], triangle[1], false);
@@ -541,8 +728,8 @@ namespace ToyGameEngine
                     {
                         start.y = 1;
                     }
-                    Collision::gjk_furthest_point(points0, start, end, point0);
-                    Collision::gjk_furthest_point(points1, end, start, point1);
+                    support0(start, end, point0);
+                    support1(end, start, point1);
                     triangle[2] = point0 - point1;
 
                     if (triangle[2] * (point0 - point1) < 0)
@@ -590,7 +777,7 @@ namespace ToyGameEngine
                 points.emplace_back(triangle[1]);
                 points.emplace_back(triangle[2]);
 
-                if (Geo::is_on_left(points[2], points[0], points[1]))
+                if (Geometry::is_on_left(points[2], points[0], points[1]))
                 {
                     std::reverse(points.begin(), points.end());
                 }
@@ -611,8 +798,8 @@ namespace ToyGameEngine
                     }
 
                     vec = Collision::edge_direciton(points[index - 1], points[index % points.size()], false);
-                    Collision::gjk_furthest_point(points0, end, vec, point0);
-                    Collision::gjk_furthest_point(points1, vec, end, point1);
+                    support0(end, vec, point0);
+                    support1(vec, end, point1);
                     point2 = point0 - point1;
                     if (vec * point2 <= 0 || points[index - 1] == point2 || points[index % points.size()] == point2)
                     {
@@ -638,12 +825,12 @@ namespace ToyGameEngine
                     }
                 }
             
-                distance[0] = Geo::distance_square(end, points.front(), points.back());
+                distance[0] = Geometry::distance_square(end, points.front(), points.back());
                 index = points.size();
                 std::vector<size_t> indexs;
                 for (size_t i = 1, count = points.size(); i < count; ++i)
                 {
-                    distance[1] = Geo::distance_square(end, points[i - 1], points[i]);
+                    distance[1] = Geometry::distance_square(end, points[i - 1], points[i]);
                     if (distance[1] < distance[0])
                     {
                         distance[0] = distance[1];
@@ -655,9 +842,9 @@ namespace ToyGameEngine
                         indexs.push_back(i);
                     }
                 }
-                if (!Geo::foot_point(points[index - 1], points[index % points.size()], end, vec))
+                if (!Geometry::foot_point(points[index - 1], points[index % points.size()], end, vec))
                 {
-                    if (Geo::distance_square(end, points[index - 1]) <= Geo::distance_square(end, points[index % points.size()]))
+                    if (Geometry::distance_square(end, points[index - 1]) <= Geometry::distance_square(end, points[index % points.size()]))
                     {
                         vec = points[index - 1];
                     }
@@ -671,10 +858,10 @@ namespace ToyGameEngine
                     distance[0] = vec.x * tx + vec.y * ty;
                     for (const size_t i : indexs)
                     {
-                        if (!Geo::foot_point(points[i - 1], points[i % points.size()], end, point2))
+                        if (!Geometry::foot_point(points[i - 1], points[i % points.size()], end, point2))
                         {
-                            if (Geo::distance_square(end, points[i - 1]) <=
-                                Geo::distance_square(end, points[i % points.size()]))
+                            if (Geometry::distance_square(end, points[i - 1]) <=
+                                Geometry::distance_square(end, points[i % points.size()]))
                             {
                                 point2 = points[i - 1];
                             }
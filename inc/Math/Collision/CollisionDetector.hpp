@@ -1,9 +1,17 @@
 #pragma once
 
-#include <deque>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
 #include "Math/Collision/GridMap.hpp"
 #include "Math/Collision/QuadTree.hpp"
 #include "Math/Collision/DirectMode.hpp"
+#include "Math/Collision/SpatialHash.hpp"
+#include "Math/Collision/SweepAndPrune.hpp"
+#include "Math/Collision/AABBTree.hpp"
+#include "Math/Collision/PairCache.hpp"
+#include "Math/Collision/NarrowPhase.hpp"
+#include "Math/Collision/Algorithm.hpp"
 
 namespace ToyGameEngine
 {
@@ -15,77 +23,152 @@ namespace ToyGameEngine
             class CollisionDetector
             {
             private:
+                typedef std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *> ObjectPair;
+
+                // 有序对象对的哈希
+                struct ObjectPairHash
+                {
+                    size_t operator()(const ObjectPair &pair) const
+                    {
+                        size_t value = std::hash<const Geometry::GeometryObject *>()(pair.first) * 0x9E3779B9;
+                        return value ^ (std::hash<const Geometry::GeometryObject *>()(pair.second) + 0x7F4A7C15 + (value << 6) + (value >> 2));
+                    }
+                };
+
                 T _detector;
+                PairCache _pair_cache;
+                // 为true时collision_translate按形状投射的接触时刻推动对象,避免高速对象穿过其他对象
+                bool _ccd = false;
+                // CCD推进到接触位置时保留的间隙,避免舍入误差使对象相互重叠
+                static constexpr double CCD_SKIN = 1e-8;
+                // collision_translate最多迭代的轮数
+                size_t _solver_iterations = 8;
+                // 检测器可一次更新多个对象,否则逐个更新
+                static constexpr bool BATCH_UPDATE = std::is_same_v<T, GridMap> || std::is_same_v<T, QuadTree>
+                    || std::is_same_v<T, DirectMode>;
+                // 上次collision_translate中各对象对的推动量,EPA有多条等距的边时按其选择推动方向,使连续推动的方向保持一致
+                std::unordered_map<ObjectPair, Geometry::Vector, ObjectPairHash> _push_vectors;
 
-                static bool pair_in_pairs(const std::vector<std::pair<Geo::Geometry *, Geo::Geometry *>> &pairs, const Geo::Geometry *object0, const Geo::Geometry *object1, const bool ordered = false)
+                // object从当前位置扫掠(tx, ty),每次前进到最先接触的位置,将接触的对象沿法向推开剩余位移在法向上的分量后继续扫掠
+                // pushing_objects为正在推动的对象,不会被反推,碰到时object停在接触位置;contacts为本次平移剩余可处理的接触次数
+                void ccd_translate(Geometry::GeometryObject *object, const double tx, const double ty, std::vector<Geometry::GeometryObject *> &pushing_objects,
+                    size_t &contacts)
                 {
-                    if (ordered)
+                    std::vector<Geometry::GeometryObject *> candidates, grazed_objects;
+                    Geometry::GeometryObject *pushed_object = nullptr;
+                    // 推动object的对象位于其后方,不参与检测
+                    const Geometry::GeometryObject *pusher = pushing_objects.empty() ? nullptr : pushing_objects.back();
+                    pushing_objects.push_back(object);
+                    const CollisionLayer &layer = _detector.layer(object);
+                    const double length = std::sqrt(tx * tx + ty * ty);
+                    double rest = 1;
+                    RaycastHit hit;
+                    while (length * rest > CCD_SKIN)
                     {
-                        for (const std::pair<Geo::Geometry *, Geo::Geometry *> &pair : pairs)
+                        // 被推开的对象可能进入剩余的扫掠范围,每次接触后重新选取候选对象
+                        const double dx = tx * rest, dy = ty * rest;
+                        const Geometry::AABBRect rect(object->bounding_rect());
+                        const Geometry::AABBRect swept(std::min(rect.left(), rect.left() + dx), std::max(rect.top(), rect.top() + dy),
+                            std::max(rect.right(), rect.right() + dx), std::min(rect.bottom(), rect.bottom() + dy));
+                        candidates.clear();
+                        _detector.select(swept, candidates);
+                        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const Geometry::GeometryObject *candidate)
+                            { return candidate == pusher || !layer.accepts(_detector.layer(candidate))
+                                || std::find(grazed_objects.begin(), grazed_objects.end(), candidate) != grazed_objects.end(); }),
+                            candidates.end());
+                        if (!Collision::shape_cast(object, dx, dy, candidates, hit))
                         {
-                            if (pair.first == object0 && pair.second == object1)
-                            {
-                                return true;
-                            }
+                            break;
                         }
-                    }
-                    else
-                    {
-                        for (const std::pair<Geo::Geometry *, Geo::Geometry *> &pair : pairs)
+
+                        const double t = std::max(hit.t - CCD_SKIN / (length * rest), 0.0);
+                        object->translate(dx * t, dy * t);
+                        rest *= 1 - t;
+                        // 接触次数用尽、碰到正在推动的对象或刚推开的对象仍在起点接触时停在接触位置,丢弃剩余的位移
+                        if (contacts == 0 || (hit.t == 0 && hit.object == pushed_object)
+                            || std::find(pushing_objects.begin(), pushing_objects.end(), hit.object) != pushing_objects.end())
                         {
-                            if ((pair.first == object0 && pair.second == object1) || 
-                                (pair.first == object1 && pair.second == object0))
+                            rest = 0;
+                            break;
+                        }
+                        --contacts;
+                        double value = -(hit.normal.x * tx + hit.normal.y * ty) * rest;
+                        if (hit.t == 0 && value > 0 && std::abs(hit.normal.x * ty - hit.normal.y * tx) <= Geometry::EPSILON * (std::abs(tx) + std::abs(ty)))
+                        {
+                            // 起点已重叠时法向量为-dir,按AABB矩形中心判断对象是否在前方,避免把身后的对象推过自身
+                            const Geometry::AABBRect rect0(object->bounding_rect()), rect1(hit.object->bounding_rect());
+                            if ((rect1.left() + rect1.right() - rect0.left() - rect0.right()) * tx
+                                + (rect1.top() + rect1.bottom() - rect0.top() - rect0.bottom()) * ty <= 0)
                             {
-                                return true;
+                                value = 0;
                             }
                         }
+                        if (value > 0)
+                        {
+                            ccd_translate(hit.object, -hit.normal.x * value, -hit.normal.y * value, pushing_objects, contacts);
+                            pushed_object = hit.object;
+                        }
+                        else
+                        {
+                            // 沿切线擦过的对象之后不会再接触
+                            grazed_objects.push_back(hit.object);
+                        }
+                    }
+                    pushing_objects.pop_back();
+                    // 剩余位移不超过间隙时丢弃
+                    if (length * rest > CCD_SKIN)
+                    {
+                        object->translate(tx * rest, ty * rest);
                     }
-                    return false;
+                    _detector.update(object);
                 }
 
             public:
+                // CCD模式下一次collision_translate最多处理的接触次数,用尽后对象停在接触位置
+                static constexpr size_t MAX_CCD_CONTACTS = 64;
+
                 CollisionDetector() {}
 
-                CollisionDetector(const std::vector<GeometryObject *>::const_iterator &begin, const std::vector<GeometryObject *>::const_iterator &end)
+                CollisionDetector(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end)
                     : _detector(begin, end) {}
 
-                CollisionDetector(const std::vector<GeometryObject *> &objects)
+                CollisionDetector(const std::vector<Geometry::GeometryObject *> &objects)
                     : _detector(objects) {}
 
-                CollisionDetector(const std::initializer_list<GeometryObject *> &objects)
+                CollisionDetector(const std::initializer_list<Geometry::GeometryObject *> &objects)
                     : _detector(objects) {}
 
-                void build(const ContainerGroup &group)
-                {
-                    return _detector.build(group);
-                }
-
-                void build(const std::vector<GeometryObject *> &objects)
+                void build(const std::vector<Geometry::GeometryObject *> &objects)
                 {
                     return _detector.build(objects);
                 }
 
-                void build(const std::vector<GeometryObject *>::const_iterator &begin, const std::vector<GeometryObject *>::const_iterator &end)
+                void build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end)
                 {
                     return _detector.build(begin, end);
                 }
 
-                void build(const std::vector<GeometryObject *> &objects, const std::vector<AABBRect> &rects)
+                void build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
                 {
                     return _detector.build(objects, rects);
                 }
 
-                void append(GeometryObject *object)
+                void build(const std::vector<Geometry::GeometryObject *> &objects, ThreadPool &pool)
+                {
+                    return _detector.build(objects, pool);
+                }
+
+                size_t append(Geometry::GeometryObject *object)
                 {
                     return _detector.append(object);
                 }
 
-                void remove(GeometryObject *object)
+                void remove(Geometry::GeometryObject *object)
                 {
                     return _detector.remove(object);
                 }
 
-                void update(GeometryObject *object)
+                void update(Geometry::GeometryObject *object)
                 {
                     return _detector.update(object);
                 }
@@ -95,70 +178,284 @@ namespace ToyGameEngine
                     return _detector.update();
                 }
 
-                bool has(GeometryObject *object) const
+                void update(ThreadPool &pool)
+                {
+                    return _detector.update(pool);
+                }
+
+                void update(const std::vector<Geometry::GeometryObject *> &objects)
+                {
+                    return _detector.update(objects);
+                }
+
+                void update(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+                {
+                    return _detector.update(begin, end);
+                }
+
+                bool has(Geometry::GeometryObject *object) const
                 {
                     return _detector.has(object);
                 }
 
                 void clear()
                 {
+                    _push_vectors.clear();
                     return _detector.clear();
                 }
 
-                bool select(const Point &pos, std::vector<GeometryObject *> &objects) const
+                const CollisionLayer &layer(const Geometry::GeometryObject *object) const
+                {
+                    return _detector.layer(object);
+                }
+
+                // 碰撞层只影响碰撞检测与collision_translate,不影响select、射线与形状投射等查询
+                void set_layer(Geometry::GeometryObject *object, const CollisionLayer &layer)
+                {
+                    return _detector.set_layer(object, layer);
+                }
+
+                void set_layer(Geometry::GeometryObject *object, const uint32_t category, const uint32_t mask)
+                {
+                    CollisionLayer layer;
+                    layer.category = category;
+                    layer.mask = mask;
+                    return _detector.set_layer(object, layer);
+                }
+
+                bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
                 {
                     return _detector.select(pos, objects);
                 }
 
-                bool select(const AABBRect &rect, std::vector<GeometryObject *> &objects) const
+                bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
                 {
                     return _detector.select(rect, objects);
                 }
 
-                bool find_collision_objects(const GeometryObject *object, std::vector<GeometryObject *> &objects, const bool norepeat = true) const
+                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const
                 {
                     return _detector.find_collision_objects(object, objects, norepeat);
                 }
 
-                bool find_collision_pairs(std::vector<std::pair<GeometryObject *, GeometryObject *>> &pairs, const bool norepeat = true) const
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const
                 {
                     return _detector.find_collision_pairs(pairs, norepeat);
                 }
 
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, ThreadPool &pool, const bool norepeat = true) const
+                {
+                    return _detector.find_collision_pairs(pairs, pool, norepeat);
+                }
+
+                bool find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
+                {
+                    return _detector.find_candidate_pairs(pairs);
+                }
+
+                // 先找出全部候选碰撞对,再按类型分组批量检测,结果与find_collision_pairs相同但顺序可能不同
+                bool find_collision_pairs_batch(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
+                {
+                    const size_t size = pairs.size();
+                    _detector.find_candidate_pairs(pairs);
+                    return Collision::filter_collision_pairs(pairs, size);
+                }
+
+                // 与上次调用相比,输出开始、持续与结束接触的碰撞对,已删除对象的碰撞对以结束事件输出
+                bool update_contacts(std::vector<ContactEvent> &events)
+                {
+                    const size_t size = events.size();
+                    std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> pairs;
+                    _detector.find_candidate_pairs(pairs);
+                    _pair_cache.update(pairs, events);
+                    return events.size() > size;
+                }
+
+                PairCache &pair_cache()
+                {
+                    return _pair_cache;
+                }
+
+                const PairCache &pair_cache() const
+                {
+                    return _pair_cache;
+                }
+
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit) const
+                {
+                    return _detector.raycast(origin, dir, max_t, hit);
+                }
+
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const
+                {
+                    return _detector.raycast_all(origin, dir, max_t, hits);
+                }
+
+                // object沿(tx, ty)平移时最先接触的对象,hit.t为接触时的位移比例,先按扫掠的AABB矩形选出候选对象
+                bool shape_cast(const Geometry::GeometryObject *object, const double tx, const double ty, RaycastHit &hit) const
+                {
+                    const Geometry::AABBRect rect(object->bounding_rect());
+                    const Geometry::AABBRect swept(std::min(rect.left(), rect.left() + tx), std::max(rect.top(), rect.top() + ty),
+                        std::max(rect.right(), rect.right() + tx), std::min(rect.bottom(), rect.bottom() + ty));
+                    std::vector<Geometry::GeometryObject *> candidates;
+                    _detector.select(swept, candidates);
+                    return Collision::shape_cast(object, tx, ty, candidates, hit);
+                }
+
+                // object沿(tx, ty)平移时接触的全部对象,按t升序追加到hits
+                bool shape_cast_all(const Geometry::GeometryObject *object, const double tx, const double ty, std::vector<RaycastHit> &hits) const
+                {
+                    const Geometry::AABBRect rect(object->bounding_rect());
+                    const Geometry::AABBRect swept(std::min(rect.left(), rect.left() + tx), std::max(rect.top(), rect.top() + ty),
+                        std::max(rect.right(), rect.right() + tx), std::min(rect.bottom(), rect.bottom() + ty));
+                    std::vector<Geometry::GeometryObject *> candidates;
+                    _detector.select(swept, candidates);
+                    return Collision::shape_cast_all(object, tx, ty, candidates, hits);
+                }
+
+                // 与pos距离不超过radius的对象及其距离,按距离升序追加到objects
+                bool query_radius(const Geometry::Point &pos, const double radius, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
+                {
+                    return _detector.query_radius(pos, radius, objects);
+                }
+
+                // 距离pos最近的k个对象及其距离,按距离升序追加到objects
+                bool query_knn(const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
+                {
+                    return _detector.query_knn(pos, k, objects);
+                }
+
+                bool ccd() const
+                {
+                    return _ccd;
+                }
+
+                void set_ccd(const bool value)
+                {
+                    _ccd = value;
+                }
+
+                // object已平移(tx, ty),推开与其碰撞的对象,被推动的对象继续推动其他对象
                 void collision_translate(Geometry::GeometryObject *object, const double tx, const double ty)
                 {
-                    std::deque<Geometry::GeometryObject *> crushed_objects({object});
-                    std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> moved_object_pairs;
-                    std::vector<Geometry::GeometryObject *> current_objects;
+                    if (_ccd)
+                    {
+                        std::vector<Geometry::GeometryObject *> pushing_objects;
+                        size_t contacts = MAX_CCD_CONTACTS;
+                        object->translate(-tx, -ty);
+                        ccd_translate(object, tx, ty, pushing_objects, contacts);
+                        return;
+                    }
+
+                    // 对象对最后一次处理时的轮次与版本号,对象每被推动一次版本号增加
+                    std::unordered_map<ObjectPair, std::pair<size_t, size_t>, ObjectPairHash> moved_object_pairs;
+                    std::unordered_map<Geometry::GeometryObject *, size_t> versions;
+                    std::unordered_map<ObjectPair, Geometry::Vector, ObjectPairHash> push_vectors;
+                    std::unordered_set<Geometry::GeometryObject *> unresolved_set;
+                    std::vector<Geometry::GeometryObject *> crushed_objects({object}), unresolved_objects, moved_objects, current_objects;
+                    size_t version = 0;
                     Geometry::Vector vec;
-                    while (!crushed_objects.empty())
+                    for (size_t i = 0; i < _solver_iterations && !crushed_objects.empty(); ++i)
                     {
-                        object = crushed_objects.back();
-                        crushed_objects.pop_back();
-                        if (_detector.find_collision_objects(object, current_objects))
+                        const size_t start_version = version;
+                        moved_objects.clear();
+                        unresolved_objects.clear();
+                        unresolved_set.clear();
+                        while (!crushed_objects.empty())
                         {
+                            object = crushed_objects.back();
+                            crushed_objects.pop_back();
+                            if (!_detector.find_collision_objects(object, current_objects))
+                            {
+                                continue;
+                            }
+                            const size_t object_version = versions[object];
                             for (Geometry::GeometryObject *current_object : current_objects)
                             {
-                                if (pair_in_pairs(moved_object_pairs, object, crushed_objects[i], true))
+                                const ObjectPair pair(object, current_object);
+                                size_t &current_version = versions[current_object];
+                                typename std::unordered_map<ObjectPair, std::pair<size_t, size_t>, ObjectPairHash>::const_iterator visited = moved_object_pairs.find(pair);
+                                if (visited != moved_object_pairs.end())
+                                {
+                                    const bool is_stale = object_version > visited->second.second || current_version > visited->second.second;
+                                    if (visited->second.first == i)
+                                    {
+                                        // 本轮已处理过的对象对不再处理,处理后又有对象移动且仍重叠的留到下一轮
+                                        if (is_stale && unresolved_set.insert(object).second)
+                                        {
+                                            unresolved_objects.push_back(object);
+                                        }
+                                        continue;
+                                    }
+                                    else if (!is_stale)
+                                    {
+                                        continue;
+                                    }
+                                }
+                                // 反向的对象对在本轮处理后又有对象移动时同样留到下一轮
+                                visited = moved_object_pairs.find(ObjectPair(current_object, object));
+                                if (visited != moved_object_pairs.end() && visited->second.first == i
+                                    && (object_version > visited->second.second || current_version > visited->second.second)
+                                    && unresolved_set.insert(current_object).second)
                                 {
-                                    continue;
+                                    unresolved_objects.push_back(current_object);
                                 }
 
-                                moved_object_pairs.emplace_back(object, current_object);
-                                if (Collision::epa(object, current_object, tx, ty, vec) > 0)
+                                typename std::unordered_map<ObjectPair, Geometry::Vector, ObjectPairHash>::const_iterator it = _push_vectors.find(pair);
+                                const Geometry::Vector dir = it == _push_vectors.end() ? Geometry::Vector(tx, ty) : it->second;
+                                if (Collision::epa(static_cast<const Geometry::GeometryObject *>(object),
+                                    static_cast<const Geometry::GeometryObject *>(current_object), dir.x, dir.y, vec) > 0)
                                 {
                                     if (vec.x * tx + vec.y * ty > 0)
                                     {
+                                        // 检测器在本轮结束时统一更新,此前其他对象查不到被推动对象的新位置,被推动的对象在下一轮重新检测
                                         current_object->translate(vec.x, vec.y);
-                                        _detector.update(current_object);
-                                        current_objects.push_back(current_object);
+                                        push_vectors[pair] += vec;
+                                        if (current_version <= start_version)
+                                        {
+                                            moved_objects.push_back(current_object);
+                                        }
+                                        current_version = ++version;
+                                        crushed_objects.push_back(current_object);
                                     }
                                     vec.clear();
                                 }
+                                moved_object_pairs[pair] = std::make_pair(i, version);
                             }
                             current_objects.clear();
                         }
+                        if constexpr (BATCH_UPDATE)
+                        {
+                            _detector.update(moved_objects);
+                        }
+                        else
+                        {
+                            for (Geometry::GeometryObject *moved_object : moved_objects)
+                            {
+                                _detector.update(moved_object);
+                            }
+                        }
+                        for (Geometry::GeometryObject *moved_object : moved_objects)
+                        {
+                            if (unresolved_set.insert(moved_object).second)
+                            {
+                                unresolved_objects.push_back(moved_object);
+                            }
+                        }
+                        crushed_objects.swap(unresolved_objects);
                     }
+                    _push_vectors.swap(push_vectors);
+                }
+
+                size_t solver_iterations() const
+                {
+                    return _solver_iterations;
+                }
+
+                // 迭代轮数至少为1
+                void set_solver_iterations(const size_t value)
+                {
+                    _solver_iterations = std::max(value, static_cast<size_t>(1));
                 }
             };
         }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            // 对象所属的类别与可碰撞的类别,两个对象的category都在对方的mask中时才检测碰撞
+            struct CollisionLayer
+            {
+                uint32_t category = 1;
+                uint32_t mask = 0xFFFFFFFF;
+
+                bool accepts(const CollisionLayer &layer) const;
+            };
+
+            // 以检测器中对象的句柄为下标保存碰撞层,未设置的对象属于默认层,与所有对象碰撞
+            class CollisionFilter
+            {
+            private:
+                std::vector<CollisionLayer> _layers;
+                // 非默认层的对象数量,为0时无需检查
+                size_t _count = 0;
+
+                static bool is_default(const CollisionLayer &layer);
+
+            public:
+                static const CollisionLayer &default_layer();
+
+                const CollisionLayer &layer(const size_t index) const;
+
+                void set_layer(const size_t index, const CollisionLayer &layer);
+
+                // 对象删除后句柄可能被复用,恢复为默认层
+                void reset(const size_t index);
+
+                void clear();
+
+                // 全部对象都属于默认层
+                bool empty() const;
+
+                bool accepts(const size_t index0, const size_t index1) const;
+
+                bool accepts(const CollisionLayer &layer, const size_t index) const;
+            };
+        }
+    }
+}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <unordered_map>
 #include "Math/Geometry/AABBRect.hpp"
+#include "Math/Collision/Raycast.hpp"
+#include "Math/Collision/CollisionFilter.hpp"
+#include "Math/Collision/Nearest.hpp"
 
 
 namespace ToyGameEngine
@@ -12,7 +16,16 @@ namespace ToyGameEngine
             class DirectMode
             {
             private:
+                // 以句柄为下标,已删除对象的位置为nullptr
                 std::vector<Geometry::GeometryObject *> _objects;
+                std::vector<Geometry::AABBRect> _rects;
+                std::vector<size_t> _free_indexs;
+                std::unordered_map<Geometry::GeometryObject *, size_t> _indexs;
+                // 以句柄为下标的碰撞层,在宽相位中先于GJK检测筛选对象对
+                CollisionFilter _filter;
+
+                // narrow为false时只做AABB检测
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat, const bool narrow) const;
 
             public:
                 DirectMode();
@@ -29,7 +42,8 @@ namespace ToyGameEngine
 
                 void build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects);
 
-                void append(Geometry::GeometryObject *object);
+                // 返回对象的句柄,对象删除前句柄保持不变
+                size_t append(Geometry::GeometryObject *object);
 
                 void remove(Geometry::GeometryObject *object);
 
@@ -37,6 +51,11 @@ namespace ToyGameEngine
 
                 void update();
 
+                // 批量更新多个对象,先刷新全部AABB矩形,最多重建或扩展一次
+                void update(const std::vector<Geometry::GeometryObject *> &objects);
+
+                void update(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
                 bool has(Geometry::GeometryObject *object) const;
 
                 void clear();
@@ -45,9 +64,30 @@ namespace ToyGameEngine
 
                 bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
 
+                // 与pos距离不超过radius的对象及其距离,按距离升序追加到objects
+                bool query_radius(const Geometry::Point &pos, const double radius, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const;
+
+                // 距离pos最近的k个对象及其距离,按距离升序追加到objects
+                bool query_knn(const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const;
+
+                // 对象不在检测器中时为默认层
+                const CollisionLayer &layer(const Geometry::GeometryObject *object) const;
+
+                // 对象不在检测器中时忽略,build与clear后全部对象恢复为默认层
+                void set_layer(Geometry::GeometryObject *object, const CollisionLayer &layer);
+
                 bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const;
 
                 bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const;
+
+                // AABB矩形相交的对象对,不做GJK检测,每对只输出一次
+                bool find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const;
+
+                // 按射线进入AABB矩形的先后检测全部对象
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit) const;
+
+                // 射线穿过的全部对象,按t升序追加到hits
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const;
             };
         }
     }
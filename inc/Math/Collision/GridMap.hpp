@@ -1,6 +1,11 @@
 #pragma once
 
+#include <unordered_map>
 #include "Math/Geometry/AABBRect.hpp"
+#include "Math/Collision/ThreadPool.hpp"
+#include "Math/Collision/Raycast.hpp"
+#include "Math/Collision/CollisionFilter.hpp"
+#include "Math/Collision/Nearest.hpp"
 
 
 namespace ToyGameEngine
@@ -9,11 +14,43 @@ namespace ToyGameEngine
     {
         namespace Collision
         {
+            // 碰撞对筛选各阶段剔除的候选数量
+            struct CollisionStatistics
+            {
+                // 进入筛选的候选对象对
+                size_t candidates = 0;
+                // AABB矩形不相交
+                size_t aabb_rejected = 0;
+                // 已由其他网格或节点记录
+                size_t repeat_rejected = 0;
+                // 碰撞层不匹配
+                size_t layer_rejected = 0;
+                // GJK检测不相交
+                size_t gjk_rejected = 0;
+
+                CollisionStatistics &operator+=(const CollisionStatistics &statistics);
+            };
+
+            // 并行检测碰撞对的任务,检测第node个节点中位置在[begin, end)内的对象与其后的对象
+            struct PairTask
+            {
+                size_t node = 0;
+                size_t begin = 0;
+                size_t end = 0;
+            };
+
+            // 按各节点的对象数量将碰撞对检测划分为工作量相近的任务,count为线程数量,任务保持节点与对象的顺序
+            void split_pair_tasks(const std::vector<size_t> &sizes, const size_t count, std::vector<PairTask> &tasks);
+
             class GridNode
             {
             protected:
                 Geometry::AABBRect _rect;
                 std::vector<Geometry::GeometryObject *> _objects;
+                // 与_objects一一对应,对象在所属检测器中的句柄
+                std::vector<size_t> _indexs;
+                // 与_objects一一对应,按分量分开存放的AABB矩形
+                std::vector<double> _lefts, _tops, _rights, _bottoms;
 
             public:
                 GridNode();
@@ -26,39 +63,142 @@ namespace ToyGameEngine
 
                 const Geometry::AABBRect &rect() const;
 
-                bool append(Geometry::GeometryObject *object);
+                // 返回对象在节点中的位置
+                size_t append(Geometry::GeometryObject *object, const size_t index, const Geometry::AABBRect &rect);
+
+                // 删除pos处的对象,末尾的对象移动到pos
+                void remove(const size_t pos);
+
+                // 调整对象数量并保留容量,新增的位置需由set写入
+                void resize(const size_t size);
+
+                void set(const size_t pos, Geometry::GeometryObject *object, const size_t index, const Geometry::AABBRect &rect);
+
+                size_t size() const;
+
+                size_t index(const size_t pos) const;
 
-                bool remove(Geometry::GeometryObject *object);
+                // 将位置不小于begin且AABB矩形与给定矩形相交的对象位置写入positions,返回其数量
+                size_t filter(const double left, const double top, const double right, const double bottom,
+                    const size_t begin, std::vector<size_t> &positions) const;
 
                 bool has(Geometry::GeometryObject *object) const;
 
                 void clear();
 
+                // pos是否位于object内
+                static bool is_selected(const Geometry::Point &pos, const Geometry::GeometryObject *object);
+
+                // rect是否与object相交
+                static bool is_selected(const Geometry::AABBRect &rect, const Geometry::GeometryObject *object);
+
                 bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const;
 
                 bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
 
-                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects) const;
+                // 与pos距离不超过radius的对象及其距离,不排序
+                bool query_radius(const Geometry::Point &pos, const double radius, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const;
+
+                // 将对象放入objects中begin之后的最大堆,见push_nearest,只检测is_owner对句柄返回true的对象
+                template <typename F>
+                void query_knn(const Geometry::Point &pos, const size_t k, const size_t begin, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects,
+                    const F &is_owner) const;
+
+                // rect为object的AABB矩形,layer为object的碰撞层,先以AABB矩形与碰撞层筛选,再对剩余对象做GJK检测
+                bool find_collision_objects(const Geometry::GeometryObject *object, const Geometry::AABBRect &rect, const CollisionLayer &layer,
+                    const CollisionFilter &collision_filter, std::vector<Geometry::GeometryObject *> &objects, CollisionStatistics &statistics) const;
+
+                // 只接受比hit更近的交点,hit.object为nullptr时以hit.t为射线的最大长度
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, RaycastHit &hit) const;
+
+                // 不去重,由调用者调用sort_raycast_hits
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const;
+            };
 
-                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const;
+            struct GridMapConfig
+            {
+                // 对象数量超过split_objects或范围宽度超过split_width时才划分网格,否则只有一个网格
+                size_t split_objects = 40;
+                double split_width = 800;
+                // 网格的列数与行数
+                size_t columns = 8;
+                size_t rows = 4;
+                // 大于0时按范围与该尺寸计算行列数,且不超过columns与rows
+                double cell_size = 0;
             };
 
             class GridMap
             {
             private:
+                struct GridRange
+                {
+                    size_t left = 0;
+                    size_t top = 0;
+                    size_t right = 0;
+                    size_t bottom = 0;
+                };
+
+                // 对象所在的网格及其在网格中的位置
+                struct GridEntry
+                {
+                    size_t grid = 0;
+                    size_t pos = 0;
+                };
+
                 std::vector<GridNode> _grids;
+                size_t _columns = 1, _rows = 1;
+                // 以句柄为下标,已删除对象的位置为nullptr
                 std::vector<Geometry::GeometryObject *> _objects;
                 std::vector<Geometry::AABBRect> _rects;
-                double _left, _top, _right, _bottom;
+                // 对象所在的网格,第一项为其覆盖范围左上角的网格
+                std::vector<std::vector<GridEntry>> _entries;
+                std::vector<size_t> _free_indexs;
+                std::unordered_map<Geometry::GeometryObject *, size_t> _indexs;
+                // 以句柄为下标的碰撞层,在宽相位中先于GJK检测筛选对象对
+                CollisionFilter _filter;
+                double _left = 0, _top = 100, _right = 100, _bottom = 0;
+                GridMapConfig _config;
+                // 重建时的缓冲区,保留容量以免重复分配
+                std::vector<GridRange> _ranges;
+                // 第c段对象在第g个网格中的数量及起始位置,下标为c * 网格数量 + g
+                std::vector<size_t> _offsets;
+                // 每段对象的范围,依次为left、top、right、bottom
+                std::vector<double> _bounds;
+
+                GridRange grid_range(const Geometry::AABBRect &rect) const;
+
+                // 覆盖范围左上角分别为grid0与grid1的两个矩形,其共同覆盖范围左上角的网格
+                size_t owner_grid(const size_t grid0, const size_t grid1) const;
+
+                bool is_in_bounds(const Geometry::AABBRect &rect) const;
+
+                void insert_grids(const size_t index);
+
+                void remove_grids(const size_t index);
+
+                void rebuild();
+
+                // 两遍计数排序:先统计各段对象在每个网格中的数量,前缀和得到写入位置后再分段写入,pool不为nullptr时并行处理各段
+                void rebuild(ThreadPool *pool);
+
+                // 按DDA算法依次访问射线穿过的网格,visit返回true时停止,其参数为网格下标与射线离开该网格的位置
+                template <typename F>
+                void traverse(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, const F &visit) const;
+
+                // 检测网格grid中位置在[begin, end)内的对象与其后对象的碰撞,positions为AABB筛选的缓冲区,narrow为false时不做GJK检测
+                void find_collision_pairs(const size_t grid, const size_t begin, const size_t end, const bool norepeat, const bool narrow,
+                    std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, std::vector<size_t> &positions,
+                    CollisionStatistics &statistics) const;
 
             public:
-                GridMap();
+                GridMap(const GridMapConfig &config = GridMapConfig());
 
-                GridMap(const std::vector<Geometry::GeometryObject *> &objects);
+                GridMap(const std::vector<Geometry::GeometryObject *> &objects, const GridMapConfig &config = GridMapConfig());
 
-                GridMap(const std::initializer_list<Geometry::GeometryObject *> &objects);
+                GridMap(const std::initializer_list<Geometry::GeometryObject *> &objects, const GridMapConfig &config = GridMapConfig());
 
-                GridMap(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+                GridMap(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end,
+                    const GridMapConfig &config = GridMapConfig());
 
                 void build(const std::vector<Geometry::GeometryObject *> &objects);
 
@@ -66,7 +206,11 @@ namespace ToyGameEngine
 
                 void build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects);
 
-                void append(Geometry::GeometryObject *object);
+                // 由线程池并行计算AABB矩形并重建网格
+                void build(const std::vector<Geometry::GeometryObject *> &objects, ThreadPool &pool);
+
+                // 返回对象的句柄,对象删除前句柄保持不变
+                size_t append(Geometry::GeometryObject *object);
 
                 void remove(Geometry::GeometryObject *object);
 
@@ -74,17 +218,64 @@ namespace ToyGameEngine
 
                 void update();
 
+                // 由线程池并行刷新全部AABB矩形并重建网格
+                void update(ThreadPool &pool);
+
+                // 批量更新多个对象,先刷新全部AABB矩形,最多重建或扩展一次
+                void update(const std::vector<Geometry::GeometryObject *> &objects);
+
+                void update(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
                 bool has(Geometry::GeometryObject *object) const;
 
                 void clear();
 
+                const GridMapConfig &config() const;
+
+                // 修改参数并重建网格
+                void set_config(const GridMapConfig &config);
+
                 bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const;
 
                 bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
 
+                // 与pos距离不超过radius的对象及其距离,按距离升序追加到objects
+                bool query_radius(const Geometry::Point &pos, const double radius, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const;
+
+                // 距离pos最近的k个对象及其距离,按距离升序追加到objects,按网格与pos的距离由近及远访问网格
+                bool query_knn(const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const;
+
+                // 对象不在检测器中时为默认层
+                const CollisionLayer &layer(const Geometry::GeometryObject *object) const;
+
+                // 对象不在检测器中时忽略,build与clear后全部对象恢复为默认层
+                void set_layer(Geometry::GeometryObject *object, const CollisionLayer &layer);
+
                 bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const;
 
+                // 各阶段剔除的候选数量累加到statistics,由调用者持有,各线程使用各自的statistics时可以同时查询
+                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects,
+                    CollisionStatistics &statistics, const bool norepeat = true) const;
+
                 bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const;
+
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, CollisionStatistics &statistics,
+                    const bool norepeat = true) const;
+
+                // 由线程池并行检测,结果与串行检测的结果及顺序完全一致
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, ThreadPool &pool, const bool norepeat = true) const;
+
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, ThreadPool &pool,
+                    CollisionStatistics &statistics, const bool norepeat = true) const;
+
+                // AABB矩形相交的对象对,不做GJK检测,每对只输出一次
+                bool find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const;
+
+                // 沿射线逐个访问网格,找到的交点不晚于离开当前网格时停止
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit) const;
+
+                // 射线穿过的全部对象,按t升序追加到hits
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const;
             };
         }
     }
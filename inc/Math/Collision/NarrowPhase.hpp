@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+#include "Math/Geometry/AllGeometryObjects.hpp"
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            // 批量GJK检测,results[i]为pairs[i]的检测结果
+            // 圆与圆、AABB矩形与AABB矩形的碰撞对按类型分组,将坐标打包为连续数组后用SIMD批量检测,其余碰撞对逐个调用gjk
+            void batch_gjk(const std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, std::vector<unsigned char> &results);
+
+            // 用batch_gjk检测begin之后的碰撞对,删除不相交的碰撞对,其余碰撞对保持原有顺序
+            bool filter_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const size_t begin = 0);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include "Math/Geometry/AllGeometryObjects.hpp"
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            // pos到对象的距离,封闭图形视为实心,pos位于其内部时为0
+            double distance(const Geometry::Point &pos, const Geometry::GeometryObject *object);
+
+            // pos到AABB矩形的距离,pos位于矩形内时为0,不大于pos到矩形内任意对象的距离
+            double distance(const Geometry::Point &pos, const double left, const double top, const double right, const double bottom);
+
+            // AABB矩形上距离pos最近的点
+            Geometry::Point nearest_point(const Geometry::Point &pos, const Geometry::AABBRect &rect);
+
+            bool is_nearer(const std::pair<Geometry::GeometryObject *, double> &object0, const std::pair<Geometry::GeometryObject *, double> &object1);
+
+            // objects中begin之后的部分为按距离排列的最大堆,最多保留k个距离最小的对象,不检查重复
+            void push_nearest(std::vector<std::pair<Geometry::GeometryObject *, double>> &objects, const size_t begin, const size_t k,
+                Geometry::GeometryObject *object, const double distance);
+
+            // 堆中的最大距离,不足k个对象时为DBL_MAX,距离大于该值的对象不必再检测
+            double nearest_bound(const std::vector<std::pair<Geometry::GeometryObject *, double>> &objects, const size_t begin, const size_t k);
+
+            // 将begin之后的最大堆按距离升序排列
+            void sort_nearest(std::vector<std::pair<Geometry::GeometryObject *, double>> &objects, const size_t begin);
+
+            // 逐个检测全部对象,objects中的nullptr被跳过,结果按距离升序追加到result
+            bool query_radius(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+                const Geometry::Point &pos, const double radius, std::vector<std::pair<Geometry::GeometryObject *, double>> &result);
+
+            bool query_knn(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+                const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &result);
+        }
+    }
+}
\ No newline at end of file
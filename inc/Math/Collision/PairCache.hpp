@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "Math/Geometry/AABBRect.hpp"
+#include "Math/Collision/Algorithm.hpp"
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            enum class ContactState {BEGIN, STAY, END};
+
+            // id为碰撞对的编号,碰撞对从出现到消失期间保持不变,消失后可能被新的碰撞对复用
+            struct ContactEvent
+            {
+                size_t id = 0;
+                Geometry::GeometryObject *object0 = nullptr;
+                Geometry::GeometryObject *object1 = nullptr;
+                ContactState state = ContactState::BEGIN;
+            };
+
+            // 在帧之间保存候选碰撞对及其GJK结果,据此输出开始、持续与结束的接触事件
+            class PairCache
+            {
+            private:
+                struct PairKey
+                {
+                    const Geometry::GeometryObject *object0 = nullptr;
+                    const Geometry::GeometryObject *object1 = nullptr;
+
+                    bool operator==(const PairKey &key) const;
+                };
+
+                struct PairKeyHash
+                {
+                    size_t operator()(const PairKey &key) const;
+                };
+
+                // 对象的扩大AABB矩形,AABB矩形超出扩大AABB矩形时重新扩大并更新version
+                struct Proxy
+                {
+                    double left = 0;
+                    double top = 0;
+                    double right = 0;
+                    double bottom = 0;
+                    size_t version = 0;
+                    size_t frame = 0;
+                };
+
+                struct PairEntry
+                {
+                    // 第一次出现时的顺序,之后的事件与GJK检测都保持该顺序
+                    Geometry::GeometryObject *object0 = nullptr;
+                    Geometry::GeometryObject *object1 = nullptr;
+                    // 上次GJK检测时两个对象的version
+                    size_t version0 = 0;
+                    size_t version1 = 0;
+                    size_t frame = 0;
+                    bool touching = false;
+                    bool used = false;
+                    // 持续接触或靠近的碰撞对再次检测时从上次的结果开始
+                    GJKCache gjk_cache;
+                };
+
+                // 以碰撞对编号为下标,已释放的位置used为false
+                std::vector<PairEntry> _pairs;
+                std::vector<size_t> _free_indexs;
+                std::unordered_map<PairKey, size_t, PairKeyHash> _indexs;
+                std::unordered_map<const Geometry::GeometryObject *, Proxy> _proxies;
+                double _margin = 0.1;
+                size_t _frame = 0;
+                // 全部对象共用的version计数,重新扩大的AABB矩形总是得到新的version
+                size_t _version = 0;
+                // 上次update中执行GJK检测的次数
+                size_t _gjk_count = 0;
+
+                static PairKey make_key(const Geometry::GeometryObject *object0, const Geometry::GeometryObject *object1);
+
+                // 刷新对象的扩大AABB矩形,返回其version
+                size_t refresh(const Geometry::GeometryObject *object);
+
+            public:
+                // candidates为本帧AABB矩形相交的对象对,每对只出现一次
+                // 两个对象的AABB矩形都未超出上次的扩大AABB矩形时不做GJK检测,沿用上次的结果
+                void update(const std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &candidates, std::vector<ContactEvent> &events);
+
+                void clear();
+
+                size_t size() const;
+
+                double margin() const;
+
+                // 扩大AABB矩形的比例,为0时对象的AABB矩形变化即重新检测
+                void set_margin(const double value);
+
+                size_t gjk_count() const;
+            };
+        }
+    }
+}
\ No newline at end of file
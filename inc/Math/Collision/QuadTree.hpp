@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include "Math/Collision/GridMap.hpp"
 
 
@@ -9,63 +10,131 @@ namespace ToyGameEngine
     {
         namespace Collision
         {
-            class QuadTreeNode : public GridNode
+            struct QuadTreeConfig
+            {
+                // 叶节点对象数量超过max_objects时分裂
+                size_t max_objects = 40;
+                // 节点宽度超过split_width时,对象数量超过min_objects即分裂;合并后对象数量少于min_objects时总是合并
+                size_t min_objects = 4;
+                double split_width = 200;
+                // 子节点宽度或高度小于min_size时不再分裂
+                double min_size = 0;
+                // 对象完全重合时无法继续分裂,以此限制树的深度
+                size_t max_depth = 24;
+                // 松散模式下节点边界向外扩大的比例,为0时对象存放在与其相交的每个叶节点中
+                double looseness = 0;
+            };
+
+            class QuadTree
             {
             private:
-                QuadTreeNode *_nodes[4] = {nullptr};
+                static constexpr uint32_t NULL_INDEX = UINT32_MAX;
+
+                // 节点存放在连续的节点池中,同一节点的四个子节点相邻存放,依次为左上、右上、左下、右下
+                struct Node
+                {
+                    double left = 0;
+                    double top = 0;
+                    double right = 0;
+                    double bottom = 0;
+                    // 第一个子节点的下标,叶节点为0
+                    uint32_t children = 0;
+                    // 节点对象链表的第一个元素,松散模式下非叶节点也可以存放对象
+                    uint32_t first = NULL_INDEX;
+                    uint32_t count = 0;
+                    // 撤销分裂时的对象数量,对象数量增加到其2倍前不再尝试分裂,减少到一半时清零
+                    uint32_t unsplit = 0;
+                };
+
+                // 叶节点中的对象,所有叶节点共用一个元素池,同一叶节点的元素以next串联
+                struct Element
+                {
+                    uint32_t index = 0;
+                    uint32_t next = NULL_INDEX;
+                };
+
+                // 根节点固定为_nodes[0]
+                std::vector<Node> _nodes;
+                std::vector<uint32_t> _free_nodes;
+                std::vector<Element> _elements;
+                uint32_t _free_element = NULL_INDEX;
+                // 以句柄为下标,已删除对象的位置为nullptr
+                std::vector<Geometry::GeometryObject *> _objects;
+                std::vector<Geometry::AABBRect> _rects;
+                std::vector<size_t> _free_indexs;
+                std::unordered_map<Geometry::GeometryObject *, size_t> _indexs;
+                // 以句柄为下标的碰撞层,在宽相位中先于GJK检测筛选对象对
+                CollisionFilter _filter;
+                QuadTreeConfig _config;
+                // 分裂与合并时暂存对象的缓冲区,保留容量以免重复分配
+                std::vector<uint32_t> _buffer;
 
-                void split();
+                // 按扩大后的边界判断
+                bool is_overlapped(const Node &node, const Geometry::AABBRect &rect) const;
 
-                bool is_tail_node() const;
+                // 按扩大后的边界判断
+                bool is_contained(const Node &node, const Geometry::AABBRect &rect) const;
 
-                bool merge();
-            
-            public:
-                QuadTreeNode();
+                // node的子节点中包含pos的一个
+                uint32_t child(const uint32_t node, const Geometry::Point &pos) const;
 
-                QuadTreeNode(const Geometry::AABBRect &rect);
+                bool need_split(const Node &node, const size_t depth) const;
 
-                QuadTreeNode(const double left, const double top, const double right, const double bottom);
+                bool can_merge(const Node &node, const size_t count) const;
 
-                ~QuadTreeNode();
+                // 按左闭右开、上闭下开的规则判断pos是否归属于node,位于根节点右边界或下边界上的点归属于边界上的节点
+                bool is_owner(const Node &node, const Geometry::Point &pos) const;
 
-                bool append(Geometry::GeometryObject *object);
+                // 返回相邻四个子节点中第一个的下标
+                uint32_t allocate_children();
 
-                void append_node(const size_t index, QuadTreeNode *node);
+                void push_element(const uint32_t node, const uint32_t index);
 
-                bool remove(Geometry::GeometryObject *object);
+                // 释放叶节点的全部元素
+                void clear_elements(const uint32_t node);
 
-                bool has(Geometry::GeometryObject *object) const;
+                void split(const uint32_t node, const size_t depth);
 
-                void clear();
+                bool merge(const uint32_t node);
 
-                bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const;
+                void insert(const size_t index);
 
-                bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
+                // 只访问与rect相交的子节点
+                bool remove(const uint32_t node, const size_t index, const Geometry::AABBRect &rect);
 
-                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const;
+                // 扩大根节点直到包含rect
+                void expand(const Geometry::AABBRect &rect);
 
-                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const;
-            };
-            
-            class QuadTree
-            {
-            private:
-                QuadTreeNode *_root = nullptr;
-                std::vector<Geometry::GeometryObject *> _objects;
-                std::vector<Geometry::AABBRect> _rects;
-                double _left, _top, _right, _bottom;
+                // 全部对象先放入根节点,再自上而下分裂,节点池与元素池保留容量
+                void rebuild();
 
-            public:
-                QuadTree();
+                // 射线进入按扩大后的边界计算的节点的位置
+                bool raycast(const Node &node, const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, double &enter) const;
+
+                // pos到按扩大后的边界计算的节点的距离
+                double distance(const Node &node, const Geometry::Point &pos) const;
+
+                // 按深度优先的顺序收集含有对象的节点
+                void occupied(std::vector<uint32_t> &nodes) const;
 
-                QuadTree(const std::vector<Geometry::GeometryObject *> &objects);
+                // 将节点的对象收集到grid中,以便按分量筛选AABB矩形
+                void gather(const uint32_t node, GridNode &grid) const;
 
-                QuadTree(const std::initializer_list<Geometry::GeometryObject *> &objects);
+                // 检测grid中位置在[begin, end)内的对象与其后对象的碰撞,grid由节点node收集而来,narrow为false时不做GJK检测
+                // 松散模式下还检测这些对象与下标大于node的节点中对象的碰撞
+                void find_collision_pairs(const uint32_t node, const GridNode &grid, const size_t begin, const size_t end, const bool norepeat, const bool narrow,
+                    std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, std::vector<size_t> &positions,
+                    CollisionStatistics &statistics) const;
 
-                QuadTree(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+            public:
+                QuadTree(const QuadTreeConfig &config = QuadTreeConfig());
+
+                QuadTree(const std::vector<Geometry::GeometryObject *> &objects, const QuadTreeConfig &config = QuadTreeConfig());
+
+                QuadTree(const std::initializer_list<Geometry::GeometryObject *> &objects, const QuadTreeConfig &config = QuadTreeConfig());
 
-                ~QuadTree();
+                QuadTree(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end,
+                    const QuadTreeConfig &config = QuadTreeConfig());
 
                 void build(const std::vector<Geometry::GeometryObject *> &objects);
 
@@ -73,7 +142,11 @@ namespace ToyGameEngine
 
                 void build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects);
 
-                void append(Geometry::GeometryObject *object);
+                // 由线程池并行计算AABB矩形并重建
+                void build(const std::vector<Geometry::GeometryObject *> &objects, ThreadPool &pool);
+
+                // 返回对象的句柄,对象删除前句柄保持不变
+                size_t append(Geometry::GeometryObject *object);
 
                 void remove(Geometry::GeometryObject *object);
 
@@ -81,17 +154,70 @@ namespace ToyGameEngine
 
                 void update();
 
+                // 由线程池并行刷新全部AABB矩形并重建
+                void update(ThreadPool &pool);
+
+                // 批量更新多个对象,先刷新全部AABB矩形,最多重建或扩展一次
+                void update(const std::vector<Geometry::GeometryObject *> &objects);
+
+                void update(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
                 bool has(Geometry::GeometryObject *object) const;
 
+                // 保留节点池与元素池的容量
                 void clear();
 
+                const QuadTreeConfig &config() const;
+
+                // 修改参数并重建
+                void set_config(const QuadTreeConfig &config);
+
+                double looseness() const;
+
+                // 修改扩大比例并重建,大于0时每个对象只存放在完全包含它的最深节点中,查询时同时访问非叶节点
+                void set_looseness(const double value);
+
                 bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const;
 
                 bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
 
+                // 与pos距离不超过radius的对象及其距离,按距离升序追加到objects
+                bool query_radius(const Geometry::Point &pos, const double radius, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const;
+
+                // 距离pos最近的k个对象及其距离,按距离升序追加到objects,按节点与pos的距离由近及远访问节点
+                bool query_knn(const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const;
+
+                // 对象不在检测器中时为默认层
+                const CollisionLayer &layer(const Geometry::GeometryObject *object) const;
+
+                // 对象不在检测器中时忽略,build与clear后全部对象恢复为默认层
+                void set_layer(Geometry::GeometryObject *object, const CollisionLayer &layer);
+
                 bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const;
 
+                // 各阶段剔除的候选数量累加到statistics,由调用者持有,各线程使用各自的statistics时可以同时查询
+                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects,
+                    CollisionStatistics &statistics, const bool norepeat = true) const;
+
                 bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const;
+
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, CollisionStatistics &statistics,
+                    const bool norepeat = true) const;
+
+                // 由线程池并行检测,结果与串行检测的结果及顺序完全一致
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, ThreadPool &pool, const bool norepeat = true) const;
+
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, ThreadPool &pool,
+                    CollisionStatistics &statistics, const bool norepeat = true) const;
+
+                // AABB矩形相交的对象对,不做GJK检测,每对只输出一次
+                bool find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const;
+
+                // 按进入节点的先后顺序访问节点,剩余节点都不早于已找到的交点时停止
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit) const;
+
+                // 射线穿过的全部对象,按t升序追加到hits
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const;
             };
         }
     }
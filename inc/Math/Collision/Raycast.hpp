@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include "Math/Geometry/AllGeometryObjects.hpp"
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            // 射线上的点为origin + dir * t,t以dir的长度为单位;形状投射时t以位移为单位,point为接触点
+            struct RaycastHit
+            {
+                Geometry::GeometryObject *object = nullptr;
+                Geometry::Point point;
+                // 单位法向量,与射线方向相对;起点位于对象内部时为-dir方向
+                Geometry::Vector normal;
+                double t = 0;
+            };
+
+            // 射线与AABB矩形的进入与离开位置,起点在矩形内时enter为0
+            bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+                const double left, const double top, const double right, const double bottom, double &enter, double &exit);
+
+            // 射线与对象的第一个交点,封闭图形视为实心,线段与折线只与其边相交,点对象不会被射中
+            bool raycast(Geometry::GeometryObject *object, const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit);
+
+            // 对象按射线进入其AABB矩形的先后逐个检测,剩余对象都不早于已找到的交点时停止,objects中的nullptr被跳过
+            bool raycast(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+                const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit);
+
+            bool raycast_all(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+                const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits);
+
+            // object沿(tx, ty)平移时最先接触的对象,按扫掠AABB矩形进入各对象AABB矩形的先后逐个做形状投射,跳过object自身与nullptr
+            bool shape_cast(const Geometry::GeometryObject *object, const double tx, const double ty,
+                const std::vector<Geometry::GeometryObject *> &objects, RaycastHit &hit);
+
+            // object沿(tx, ty)平移时接触的全部对象,按t升序追加到hits
+            bool shape_cast_all(const Geometry::GeometryObject *object, const double tx, const double ty,
+                const std::vector<Geometry::GeometryObject *> &objects, std::vector<RaycastHit> &hits);
+
+            // 按对象去重后按t升序排列hits中begin之后的部分
+            void sort_raycast_hits(std::vector<RaycastHit> &hits, const size_t begin);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <unordered_map>
+#include "Math/Geometry/AABBRect.hpp"
+#include "Math/Collision/Raycast.hpp"
+#include "Math/Collision/CollisionFilter.hpp"
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            class SpatialHash
+            {
+            private:
+                struct CellKey
+                {
+                    long long x = 0;
+                    long long y = 0;
+
+                    bool operator==(const CellKey &key) const;
+                };
+
+                struct CellKeyHash
+                {
+                    size_t operator()(const CellKey &key) const;
+                };
+
+                // 对象占据的单元格范围(闭区间)
+                struct CellRange
+                {
+                    long long left = 0;
+                    long long top = 0;
+                    long long right = 0;
+                    long long bottom = 0;
+                };
+
+                double _cell_size = 100;
+                // 上次计算单元格边长时的对象数量,append使对象数量翻倍后重新计算
+                size_t _sized_count = 0;
+                std::unordered_map<CellKey, std::vector<size_t>, CellKeyHash> _cells;
+                // 跨越单元格过多的对象不写入单元格,单独与所有对象检测
+                std::vector<size_t> _large_objects;
+                std::vector<Geometry::GeometryObject *> _objects;
+                std::vector<Geometry::AABBRect> _rects;
+                std::vector<CellRange> _ranges;
+                // 已占用单元格的范围,删除对象时不收缩
+                CellRange _bounds;
+                std::vector<size_t> _free_indexs;
+                std::unordered_map<Geometry::GeometryObject *, size_t> _indexs;
+                // 以句柄为下标的碰撞层,在宽相位中先于GJK检测筛选对象对
+                CollisionFilter _filter;
+
+                CellRange cell_range(const Geometry::AABBRect &rect) const;
+
+                bool is_large(const CellRange &range) const;
+
+                void insert_cells(const size_t index);
+
+                void remove_cells(const size_t index);
+
+                void rebuild_cells();
+
+                void collect_candidates(const Geometry::AABBRect &rect, std::vector<size_t> &indexs) const;
+
+                // 按DDA算法依次访问射线穿过的单元格,visit返回true时停止,其参数为单元格中的对象(空单元格为nullptr)与射线离开该单元格的位置
+                // 需要访问的单元格多于已占用的单元格时,先将射线裁剪到_bounds内
+                template <typename F>
+                void traverse(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, const F &visit) const;
+
+                // narrow为false时只做AABB检测
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat, const bool narrow) const;
+
+            public:
+                // 单个对象最多写入的单元格数量
+                static const size_t MAX_CELLS_PER_OBJECT = 1024;
+
+                SpatialHash();
+
+                SpatialHash(const std::vector<Geometry::GeometryObject *> &objects);
+
+                SpatialHash(const std::initializer_list<Geometry::GeometryObject *> &objects);
+
+                SpatialHash(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
+                void build(const std::vector<Geometry::GeometryObject *> &objects);
+
+                void build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
+                void build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects);
+
+                // 返回对象的句柄,对象删除前句柄保持不变
+                size_t append(Geometry::GeometryObject *object);
+
+                void remove(Geometry::GeometryObject *object);
+
+                void update(Geometry::GeometryObject *object);
+
+                void update();
+
+                bool has(Geometry::GeometryObject *object) const;
+
+                void clear();
+
+                // 单元格边长,由对象AABB矩形尺寸的中位数决定,逐个append时在对象数量翻倍后更新
+                double cell_size() const;
+
+                bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const;
+
+                bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
+
+                // 对象不在检测器中时为默认层
+                const CollisionLayer &layer(const Geometry::GeometryObject *object) const;
+
+                // 对象不在检测器中时忽略,build与clear后全部对象恢复为默认层
+                void set_layer(Geometry::GeometryObject *object, const CollisionLayer &layer);
+
+                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const;
+
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const;
+
+                // AABB矩形相交的对象对,不做GJK检测,每对只输出一次
+                bool find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const;
+
+                // 沿射线逐个访问单元格,找到的交点不晚于离开当前单元格时停止
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit) const;
+
+                // 射线穿过的全部对象,按t升序追加到hits
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const;
+            };
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include "Math/Geometry/AABBRect.hpp"
+#include "Math/Collision/Raycast.hpp"
+#include "Math/Collision/CollisionFilter.hpp"
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            class SweepAndPrune
+            {
+            private:
+                struct Endpoint
+                {
+                    double value = 0;
+                    size_t index = 0;
+                    bool is_max = false;
+
+                    // 值相同时min端点排在max端点之前,边界接触也算重叠
+                    bool operator<(const Endpoint &endpoint) const;
+                };
+
+                // 对象在两个轴上的min/max端点位置
+                struct EndpointIndex
+                {
+                    size_t min[2] = {0, 0};
+                    size_t max[2] = {0, 0};
+                };
+
+                // 0为x轴,1为y轴
+                std::vector<Endpoint> _endpoints[2];
+                std::vector<EndpointIndex> _endpoint_indexs;
+                // AABB矩形重叠的对象对,随端点交换增量维护
+                std::unordered_set<unsigned long long> _overlap_pairs;
+                std::vector<Geometry::GeometryObject *> _objects;
+                std::vector<Geometry::AABBRect> _rects;
+                std::vector<size_t> _free_indexs;
+                std::unordered_map<Geometry::GeometryObject *, size_t> _indexs;
+                // 以句柄为下标的碰撞层,在宽相位中先于GJK检测筛选对象对
+                CollisionFilter _filter;
+                // 对象AABB矩形的最大宽度,用于确定区间查询的起点
+                double _max_width = 0;
+
+                static unsigned long long pair_key(const size_t index0, const size_t index1);
+
+                bool is_overlapped(const size_t index0, const size_t index1) const;
+
+                void set_endpoint_values(const size_t index);
+
+                void swap_endpoints(const size_t axis, const size_t pos0, const size_t pos1);
+
+                void move_endpoint(const size_t axis, size_t pos);
+
+                void sort_endpoints(const size_t axis);
+
+                void rebuild();
+
+                void collect_candidates(const Geometry::AABBRect &rect, std::vector<size_t> &indexs) const;
+
+                // narrow为false时只做AABB检测
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat, const bool narrow) const;
+
+            public:
+                SweepAndPrune();
+
+                SweepAndPrune(const std::vector<Geometry::GeometryObject *> &objects);
+
+                SweepAndPrune(const std::initializer_list<Geometry::GeometryObject *> &objects);
+
+                SweepAndPrune(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
+                void build(const std::vector<Geometry::GeometryObject *> &objects);
+
+                void build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end);
+
+                void build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects);
+
+                // 返回对象的句柄,对象删除前句柄保持不变
+                size_t append(Geometry::GeometryObject *object);
+
+                void remove(Geometry::GeometryObject *object);
+
+                void update(Geometry::GeometryObject *object);
+
+                void update();
+
+                bool has(Geometry::GeometryObject *object) const;
+
+                void clear();
+
+                bool select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const;
+
+                bool select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const;
+
+                // 对象不在检测器中时为默认层
+                const CollisionLayer &layer(const Geometry::GeometryObject *object) const;
+
+                // 对象不在检测器中时忽略,build与clear后全部对象恢复为默认层
+                void set_layer(Geometry::GeometryObject *object, const CollisionLayer &layer);
+
+                bool find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat = true) const;
+
+                bool find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat = true) const;
+
+                // AABB矩形相交的对象对,不做GJK检测,每对只输出一次
+                bool find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const;
+
+                // 按射线进入AABB矩形的先后检测全部对象
+                bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, RaycastHit &hit) const;
+
+                // 射线穿过的全部对象,按t升序追加到hits
+                bool raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<RaycastHit> &hits) const;
+            };
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+
+namespace ToyGameEngine
+{
+    namespace Math
+    {
+        namespace Collision
+        {
+            // 固定数量线程的线程池,调用run的线程也参与执行任务
+            class ThreadPool
+            {
+            private:
+                std::vector<std::thread> _threads;
+                std::mutex _mutex;
+                std::condition_variable _start_condition;
+                std::condition_variable _finish_condition;
+                std::function<void(const size_t, const size_t)> _task;
+                size_t _task_count = 0;
+                std::atomic<size_t> _next_task{0};
+                // 尚未完成当前批次的工作线程数量
+                size_t _running = 0;
+                // 每次run递增,工作线程据此判断是否有新的批次
+                size_t _generation = 0;
+                bool _stop = false;
+
+                void work(const size_t thread);
+
+            public:
+                // count为参与计算的线程总数,包括调用run的线程
+                ThreadPool(const size_t count = std::thread::hardware_concurrency());
+
+                ~ThreadPool();
+
+                ThreadPool(const ThreadPool &) = delete;
+
+                ThreadPool &operator=(const ThreadPool &) = delete;
+
+                size_t size() const;
+
+                // 执行编号为0至count-1的任务,task的参数为任务编号与线程编号,返回时全部任务已完成
+                // 同一时间只能由一个线程调用
+                void run(const size_t count, const std::function<void(const size_t, const size_t)> &task);
+            };
+        }
+    }
+}
\ No newline at end of file
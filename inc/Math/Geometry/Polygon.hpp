@@ -11,6 +11,9 @@ namespace ToyGameEngine
         {
             class Polygon : public Polyline
             {
+            private:
+                bool check_convex() const;
+
             public:
                 Polygon();
 
@@ -26,6 +29,8 @@ namespace ToyGameEngine
 
                 Polygon(const AABBRect &rect);
 
+                void update_cache() override;
+
                 Polygon &operator=(const Polygon &polygon);
 
                 Polygon &operator=(const Rectangle &rect);
@@ -39,6 +44,9 @@ namespace ToyGameEngine
                 // 判断点顺序是否为顺时针
                 bool is_cw() const;
 
+                // 判断是否为严格凸多边形,相邻边共线或有重合点时不算,结果在修改点时重新计算
+                bool is_convex() const;
+
                 void append(const Point &point) override;
 
                 void append(const Polyline &polyline) override;
@@ -57,6 +65,8 @@ namespace ToyGameEngine
 
                 Point pop(const size_t index) override;
 
+                void set_point(const size_t index, const Point &point) override;
+
                 Polygon operator+(const Point &point) const;
 
                 Polygon operator-(const Point &point) const;
@@ -67,14 +77,10 @@ namespace ToyGameEngine
 
                 const Point &next_point(const size_t index) const;
 
-                Point &next_point(const size_t index);
-
                 size_t last_point_index(const size_t index) const;
 
                 const Point &last_point(const size_t index) const;
 
-                Point &last_point(const size_t index);
-
                 size_t index(const double x, const double y) const;
 
                 size_t index(const Point &point) const;
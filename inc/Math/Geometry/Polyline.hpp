@@ -14,6 +14,18 @@ namespace ToyGameEngine
             {
             protected:
                 std::vector<Point> _points;
+                // 外接AABB矩形与全部点坐标之和的缓存,由修改_points的函数重新计算,const函数只读取,可在多个线程中同时调用
+                double _left = 0, _top = 0, _right = 0, _bottom = 0;
+                Point _sum;
+                bool _cached = false;
+                // 是否为严格凸多边形的缓存,只用于Polygon
+                bool _convex = false;
+
+                // 在末尾添加下标first之后的点后调用,只用新的点扩展缓存
+                void extend_cache(const size_t first);
+
+                // 全部点的坐标之和
+                Point points_sum() const;
 
             public:
                 Polyline();
@@ -26,6 +38,9 @@ namespace ToyGameEngine
 
                 Polyline(const std::initializer_list<Point> &points);
 
+                // 重新计算缓存
+                virtual void update_cache();
+
                 size_t size() const;
 
                 bool empty() const override;
@@ -38,10 +53,11 @@ namespace ToyGameEngine
 
                 bool is_self_intersected() const;
 
-                Point &operator[](const size_t index);
-
                 const Point &operator[](const size_t index) const;
 
+                // 访问函数只返回const引用,修改点只能通过set_point等函数,保证缓存与点一致
+                virtual void set_point(const size_t index, const Point &point);
+
                 Polyline &operator=(const Polyline &polyline);
 
                 Polyline operator+(const Point &point) const;
@@ -72,40 +88,26 @@ namespace ToyGameEngine
 
                 void flip();
 
-                Point &front();
-
                 const Point &front() const;
 
-                Point &back();
-
                 const Point &back() const;
 
-                std::vector<Point>::iterator begin();
-
                 std::vector<Point>::const_iterator begin() const;
 
                 std::vector<Point>::const_iterator cbegin() const;
 
-                std::vector<Point>::iterator end();
-
                 std::vector<Point>::const_iterator end() const;
 
                 std::vector<Point>::const_iterator cend() const;
 
-                std::vector<Point>::reverse_iterator rbegin();
-
                 std::vector<Point>::const_reverse_iterator rbegin() const;
 
                 std::vector<Point>::const_reverse_iterator crbegin() const;
 
-                std::vector<Point>::reverse_iterator rend();
-
                 std::vector<Point>::const_reverse_iterator rend() const;
 
                 std::vector<Point>::const_reverse_iterator crend() const;
 
-                std::vector<Point>::iterator find(const Point &point);
-
                 std::vector<Point>::const_iterator find(const Point &point) const;
 
                 void transform(const double a, const double b, const double c, const double d, const double e, const double f) override;
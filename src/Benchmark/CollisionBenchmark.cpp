@@ -0,0 +1,192 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include "Math/Collision/GridMap.hpp"
+#include "Math/Collision/QuadTree.hpp"
+#include "Math/Geometry/AllGeometryObjects.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+// 在合成场景上扫描GridMap与QuadTree的参数,输出构建、更新与查询的耗时(毫秒)
+// 用法: CollisionBenchmark [对象数量] [场景宽度]
+
+enum class Distribution
+{
+    Uniform,
+    Clustered,
+    PowerLaw
+};
+
+struct BenchmarkResult
+{
+    double build = 0;
+    double update = 0;
+    double batch_update = 0;
+    double pairs = 0;
+    double query = 0;
+    size_t pair_count = 0;
+};
+
+static const char *distribution_name(const Distribution distribution)
+{
+    switch (distribution)
+    {
+    case Distribution::Uniform:
+        return "uniform";
+    case Distribution::Clustered:
+        return "clustered";
+    default:
+        return "power-law";
+    }
+}
+
+template <typename F>
+static double elapsed(F &&function)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Uniform: 位置与尺寸均匀分布; Clustered: 位置按正态分布聚集在16个簇附近; PowerLaw: 位置均匀分布,尺寸服从幂律分布
+static void generate(const Distribution distribution, const size_t count, const double world, std::vector<Geometry::GeometryObject *> &objects)
+{
+    std::mt19937 rng(static_cast<unsigned int>(count));
+    std::uniform_real_distribution<double> position(0, world), size(2, 20), unit(0, 1);
+    std::vector<Geometry::Point> centers;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        centers.emplace_back(position(rng), position(rng));
+    }
+    std::normal_distribution<double> offset(0, world / 40);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        double x = position(rng), y = position(rng), s = size(rng);
+        if (distribution == Distribution::Clustered)
+        {
+            const Geometry::Point &center = centers[i % centers.size()];
+            x = center.x + offset(rng);
+            y = center.y + offset(rng);
+        }
+        else if (distribution == Distribution::PowerLaw)
+        {
+            // 帕累托分布,指数为1.5,最大不超过场景宽度的1/8
+            s = std::min(2 / std::pow(1 - unit(rng), 1 / 1.5), world / 8);
+        }
+
+        if (i % 2 == 0)
+        {
+            objects.push_back(new Geometry::Circle(x, y, s));
+        }
+        else
+        {
+            objects.push_back(new Geometry::Triangle(x, y, x + s, y, x, y + s));
+        }
+    }
+}
+
+template <typename T, typename Config>
+static BenchmarkResult measure(const Config &config, const std::vector<Geometry::GeometryObject *> &objects, const double world)
+{
+    BenchmarkResult result;
+    T detector(config);
+    result.build = elapsed([&]() { detector.build(objects); });
+
+    // 每轮移动10%的对象,结束后移回原处,保证各组参数面对相同的场景
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pick(0, objects.size() - 1);
+    std::uniform_real_distribution<double> step(-world / 100, world / 100), position(0, world);
+    std::vector<Geometry::GeometryObject *> moved;
+    std::vector<Geometry::Point> offsets;
+    for (size_t i = 0, count = objects.size() / 10; i < count; ++i)
+    {
+        moved.push_back(objects[pick(rng)]);
+        offsets.emplace_back(step(rng), step(rng));
+        moved.back()->translate(offsets.back().x, offsets.back().y);
+    }
+    result.update = elapsed([&]()
+        {
+            for (Geometry::GeometryObject *object : moved)
+            {
+                detector.update(object);
+            }
+        });
+    for (size_t i = moved.size(); i-- > 0;)
+    {
+        moved[i]->translate(-offsets[i].x, -offsets[i].y);
+    }
+    result.batch_update = elapsed([&]() { detector.update(moved); });
+
+    std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> pairs;
+    result.pairs = elapsed([&]() { detector.find_collision_pairs(pairs); });
+    result.pair_count = pairs.size();
+
+    std::vector<Geometry::GeometryObject *> selected;
+    result.query = elapsed([&]()
+        {
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                detector.find_collision_objects(objects[pick(rng)], selected);
+                detector.select(Geometry::Point(position(rng), position(rng)), selected);
+                selected.clear();
+            }
+        });
+    return result;
+}
+
+static void print(const std::string &name, const BenchmarkResult &result)
+{
+    std::printf("%-48s %10.2f %10.2f %10.2f %10.2f %10.2f %10zu\n", name.c_str(), result.build, result.update,
+        result.batch_update, result.pairs, result.query, result.pair_count);
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 10000;
+    const double world = argc > 2 ? std::stod(argv[2]) : 4000;
+
+    for (const Distribution distribution : {Distribution::Uniform, Distribution::Clustered, Distribution::PowerLaw})
+    {
+        std::vector<Geometry::GeometryObject *> objects;
+        generate(distribution, count, world, objects);
+        std::printf("\n%s, %zu objects, world %.0f\n", distribution_name(distribution), count, world);
+        std::printf("%-48s %10s %10s %10s %10s %10s %10s\n", "config", "build", "update", "batch", "pairs", "query", "count");
+
+        for (const size_t max_objects : {8, 16, 40, 64})
+        {
+            for (const double split_width : {100.0, 200.0, 400.0})
+            {
+                for (const double looseness : {0.0, 0.5})
+                {
+                    Collision::QuadTreeConfig config;
+                    config.max_objects = max_objects;
+                    config.split_width = split_width;
+                    config.looseness = looseness;
+                    print("QuadTree max_objects=" + std::to_string(max_objects) + " split_width=" + std::to_string(static_cast<int>(split_width))
+                        + " looseness=" + std::to_string(looseness).substr(0, 3), measure<Collision::QuadTree>(config, objects, world));
+                }
+            }
+        }
+
+        for (const size_t resolution : {8, 16, 32, 64})
+        {
+            for (const double cell_size : {0.0, 25.0, 50.0, 100.0})
+            {
+                Collision::GridMapConfig config;
+                config.columns = config.rows = resolution;
+                config.cell_size = cell_size;
+                print("GridMap " + std::to_string(resolution) + "x" + std::to_string(resolution) + " cell_size="
+                    + std::to_string(static_cast<int>(cell_size)), measure<Collision::GridMap>(config, objects, world));
+            }
+        }
+
+        for (Geometry::GeometryObject *object : objects)
+        {
+            delete object;
+        }
+    }
+    return 0;
+}
\ No newline at end of file
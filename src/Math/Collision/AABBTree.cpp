@@ -0,0 +1,729 @@
+#include <cfloat>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include "Math/Collision/AABBTree.hpp"
+#include "Math/Collision/Algorithm.hpp"
+#include "Math/Geometry/Algorithm.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+bool Collision::AABBTree::Node::is_leaf() const
+{
+    return children[0] == Collision::AABBTree::NULL_NODE;
+}
+
+
+Collision::AABBTree::AABBTree()
+{
+
+}
+
+Collision::AABBTree::AABBTree(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    build(objects);
+}
+
+Collision::AABBTree::AABBTree(const std::initializer_list<Geometry::GeometryObject *> &objects)
+{
+    build(std::vector<Geometry::GeometryObject *>(objects.begin(), objects.end()));
+}
+
+Collision::AABBTree::AABBTree(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    build(begin, end);
+}
+
+double Collision::AABBTree::perimeter(const Collision::AABBTree::Bounds &bounds)
+{
+    return 2 * (bounds.right - bounds.left + bounds.top - bounds.bottom);
+}
+
+Collision::AABBTree::Bounds Collision::AABBTree::merge(const Collision::AABBTree::Bounds &bounds0, const Collision::AABBTree::Bounds &bounds1)
+{
+    Collision::AABBTree::Bounds bounds;
+    bounds.left = std::min(bounds0.left, bounds1.left);
+    bounds.top = std::max(bounds0.top, bounds1.top);
+    bounds.right = std::max(bounds0.right, bounds1.right);
+    bounds.bottom = std::min(bounds0.bottom, bounds1.bottom);
+    return bounds;
+}
+
+bool Collision::AABBTree::is_contained(const Collision::AABBTree::Bounds &outer, const Collision::AABBTree::Bounds &inner)
+{
+    return outer.left <= inner.left && outer.right >= inner.right
+        && outer.bottom <= inner.bottom && outer.top >= inner.top;
+}
+
+bool Collision::AABBTree::is_overlapped(const Collision::AABBTree::Bounds &bounds0, const Collision::AABBTree::Bounds &bounds1)
+{
+    return bounds0.left <= bounds1.right && bounds0.right >= bounds1.left
+        && bounds0.bottom <= bounds1.top && bounds0.top >= bounds1.bottom;
+}
+
+Collision::AABBTree::Bounds Collision::AABBTree::to_bounds(const Geometry::AABBRect &rect)
+{
+    Collision::AABBTree::Bounds bounds;
+    bounds.left = rect.left();
+    bounds.top = rect.top();
+    bounds.right = rect.right();
+    bounds.bottom = rect.bottom();
+    return bounds;
+}
+
+Collision::AABBTree::Bounds Collision::AABBTree::fatten(const Collision::AABBTree::Bounds &bounds) const
+{
+    const double margin = std::max(bounds.right - bounds.left, bounds.top - bounds.bottom) * _margin;
+    Collision::AABBTree::Bounds result(bounds);
+    result.left -= margin;
+    result.top += margin;
+    result.right += margin;
+    result.bottom -= margin;
+    return result;
+}
+
+size_t Collision::AABBTree::allocate_node()
+{
+    size_t node = _nodes.size();
+    if (_free_nodes.empty())
+    {
+        _nodes.emplace_back();
+    }
+    else
+    {
+        node = _free_nodes.back();
+        _free_nodes.pop_back();
+    }
+    Collision::AABBTree::Node &current = _nodes[node];
+    current.parent = current.children[0] = current.children[1] = current.object = Collision::AABBTree::NULL_NODE;
+    current.height = 0;
+    return node;
+}
+
+void Collision::AABBTree::free_node(const size_t node)
+{
+    _nodes[node].height = -1;
+    _free_nodes.push_back(node);
+}
+
+void Collision::AABBTree::insert_leaf(const size_t leaf)
+{
+    if (_root == Collision::AABBTree::NULL_NODE)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = Collision::AABBTree::NULL_NODE;
+        return;
+    }
+
+    // 按表面积启发式(二维下为周长)向下寻找代价最小的兄弟节点
+    const Collision::AABBTree::Bounds bounds(_nodes[leaf].bounds);
+    size_t sibling = _root;
+    while (!_nodes[sibling].is_leaf())
+    {
+        const Collision::AABBTree::Node &node = _nodes[sibling];
+        const double combined_area = perimeter(merge(node.bounds, bounds));
+        // 在此处新建父节点的代价
+        const double cost = 2 * combined_area;
+        // 继续向下时祖先节点增大的代价
+        const double inheritance_cost = 2 * (combined_area - perimeter(node.bounds));
+
+        double costs[2];
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const Collision::AABBTree::Node &child = _nodes[node.children[i]];
+            costs[i] = perimeter(merge(child.bounds, bounds)) + inheritance_cost;
+            if (!child.is_leaf())
+            {
+                costs[i] -= perimeter(child.bounds);
+            }
+        }
+
+        if (cost < costs[0] && cost < costs[1])
+        {
+            break;
+        }
+        sibling = costs[0] < costs[1] ? node.children[0] : node.children[1];
+    }
+
+    const size_t old_parent = _nodes[sibling].parent;
+    const size_t new_parent = allocate_node();
+    Collision::AABBTree::Node &parent = _nodes[new_parent];
+    parent.parent = old_parent;
+    parent.bounds = merge(bounds, _nodes[sibling].bounds);
+    parent.height = _nodes[sibling].height + 1;
+    parent.children[0] = sibling;
+    parent.children[1] = leaf;
+    _nodes[sibling].parent = new_parent;
+    _nodes[leaf].parent = new_parent;
+    if (old_parent == Collision::AABBTree::NULL_NODE)
+    {
+        _root = new_parent;
+    }
+    else if (_nodes[old_parent].children[0] == sibling)
+    {
+        _nodes[old_parent].children[0] = new_parent;
+    }
+    else
+    {
+        _nodes[old_parent].children[1] = new_parent;
+    }
+
+    // 自下而上旋转平衡并更新边界与高度
+    for (size_t node = _nodes[leaf].parent; node != Collision::AABBTree::NULL_NODE; node = _nodes[node].parent)
+    {
+        node = balance(node);
+        Collision::AABBTree::Node &current = _nodes[node];
+        current.height = 1 + std::max(_nodes[current.children[0]].height, _nodes[current.children[1]].height);
+        current.bounds = merge(_nodes[current.children[0]].bounds, _nodes[current.children[1]].bounds);
+    }
+}
+
+void Collision::AABBTree::remove_leaf(const size_t leaf)
+{
+    if (leaf == _root)
+    {
+        _root = Collision::AABBTree::NULL_NODE;
+        return;
+    }
+
+    const size_t parent = _nodes[leaf].parent;
+    const size_t grand_parent = _nodes[parent].parent;
+    const size_t sibling = _nodes[parent].children[0] == leaf ? _nodes[parent].children[1] : _nodes[parent].children[0];
+    free_node(parent);
+    _nodes[sibling].parent = grand_parent;
+    if (grand_parent == Collision::AABBTree::NULL_NODE)
+    {
+        _root = sibling;
+        return;
+    }
+
+    if (_nodes[grand_parent].children[0] == parent)
+    {
+        _nodes[grand_parent].children[0] = sibling;
+    }
+    else
+    {
+        _nodes[grand_parent].children[1] = sibling;
+    }
+    for (size_t node = grand_parent; node != Collision::AABBTree::NULL_NODE; node = _nodes[node].parent)
+    {
+        node = balance(node);
+        Collision::AABBTree::Node &current = _nodes[node];
+        current.height = 1 + std::max(_nodes[current.children[0]].height, _nodes[current.children[1]].height);
+        current.bounds = merge(_nodes[current.children[0]].bounds, _nodes[current.children[1]].bounds);
+    }
+}
+
+size_t Collision::AABBTree::balance(const size_t node)
+{
+    // 左右子树高度差超过1时,将较高一侧的子节点旋转上来,返回旋转后该位置的节点
+    Collision::AABBTree::Node &current = _nodes[node];
+    if (current.is_leaf() || current.height < 2)
+    {
+        return node;
+    }
+
+    const int diff = _nodes[current.children[1]].height - _nodes[current.children[0]].height;
+    if (std::abs(diff) <= 1)
+    {
+        return node;
+    }
+
+    // 较高的子节点p上移,较矮的子节点q留在node下
+    const size_t p = diff > 0 ? current.children[1] : current.children[0], q = diff > 0 ? current.children[0] : current.children[1];
+    Collision::AABBTree::Node &higher = _nodes[p];
+    const size_t f = higher.children[0], g = higher.children[1];
+
+    higher.children[0] = node;
+    higher.parent = current.parent;
+    current.parent = p;
+    if (higher.parent == Collision::AABBTree::NULL_NODE)
+    {
+        _root = p;
+    }
+    else if (_nodes[higher.parent].children[0] == node)
+    {
+        _nodes[higher.parent].children[0] = p;
+    }
+    else
+    {
+        _nodes[higher.parent].children[1] = p;
+    }
+
+    // p较高的子节点留在p下,较矮的子节点交给node
+    const size_t high = _nodes[f].height > _nodes[g].height ? f : g, low = high == f ? g : f;
+    higher.children[1] = high;
+    _nodes[high].parent = p;
+    current.children[0] = q;
+    current.children[1] = low;
+    _nodes[low].parent = node;
+    current.bounds = merge(_nodes[q].bounds, _nodes[low].bounds);
+    current.height = 1 + std::max(_nodes[q].height, _nodes[low].height);
+    higher.bounds = merge(current.bounds, _nodes[high].bounds);
+    higher.height = 1 + std::max(current.height, _nodes[high].height);
+    return p;
+}
+
+void Collision::AABBTree::insert_object(const size_t index)
+{
+    const size_t leaf = allocate_node();
+    _nodes[leaf].bounds = fatten(to_bounds(_rects[index]));
+    _nodes[leaf].object = index;
+    _leaves[index] = leaf;
+    insert_leaf(leaf);
+}
+
+size_t Collision::AABBTree::build_nodes(std::vector<size_t> &leaves, const size_t begin, const size_t end)
+{
+    if (end - begin == 1)
+    {
+        return leaves[begin];
+    }
+
+    // 沿叶节点中心分布较长的轴按中位数二分
+    double left = DBL_MAX, top = -DBL_MAX, right = -DBL_MAX, bottom = DBL_MAX;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const Collision::AABBTree::Bounds &bounds = _nodes[leaves[i]].bounds;
+        const double x = bounds.left + bounds.right, y = bounds.top + bounds.bottom;
+        left = std::min(left, x);
+        right = std::max(right, x);
+        bottom = std::min(bottom, y);
+        top = std::max(top, y);
+    }
+    const size_t mid = begin + (end - begin) / 2;
+    if (right - left >= top - bottom)
+    {
+        std::nth_element(leaves.begin() + begin, leaves.begin() + mid, leaves.begin() + end, [this](const size_t a, const size_t b)
+            { return _nodes[a].bounds.left + _nodes[a].bounds.right < _nodes[b].bounds.left + _nodes[b].bounds.right; });
+    }
+    else
+    {
+        std::nth_element(leaves.begin() + begin, leaves.begin() + mid, leaves.begin() + end, [this](const size_t a, const size_t b)
+            { return _nodes[a].bounds.top + _nodes[a].bounds.bottom < _nodes[b].bounds.top + _nodes[b].bounds.bottom; });
+    }
+
+    const size_t child0 = build_nodes(leaves, begin, mid), child1 = build_nodes(leaves, mid, end);
+    const size_t node = allocate_node();
+    Collision::AABBTree::Node &current = _nodes[node];
+    current.children[0] = child0;
+    current.children[1] = child1;
+    current.bounds = merge(_nodes[child0].bounds, _nodes[child1].bounds);
+    current.height = 1 + std::max(_nodes[child0].height, _nodes[child1].height);
+    _nodes[child0].parent = node;
+    _nodes[child1].parent = node;
+    return node;
+}
+
+void Collision::AABBTree::rebuild()
+{
+    _nodes.clear();
+    _free_nodes.clear();
+    _root = Collision::AABBTree::NULL_NODE;
+    _leaves.assign(_objects.size(), Collision::AABBTree::NULL_NODE);
+    _nodes.reserve(_objects.size() * 2);
+
+    std::vector<size_t> leaves;
+    leaves.reserve(_objects.size());
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            const size_t leaf = allocate_node();
+            _nodes[leaf].bounds = fatten(to_bounds(_rects[i]));
+            _nodes[leaf].object = i;
+            _leaves[i] = leaf;
+            leaves.push_back(leaf);
+        }
+    }
+    if (!leaves.empty())
+    {
+        _root = build_nodes(leaves, 0, leaves.size());
+        _nodes[_root].parent = Collision::AABBTree::NULL_NODE;
+    }
+}
+
+void Collision::AABBTree::collect_candidates(const Collision::AABBTree::Bounds &bounds, std::vector<size_t> &indexs, std::vector<size_t> &nodes) const
+{
+    if (_root == Collision::AABBTree::NULL_NODE)
+    {
+        return;
+    }
+
+    nodes.clear();
+    nodes.push_back(_root);
+    while (!nodes.empty())
+    {
+        const Collision::AABBTree::Node &node = _nodes[nodes.back()];
+        nodes.pop_back();
+        if (!is_overlapped(node.bounds, bounds))
+        {
+            continue;
+        }
+        if (node.is_leaf())
+        {
+            indexs.push_back(node.object);
+        }
+        else
+        {
+            nodes.push_back(node.children[0]);
+            nodes.push_back(node.children[1]);
+        }
+    }
+}
+
+void Collision::AABBTree::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    clear();
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+    {
+        if (_indexs.emplace(*it, _objects.size()).second)
+        {
+            _objects.push_back(*it);
+            _rects.emplace_back((*it)->bounding_rect());
+        }
+    }
+    rebuild();
+}
+
+void Collision::AABBTree::build(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    if (&objects == &_objects)
+    {
+        return update();
+    }
+    build(objects.cbegin(), objects.cend());
+}
+
+void Collision::AABBTree::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
+{
+    if (&objects == &_objects)
+    {
+        return update();
+    }
+
+    clear();
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        if (_indexs.emplace(objects[i], _objects.size()).second)
+        {
+            _objects.push_back(objects[i]);
+            _rects.emplace_back(rects[i]);
+        }
+    }
+    rebuild();
+}
+
+size_t Collision::AABBTree::append(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        return it->second;
+    }
+
+    size_t index = _objects.size();
+    if (_free_indexs.empty())
+    {
+        _objects.push_back(object);
+        _rects.emplace_back(object->bounding_rect());
+        _leaves.push_back(Collision::AABBTree::NULL_NODE);
+    }
+    else
+    {
+        index = _free_indexs.back();
+        _free_indexs.pop_back();
+        _objects[index] = object;
+        _rects[index] = object->bounding_rect();
+    }
+    _indexs[object] = index;
+    insert_object(index);
+    return index;
+}
+
+void Collision::AABBTree::remove(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    remove_leaf(_leaves[index]);
+    free_node(_leaves[index]);
+    _leaves[index] = Collision::AABBTree::NULL_NODE;
+    _filter.reset(it->second);
+    _indexs.erase(it);
+    _objects[index] = nullptr;
+    _free_indexs.push_back(index);
+}
+
+void Collision::AABBTree::update(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second, leaf = _leaves[index];
+    _rects[index] = object->bounding_rect();
+    const Collision::AABBTree::Bounds bounds(to_bounds(_rects[index]));
+    if (!is_contained(_nodes[leaf].bounds, bounds))
+    {
+        remove_leaf(leaf);
+        _nodes[leaf].bounds = fatten(bounds);
+        insert_leaf(leaf);
+    }
+}
+
+void Collision::AABBTree::update()
+{
+    for (Geometry::GeometryObject *object : _objects)
+    {
+        if (object != nullptr)
+        {
+            update(object);
+        }
+    }
+}
+
+bool Collision::AABBTree::has(Geometry::GeometryObject *object) const
+{
+    return _indexs.find(object) != _indexs.end();
+}
+
+void Collision::AABBTree::clear()
+{
+    _nodes.clear();
+    _free_nodes.clear();
+    _root = Collision::AABBTree::NULL_NODE;
+    _objects.clear();
+    _rects.clear();
+    _leaves.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+}
+
+double Collision::AABBTree::margin() const
+{
+    return _margin;
+}
+
+void Collision::AABBTree::set_margin(const double value)
+{
+    _margin = std::max(value, 0.0);
+}
+
+int Collision::AABBTree::height() const
+{
+    return _root == Collision::AABBTree::NULL_NODE ? 0 : _nodes[_root].height + 1;
+}
+
+bool Collision::AABBTree::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    Collision::AABBTree::Bounds bounds;
+    bounds.left = bounds.right = pos.x;
+    bounds.top = bounds.bottom = pos.y;
+    std::vector<size_t> indexs, nodes;
+    collect_candidates(bounds, indexs, nodes);
+
+    const size_t size = objects.size();
+    for (const size_t index : indexs)
+    {
+        if (Geometry::is_inside(pos, _rects[index], true)
+            && Geometry::NoAABBTest::is_intersected(_objects[index], &pos))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::AABBTree::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    std::vector<size_t> indexs, nodes;
+    collect_candidates(to_bounds(rect), indexs, nodes);
+
+    const size_t size = objects.size();
+    for (const size_t index : indexs)
+    {
+        if (Geometry::is_intersected(rect, _rects[index])
+            && Geometry::NoAABBTest::is_intersected(rect, _objects[index]))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+const Collision::CollisionLayer &Collision::AABBTree::layer(const Geometry::GeometryObject *object) const
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(const_cast<Geometry::GeometryObject *>(object));
+    return it == _indexs.end() ? Collision::CollisionFilter::default_layer() : _filter.layer(it->second);
+}
+
+void Collision::AABBTree::set_layer(Geometry::GeometryObject *object, const Collision::CollisionLayer &layer)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        _filter.set_layer(it->second, layer);
+    }
+}
+
+bool Collision::AABBTree::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool /*norepeat*/) const
+{
+    if (object == nullptr)
+    {
+        return false;
+    }
+
+    const Geometry::AABBRect rect(object->bounding_rect());
+    std::vector<size_t> indexs, nodes;
+    collect_candidates(to_bounds(rect), indexs, nodes);
+
+    const size_t size = objects.size();
+    const Collision::CollisionLayer &layer = this->layer(object);
+    for (const size_t index : indexs)
+    {
+        const Geometry::GeometryObject *current_object = _objects[index];
+        if (current_object != object && Geometry::is_intersected(rect, _rects[index])
+            && _filter.accepts(layer, index) && Collision::gjk(current_object, object))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::AABBTree::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    const bool /*norepeat*/, const bool narrow) const
+{
+    const size_t size = pairs.size();
+    std::vector<size_t> indexs, nodes;
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] == nullptr)
+        {
+            continue;
+        }
+
+        // 每对对象只由下标较小的一方报告
+        indexs.clear();
+        collect_candidates(to_bounds(_rects[i]), indexs, nodes);
+        for (const size_t index : indexs)
+        {
+            if (index <= i || !Geometry::is_intersected(_rects[i], _rects[index]) || !_filter.accepts(i, index))
+            {
+                continue;
+            }
+            const Geometry::GeometryObject *object0 = _objects[i], *object1 = _objects[index];
+            if (!narrow || Collision::gjk(object0, object1))
+            {
+                pairs.emplace_back(_objects[i], _objects[index]);
+            }
+        }
+    }
+    return pairs.size() > size;
+}
+
+bool Collision::AABBTree::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+{
+    return find_collision_pairs(pairs, norepeat, true);
+}
+
+bool Collision::AABBTree::find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
+{
+    return find_collision_pairs(pairs, true, false);
+}
+
+bool Collision::AABBTree::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, Collision::RaycastHit &hit) const
+{
+    hit = Collision::RaycastHit();
+    hit.t = max_t;
+    double enter, exit;
+    if (_root == Collision::AABBTree::NULL_NODE || !Collision::raycast(origin, dir, max_t, _nodes[_root].bounds.left,
+        _nodes[_root].bounds.top, _nodes[_root].bounds.right, _nodes[_root].bounds.bottom, enter, exit))
+    {
+        return false;
+    }
+
+    // 以进入位置为键的最小堆
+    std::vector<std::pair<double, size_t>> nodes({{enter, _root}});
+    Collision::RaycastHit current;
+    while (!nodes.empty())
+    {
+        std::pop_heap(nodes.begin(), nodes.end(), std::greater<std::pair<double, size_t>>());
+        const std::pair<double, size_t> item = nodes.back();
+        nodes.pop_back();
+        if (hit.object != nullptr && item.first >= hit.t)
+        {
+            break;
+        }
+
+        const Collision::AABBTree::Node &node = _nodes[item.second];
+        if (node.is_leaf())
+        {
+            const Geometry::AABBRect &rect = _rects[node.object];
+            if (Collision::raycast(origin, dir, hit.t, rect.left(), rect.top(), rect.right(), rect.bottom(), enter, exit)
+                && Collision::raycast(_objects[node.object], origin, dir, hit.t, current) && (hit.object == nullptr || current.t < hit.t))
+            {
+                hit = current;
+            }
+            continue;
+        }
+        for (const size_t child : node.children)
+        {
+            const Collision::AABBTree::Bounds &bounds = _nodes[child].bounds;
+            if (Collision::raycast(origin, dir, hit.t, bounds.left, bounds.top, bounds.right, bounds.bottom, enter, exit))
+            {
+                nodes.emplace_back(enter, child);
+                std::push_heap(nodes.begin(), nodes.end(), std::greater<std::pair<double, size_t>>());
+            }
+        }
+    }
+    return hit.object != nullptr;
+}
+
+bool Collision::AABBTree::raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    std::vector<Collision::RaycastHit> &hits) const
+{
+    const size_t size = hits.size();
+    if (_root == Collision::AABBTree::NULL_NODE)
+    {
+        return false;
+    }
+
+    double enter, exit;
+    Collision::RaycastHit hit;
+    std::vector<size_t> nodes({_root});
+    while (!nodes.empty())
+    {
+        const Collision::AABBTree::Node &node = _nodes[nodes.back()];
+        nodes.pop_back();
+        if (!Collision::raycast(origin, dir, max_t, node.bounds.left, node.bounds.top, node.bounds.right, node.bounds.bottom, enter, exit))
+        {
+            continue;
+        }
+        if (node.is_leaf())
+        {
+            if (Collision::raycast(_objects[node.object], origin, dir, max_t, hit))
+            {
+                hits.push_back(hit);
+            }
+        }
+        else
+        {
+            nodes.push_back(node.children[0]);
+            nodes.push_back(node.children[1]);
+        }
+    }
+    Collision::sort_raycast_hits(hits, size);
+    return hits.size() > size;
+}
\ No newline at end of file
@@ -1,45 +1,87 @@
+#include <array>
+#include <utility>
+#include <type_traits>
 #include "Math/Collision/Algorithm.hpp"
 #include "Math/Geometry/Algorithm.hpp"
 
 
 using namespace ToyGameEngine::Math;
 
+// 投影只用于比较大小,用点积代替垂足,投影相同时取下标较小的点
+// 没有上次的支撑点可以开始爬山,逐点比较,不必判断凸性
 void Collision::gjk_furthest_point(const Geometry::Polygon &polygon, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result)
 {
-    result = polygon.front();
-    Geometry::Point point;
-    Geometry::foot_point(start, end, polygon.front(), point, true);
+    Collision::gjk_furthest_point(polygon, start, end, result, 0, false);
+}
+
+size_t Collision::gjk_furthest_point(const Geometry::Polygon &polygon, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result,
+    const size_t index, const bool convex)
+{
     const Geometry::Vector vec = end - start;
-    double value, max_value = vec * (point - start);
-    for (size_t i = 1, count = polygon.size() - 1; i < count; ++i)
+    const size_t count = polygon.size() - 1;
+    if (!convex)
     {
-        Geometry::foot_point(start, end, polygon[i], point, true);
-        value = vec * (point - start);
-        if (value > max_value)
+        size_t current = 0;
+        double value = vec * polygon.front();
+        for (size_t i = 1; i < count; ++i)
         {
-            max_value = value;
-            result = polygon[i];
+            const double temp = vec * polygon[i];
+            if (temp > value)
+            {
+                value = temp;
+                current = i;
+            }
         }
+        result = polygon[current];
+        return current;
+    }
+
+    // 凸多边形的投影沿边界先增后减,先确定移动方向,再移动到两侧都不更大的点
+    size_t current = index < count ? index : 0;
+    double value = vec * polygon[current];
+    size_t next = current + 1 == count ? 0 : current + 1;
+    double next_value = vec * polygon[next];
+    if (next_value > value)
+    {
+        do
+        {
+            current = next;
+            value = next_value;
+            next = current + 1 == count ? 0 : current + 1;
+            next_value = vec * polygon[next];
+        } while (next_value > value);
     }
+    else
+    {
+        next = current == 0 ? count - 1 : current - 1;
+        next_value = vec * polygon[next];
+        while (next_value > value)
+        {
+            current = next;
+            value = next_value;
+            next = current == 0 ? count - 1 : current - 1;
+            next_value = vec * polygon[next];
+        }
+    }
+    result = polygon[current];
+    return current;
 }
 
 void Collision::gjk_furthest_point(const Geometry::Polyline &polyline, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result)
 {
-    result = polyline.front();
-    Geometry::Point point;
-    Geometry::foot_point(start, end, polyline.front(), point, true);
     const Geometry::Vector vec = end - start;
-    double value, max_value = vec * (point - start);
-    for (size_t i = 1, count = polyline.size() - 1; i < count; ++i)
+    size_t index = 0;
+    double value, max_value = vec * polyline.front();
+    for (size_t i = 1, count = polyline.size(); i < count; ++i)
     {
-        Geometry::foot_point(start, end, polyline[i], point, true);
-        value = vec * (point - start);
+        value = vec * polyline[i];
         if (value > max_value)
         {
             max_value = value;
-            result = polyline[i];
+            index = i;
         }
     }
+    result = polyline[index];
 }
 
 void Collision::gjk_furthest_point(const Geometry::Bezier &bezier, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result)
@@ -112,6 +154,63 @@ void Collision::gjk_furthest_point(const Geometry::Point &point, const Geometry:
     result = point;
 }
 
+void Collision::gjk_furthest_point(const Geometry::GeometryObject *object, const Geometry::Point &start, const Geometry::Point &end, Geometry::Point &result)
+{
+    switch (object->type())
+    {
+    case Geometry::Type::POLYGON:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Polygon *>(object), start, end, result);
+    case Geometry::Type::RECTANGLE:
+    case Geometry::Type::SQUARE:
+    case Geometry::Type::AABBRECT:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Rectangle *>(object), start, end, result);
+    case Geometry::Type::TRIANGLE:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Triangle *>(object), start, end, result);
+    case Geometry::Type::CIRCLE:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Circle *>(object), start, end, result);
+    case Geometry::Type::POLYLINE:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Polyline *>(object), start, end, result);
+    case Geometry::Type::BEZIER:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Bezier *>(object), start, end, result);
+    case Geometry::Type::LINE:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Line *>(object), start, end, result);
+    case Geometry::Type::POINT:
+        return Collision::gjk_furthest_point(*static_cast<const Geometry::Point *>(object), start, end, result);
+    default:
+        result = object->average_point();
+        break;
+    }
+}
+
+
+Geometry::Point Collision::closest_to_origin(const Geometry::Point &start, const Geometry::Point &end)
+{
+    const Geometry::Vector edge = end - start;
+    const double length = edge * edge;
+    if (length == 0)
+    {
+        return start;
+    }
+    const double t = -(start * edge) / length;
+    if (t <= 0)
+    {
+        return start;
+    }
+    else if (t >= 1)
+    {
+        return end;
+    }
+    else
+    {
+        return start + edge * t;
+    }
+}
+
+void Collision::GJKCache::clear()
+{
+    separated = false;
+    valid = false;
+}
 
 Geometry::Vector Collision::edge_direciton(const Geometry::Point &start, const Geometry::Point &end, const bool to_origin)
 {
@@ -165,7 +264,8 @@ bool Collision::gjk(const Geometry::Circle &circle, const Geometry::Polygon &pol
             return true;
         }
     }
-    return false;
+    // 圆与各边都不相交时只可能整个在多边形内
+    return Geometry::is_inside(circle, polygon, true);
 }
 
 bool Collision::gjk(const Geometry::Circle &circle, const Geometry::Rectangle &rectangle)
@@ -178,7 +278,7 @@ bool Collision::gjk(const Geometry::Circle &circle, const Geometry::Rectangle &r
             return true;
         }
     }
-    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length;
+    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length || Geometry::is_inside(circle, rectangle, true);
 }
 
 bool Collision::gjk(const Geometry::Circle &circle, const Geometry::AABBRect &rectangle)
@@ -191,7 +291,7 @@ bool Collision::gjk(const Geometry::Circle &circle, const Geometry::AABBRect &re
             return true;
         }
     }
-    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length;
+    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length || Geometry::is_inside(circle, rectangle, true);
 }
 
 bool Collision::gjk(const Geometry::Circle &circle, const Geometry::Square &square)
@@ -204,14 +304,16 @@ bool Collision::gjk(const Geometry::Circle &circle, const Geometry::Square &squa
             return true;
         }
     }
-    return Geometry::distance_square(circle, square[0], square[3]) <= length;
+    return Geometry::distance_square(circle, square[0], square[3]) <= length || Geometry::is_inside(circle, square, true);
 }
 
 bool Collision::gjk(const Geometry::Circle &circle, const Geometry::Triangle &triangle)
 {
-    return Geometry::distance_square(circle, triangle[0], triangle[1]) ||
-        Geometry::distance_square(circle, triangle[1], triangle[2]) ||
-        Geometry::distance_square(circle, triangle[0], triangle[2]);
+    const double length = circle.radius * circle.radius;
+    return Geometry::distance_square(circle, triangle[0], triangle[1]) <= length
+        || Geometry::distance_square(circle, triangle[1], triangle[2]) <= length
+        || Geometry::distance_square(circle, triangle[0], triangle[2]) <= length
+        || Geometry::is_inside(circle, triangle, true);
 }
 
 bool Collision::gjk(const Geometry::Polygon &polygon, const Geometry::Circle &circle)
@@ -224,7 +326,8 @@ bool Collision::gjk(const Geometry::Polygon &polygon, const Geometry::Circle &ci
             return true;
         }
     }
-    return false;
+    // 圆与各边都不相交时只可能整个在多边形内
+    return Geometry::is_inside(circle, polygon, true);
 }
 
 bool Collision::gjk(const Geometry::Rectangle &rectangle, const Geometry::Circle &circle)
@@ -237,7 +340,7 @@ bool Collision::gjk(const Geometry::Rectangle &rectangle, const Geometry::Circle
             return true;
         }
     }
-    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length;
+    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length || Geometry::is_inside(circle, rectangle, true);
 }
 
 bool Collision::gjk(const Geometry::AABBRect &rectangle, const Geometry::Circle &circle)
@@ -250,7 +353,7 @@ bool Collision::gjk(const Geometry::AABBRect &rectangle, const Geometry::Circle
             return true;
         }
     }
-    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length;
+    return Geometry::distance_square(circle, rectangle[0], rectangle[3]) <= length || Geometry::is_inside(circle, rectangle, true);
 }
 
 bool Collision::gjk(const Geometry::Square &square, const Geometry::Circle &circle)
@@ -263,287 +366,692 @@ bool Collision::gjk(const Geometry::Square &square, const Geometry::Circle &circ
             return true;
         }
     }
-    return Geometry::distance_square(circle, square[0], square[3]) <= length;
+    return Geometry::distance_square(circle, square[0], square[3]) <= length || Geometry::is_inside(circle, square, true);
 }
 
 bool Collision::gjk(const Geometry::Triangle &triangle, const Geometry::Circle &circle)
 {
-    return Geometry::distance_square(circle, triangle[0], triangle[1]) ||
-        Geometry::distance_square(circle, triangle[1], triangle[2]) ||
-        Geometry::distance_square(circle, triangle[0], triangle[2]);
+    const double length = circle.radius * circle.radius;
+    return Geometry::distance_square(circle, triangle[0], triangle[1]) <= length
+        || Geometry::distance_square(circle, triangle[1], triangle[2]) <= length
+        || Geometry::distance_square(circle, triangle[0], triangle[2]) <= length
+        || Geometry::is_inside(circle, triangle, true);
 }
 
-bool Collision::gjk(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1)
+// 各类型对应的对象类型,不参与碰撞检测的类型为void
+template <Geometry::Type T>
+struct ObjectOf
+{
+    typedef void type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::POINT>
+{
+    typedef Geometry::Point type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::POLYLINE>
+{
+    typedef Geometry::Polyline type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::AABBRECT>
+{
+    typedef Geometry::AABBRect type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::POLYGON>
+{
+    typedef Geometry::Polygon type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::TRIANGLE>
+{
+    typedef Geometry::Triangle type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::SQUARE>
+{
+    typedef Geometry::Square type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::RECTANGLE>
+{
+    typedef Geometry::Rectangle type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::CIRCLE>
+{
+    typedef Geometry::Circle type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::LINE>
+{
+    typedef Geometry::Line type;
+};
+
+template <>
+struct ObjectOf<Geometry::Type::BEZIER>
+{
+    typedef Geometry::Bezier type;
+};
+
+// GJK与EPA中矩形、正方形与AABB矩形都按矩形处理
+template <Geometry::Type T>
+struct KernelOf
+{
+    typedef typename ObjectOf<T>::type type;
+};
+
+template <>
+struct KernelOf<Geometry::Type::AABBRECT>
+{
+    typedef Geometry::Rectangle type;
+};
+
+template <>
+struct KernelOf<Geometry::Type::SQUARE>
+{
+    typedef Geometry::Rectangle type;
+};
+
+template <Geometry::Type T>
+static const typename ObjectOf<T>::type &object_cast(const Geometry::GeometryObject *object)
 {
-    switch (points0->type())
+    return *static_cast<const typename ObjectOf<T>::type *>(object);
+}
+
+template <Geometry::Type T>
+static const typename KernelOf<T>::type &kernel_cast(const Geometry::GeometryObject *object)
+{
+    return *static_cast<const typename KernelOf<T>::type *>(object);
+}
+
+// 两个类型都有GJK与EPA的实现,点只参与GJK检测
+template <Geometry::Type L, Geometry::Type R>
+static constexpr bool has_kernel()
+{
+    return !std::is_void<typename ObjectOf<L>::type>::value && !std::is_void<typename ObjectOf<R>::type>::value
+        && L != Geometry::Type::POINT && R != Geometry::Type::POINT;
+}
+
+// 点与对象的GJK检测即点是否在对象内,封闭图形包括边界
+template <typename T>
+static bool contains(const T &shape, const Geometry::Point &point)
+{
+    return Geometry::is_inside(point, shape, true);
+}
+
+static bool contains(const Geometry::Polyline &polyline, const Geometry::Point &point)
+{
+    return Geometry::is_inside(point, polyline);
+}
+
+static bool contains(const Geometry::Bezier &bezier, const Geometry::Point &point)
+{
+    return Geometry::is_inside(point, bezier.shape());
+}
+
+static bool contains(const Geometry::Line &line, const Geometry::Point &point)
+{
+    return Geometry::is_inside(point, line);
+}
+
+static bool contains(const Geometry::Point &point0, const Geometry::Point &point1)
+{
+    return point0 == point1;
+}
+
+template <Geometry::Type L, Geometry::Type R>
+struct GJKKernel
+{
+    static bool run(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1)
     {
-    case Geometry::Type::POLYGON:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::gjk(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1));
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::gjk(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1));
-        case Geometry::Type::TRIANGLE:
-            return Collision::gjk(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1));
-        case Geometry::Type::CIRCLE:
-            return Collision::gjk(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Circle *>(points1));
-        case Geometry::Type::POLYLINE:
-            return Collision::gjk(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Collision::gjk(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1));
-        case Geometry::Type::LINE:
-            return Collision::gjk(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points1),
-                *static_cast<const Geometry::Polygon *>(points0), true);
-        default:
+        if constexpr (std::is_void<typename ObjectOf<L>::type>::value || std::is_void<typename ObjectOf<R>::type>::value)
+        {
             return false;
         }
-    case Geometry::Type::RECTANGLE:
-    case Geometry::Type::SQUARE:
-    case Geometry::Type::AABBRECT:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::gjk(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1));
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::gjk(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1));
-        case Geometry::Type::TRIANGLE:
-            return Collision::gjk(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1));
-        case Geometry::Type::CIRCLE:
-            return Collision::gjk(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1));
-        case Geometry::Type::POLYLINE:
-            return Collision::gjk(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Collision::gjk(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1));
-        case Geometry::Type::LINE:
-            return Collision::gjk(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points1),
-                *static_cast<const Geometry::Rectangle *>(points0), true);
-        default:
-            return false;
+        else if constexpr (R == Geometry::Type::POINT)
+        {
+            return contains(object_cast<L>(points0), object_cast<R>(points1));
         }
-    case Geometry::Type::TRIANGLE:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::gjk(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1));
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::gjk(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1));
-        case Geometry::Type::TRIANGLE:
-            return Collision::gjk(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1));
-        case Geometry::Type::CIRCLE:
-            return Collision::gjk(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1));
-        case Geometry::Type::POLYLINE:
-            return Collision::gjk(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Collision::gjk(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1));
-        case Geometry::Type::LINE:
-            return Collision::gjk(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points1),
-                *static_cast<const Geometry::Triangle *>(points0), true);
-        default:
-            return false;
+        else if constexpr (L == Geometry::Type::POINT)
+        {
+            return contains(object_cast<R>(points1), object_cast<L>(points0));
         }
-    case Geometry::Type::CIRCLE:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::gjk(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1));
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::gjk(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1));
-        case Geometry::Type::TRIANGLE:
-            return Collision::gjk(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1));
-        case Geometry::Type::CIRCLE:
-            return Collision::gjk(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1));
-        case Geometry::Type::POLYLINE:
-            return Collision::gjk(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Collision::gjk(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1));
-        case Geometry::Type::LINE:
-            return Collision::gjk(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points1),
-                *static_cast<const Geometry::Circle *>(points0), true);
-        default:
-            return false;
+        else if constexpr (L > R)
+        {
+            // GJK检测与参数顺序无关,交换参数使每对类型只实例化一次,且检测结果对称
+            return GJKKernel<R, L>::run(points1, points0);
         }
-    case Geometry::Type::POLYLINE:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::gjk(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1));
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::gjk(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1));
-        case Geometry::Type::TRIANGLE:
-            return Collision::gjk(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1));
-        case Geometry::Type::CIRCLE:
-            return Collision::gjk(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Circle *>(points1));
-        case Geometry::Type::POLYLINE:
-            return Collision::gjk(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Collision::gjk(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1));
-        case Geometry::Type::LINE:
-            return Collision::gjk(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points1),
-                *static_cast<const Geometry::Polyline *>(points0));
-        default:
-            return false;
+        else
+        {
+            return Collision::gjk(kernel_cast<L>(points0), kernel_cast<R>(points1));
         }
-    case Geometry::Type::BEZIER:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::gjk(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1));
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::gjk(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1));
-        case Geometry::Type::TRIANGLE:
-            return Collision::gjk(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1));
-        case Geometry::Type::CIRCLE:
-            return Collision::gjk(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Circle *>(points1));
-        case Geometry::Type::POLYLINE:
-            return Collision::gjk(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Collision::gjk(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1));
-        case Geometry::Type::LINE:
-            return Collision::gjk(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points1),
-                static_cast<const Geometry::Bezier *>(points0)->shape());
-        default:
-            return false;
+    }
+};
+
+// EPA的结果与参数顺序有关,不交换参数
+template <Geometry::Type L, Geometry::Type R>
+struct EPAKernel
+{
+    static double run(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Vector &vec)
+    {
+        if constexpr (has_kernel<L, R>())
+        {
+            return Collision::epa(kernel_cast<L>(points0), kernel_cast<R>(points1), vec);
         }
-    case Geometry::Type::LINE:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::gjk(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1));
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::gjk(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1));
-        case Geometry::Type::TRIANGLE:
-            return Collision::gjk(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1));
-        case Geometry::Type::CIRCLE:
-            return Collision::gjk(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Circle *>(points1));
-        case Geometry::Type::POLYLINE:
-            return Collision::gjk(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Collision::gjk(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1));
-        case Geometry::Type::LINE:
-            return Collision::gjk(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points1),
-                *static_cast<const Geometry::Line *>(points0));
-        default:
-            return false;
+        else
+        {
+            return -1;
         }
-    case Geometry::Type::POINT:
-        switch (points1->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), true);
-        case Geometry::Type::RECTANGLE:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), true);
-        case Geometry::Type::SQUARE:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::Square *>(points1), true);
-        case Geometry::Type::AABBRECT:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::AABBRect *>(points1), true);
-        case Geometry::Type::TRIANGLE:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), true);
-        case Geometry::Type::CIRCLE:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), true);
-        case Geometry::Type::POLYLINE:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1));
-        case Geometry::Type::BEZIER:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                static_cast<const Geometry::Bezier *>(points1)->shape());
-        case Geometry::Type::LINE:
-            return Geometry::is_inside(*static_cast<const Geometry::Point *>(points0),
-                *static_cast<const Geometry::Line *>(points1));
-        case Geometry::Type::POINT:
-            return *static_cast<const Geometry::Point *>(points0) ==
-                *static_cast<const Geometry::Point *>(points1);
-        default:
+    }
+};
+
+// 圆与封闭图形的GJK与EPA有专门的实现
+static constexpr bool is_closed_shape(const Geometry::Type type)
+{
+    return type == Geometry::Type::POLYGON || type == Geometry::Type::AABBRECT || type == Geometry::Type::TRIANGLE
+        || type == Geometry::Type::SQUARE || type == Geometry::Type::RECTANGLE || type == Geometry::Type::CIRCLE;
+}
+
+template <Geometry::Type L, Geometry::Type R>
+static constexpr bool has_circle_kernel()
+{
+    return (L == Geometry::Type::CIRCLE && is_closed_shape(R)) || (R == Geometry::Type::CIRCLE && is_closed_shape(L));
+}
+
+// 只有迭代的GJK使用cache,交换参数的规则与GJKKernel相同,保证同一对对象的cache总在同一顺序下使用
+template <Geometry::Type L, Geometry::Type R>
+struct GJKCacheKernel
+{
+    static bool run(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Collision::GJKCache &cache)
+    {
+        if constexpr (!has_kernel<L, R>() || has_circle_kernel<L, R>())
+        {
+            return GJKKernel<L, R>::run(points0, points1);
+        }
+        else if constexpr (L > R)
+        {
+            return GJKCacheKernel<R, L>::run(points1, points0, cache);
+        }
+        else
+        {
+            return Collision::gjk(kernel_cast<L>(points0), kernel_cast<R>(points1), cache);
+        }
+    }
+};
+
+template <Geometry::Type L, Geometry::Type R>
+struct EPACacheKernel
+{
+    static double run(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Vector &vec, Collision::GJKCache &cache)
+    {
+        if constexpr (!has_kernel<L, R>() || has_circle_kernel<L, R>())
+        {
+            return EPAKernel<L, R>::run(points0, points1, vec);
+        }
+        else if constexpr (L > R)
+        {
+            // cache由GJKCacheKernel按交换后的顺序写入,交换参数后Minkowski差取反,穿透向量随之取反
+            const double depth = EPACacheKernel<R, L>::run(points1, points0, vec, cache);
+            vec.x = -vec.x;
+            vec.y = -vec.y;
+            return depth;
+        }
+        else
+        {
+            return Collision::epa(kernel_cast<L>(points0), kernel_cast<R>(points1), vec, cache);
+        }
+    }
+};
+
+template <Geometry::Type L, Geometry::Type R>
+struct EPAPointsKernel
+{
+    static double run(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Point &head, Geometry::Point &tail)
+    {
+        if constexpr (has_kernel<L, R>())
+        {
+            return Collision::epa(kernel_cast<L>(points0), kernel_cast<R>(points1), head, tail);
+        }
+        else
+        {
+            return -1;
+        }
+    }
+};
+
+template <Geometry::Type L, Geometry::Type R>
+struct EPADirectionKernel
+{
+    static double run(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, const double tx, const double ty, Geometry::Vector &vec)
+    {
+        if constexpr (has_kernel<L, R>())
+        {
+            return Collision::epa(kernel_cast<L>(points0), kernel_cast<R>(points1), tx, ty, vec);
+        }
+        else
+        {
+            return -1;
+        }
+    }
+};
+
+static constexpr size_t TYPE_COUNT = Geometry::Type::BEZIER + 1;
+
+// 以type0 * TYPE_COUNT + type1为下标的函数表,编译时由Kernel<type0, type1>::run填充
+template <template <Geometry::Type, Geometry::Type> class Kernel, size_t... I>
+static constexpr std::array<decltype(&Kernel<Geometry::Type::GEOMETRY_OBJECT, Geometry::Type::GEOMETRY_OBJECT>::run), sizeof...(I)>
+    make_dispatch_table(std::index_sequence<I...>)
+{
+    return {{&Kernel<static_cast<Geometry::Type>(I / TYPE_COUNT), static_cast<Geometry::Type>(I % TYPE_COUNT)>::run...}};
+}
+
+static constexpr auto GJK_TABLE = make_dispatch_table<GJKKernel>(std::make_index_sequence<TYPE_COUNT * TYPE_COUNT>());
+static constexpr auto EPA_TABLE = make_dispatch_table<EPAKernel>(std::make_index_sequence<TYPE_COUNT * TYPE_COUNT>());
+static constexpr auto EPA_POINTS_TABLE = make_dispatch_table<EPAPointsKernel>(std::make_index_sequence<TYPE_COUNT * TYPE_COUNT>());
+static constexpr auto EPA_DIRECTION_TABLE = make_dispatch_table<EPADirectionKernel>(std::make_index_sequence<TYPE_COUNT * TYPE_COUNT>());
+static constexpr auto GJK_CACHE_TABLE = make_dispatch_table<GJKCacheKernel>(std::make_index_sequence<TYPE_COUNT * TYPE_COUNT>());
+static constexpr auto EPA_CACHE_TABLE = make_dispatch_table<EPACacheKernel>(std::make_index_sequence<TYPE_COUNT * TYPE_COUNT>());
+
+bool Collision::gjk(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1)
+{
+    return GJK_TABLE[points0->type() * TYPE_COUNT + points1->type()](points0, points1);
+}
+
+bool Collision::gjk(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Collision::GJKCache &cache)
+{
+    return GJK_CACHE_TABLE[points0->type() * TYPE_COUNT + points1->type()](points0, points1, cache);
+}
+
+namespace
+{
+    // 迭代次数上限,正常情况下二维的GJK在少数几次迭代内收敛
+    const size_t GJK_MAX_ITERATIONS = 64;
+    // |v|^2与v·w之差小于|v|^2的该倍数时认为已收敛
+    const double GJK_RELATIVE_TOLERANCE = Geometry::EPSILON * 1e-2;
+    // 收敛判断的绝对容差,避免|v|接近0时相对容差失效
+    const double GJK_ABSOLUTE_TOLERANCE = GJK_RELATIVE_TOLERANCE * GJK_RELATIVE_TOLERANCE;
+    // |v|^2小于参考长度平方的该倍数时认为v已退化为0
+    const double GJK_ZERO_TOLERANCE = Geometry::EPSILON * Geometry::EPSILON;
+    // 接触判断中重心坐标权重与边界距离的容差
+    const double GJK_CONTACT_TOLERANCE = Geometry::EPSILON * 10;
+
+    // GJK射线投射的单纯形,points为Minkowski差object1 - object0上的点,contacts为对应的object1上的点
+    struct CastSimplex
+    {
+        Geometry::Point points[3];
+        Geometry::Point contacts[3];
+        double weights[3] = {0, 0, 0};
+        size_t count = 0;
+
+        void keep(const size_t index0, const size_t index1, const double weight0, const double weight1)
+        {
+            const Geometry::Point point0 = points[index0], point1 = points[index1], contact0 = contacts[index0], contact1 = contacts[index1];
+            points[0] = point0;
+            points[1] = point1;
+            contacts[0] = contact0;
+            contacts[1] = contact1;
+            weights[0] = weight0;
+            weights[1] = weight1;
+            count = 2;
+        }
+
+        void keep(const size_t index)
+        {
+            points[0] = points[index];
+            contacts[0] = contacts[index];
+            weights[0] = 1;
+            count = 1;
+        }
+    };
+
+    // 线段x - points[index0]到x - points[index1]上距离原点最近的点
+    Geometry::Vector closest_on_segment(const CastSimplex &simplex, const Geometry::Point &x, const size_t index0, const size_t index1, double &weight)
+    {
+        const Geometry::Vector a = x - simplex.points[index0], edge = simplex.points[index0] - simplex.points[index1];
+        const double length = edge * edge;
+        weight = length > 0 ? std::clamp(-(a * edge) / length, 0.0, 1.0) : 0;
+        return a + edge * weight;
+    }
+
+    // 将单纯形缩减为x - points中距离原点最近的点所在的最小子集,返回该点
+    Geometry::Vector reduce_simplex(CastSimplex &simplex, const Geometry::Point &x)
+    {
+        double weight;
+        if (simplex.count == 1)
+        {
+            simplex.weights[0] = 1;
+            return x - simplex.points[0];
+        }
+        if (simplex.count == 2)
+        {
+            const Geometry::Vector result = closest_on_segment(simplex, x, 0, 1, weight);
+            if (weight <= 0)
+            {
+                simplex.keep(0);
+            }
+            else if (weight >= 1)
+            {
+                simplex.keep(1);
+            }
+            else
+            {
+                simplex.weights[0] = 1 - weight;
+                simplex.weights[1] = weight;
+            }
+            return result;
+        }
+
+        const Geometry::Point a = x - simplex.points[0], b = x - simplex.points[1], c = x - simplex.points[2];
+        const double area = (b - a).cross(c - a);
+        if (area != 0)
+        {
+            const double u = b.cross(c) / area, v = c.cross(a) / area, w = a.cross(b) / area;
+            if (u >= 0 && v >= 0 && w >= 0)
+            {
+                simplex.weights[0] = u;
+                simplex.weights[1] = v;
+                simplex.weights[2] = w;
+                return Geometry::Vector(0, 0);
+            }
+        }
+
+        // 原点在三角形外时取最近的边
+        const size_t edges[3][2] = {{0, 1}, {1, 2}, {2, 0}};
+        Geometry::Vector result, current;
+        double min_length = DBL_MAX, min_weight = 0;
+        size_t min_edge = 0;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            current = closest_on_segment(simplex, x, edges[i][0], edges[i][1], weight);
+            if (current * current < min_length)
+            {
+                min_length = current * current;
+                min_weight = weight;
+                min_edge = i;
+                result = current;
+            }
+        }
+        if (min_weight <= 0)
+        {
+            simplex.keep(edges[min_edge][0]);
+        }
+        else if (min_weight >= 1)
+        {
+            simplex.keep(edges[min_edge][1]);
+        }
+        else
+        {
+            simplex.keep(edges[min_edge][0], edges[min_edge][1], 1 - min_weight, min_weight);
+        }
+        return result;
+    }
+}
+
+bool Collision::shape_cast(const Geometry::GeometryObject *object0, const Geometry::GeometryObject *object1, const double tx, const double ty,
+    double &t, Geometry::Point &point, Geometry::Vector &normal)
+{
+    const Geometry::Point origin(0, 0);
+    const Geometry::Vector ray(tx, ty);
+    Geometry::Point x, point0, point1;
+    Geometry::Vector v, w, n;
+    CastSimplex simplex;
+    double lambda = 0;
+
+    // object0平移lambda * ray后与object1接触等价于lambda * ray位于object1 - object0中
+    const Geometry::Vector dir = ray.empty() ? Geometry::Vector(1, 0) : ray;
+    Collision::gjk_furthest_point(object0, origin, dir, point0);
+    Collision::gjk_furthest_point(object1, dir, origin, point1);
+    // 初始方向可任取,两个支撑点重合时改用-dir
+    v = x - (point1 - point0);
+    if (v.empty())
+    {
+        v = dir * -1;
+    }
+    bool overlapped = false;
+    for (size_t i = 0; i < GJK_MAX_ITERATIONS; ++i)
+    {
+        // 支撑点在Minkowski差上沿v方向最远
+        Collision::gjk_furthest_point(object0, v, origin, point0);
+        Collision::gjk_furthest_point(object1, origin, v, point1);
+        const Geometry::Point p = point1 - point0;
+        w = x - p;
+        bool advanced = false;
+        if (v * w > 0)
+        {
+            if (v * ray >= 0)
+            {
+                return false;
+            }
+            lambda -= (v * w) / (v * ray);
+            if (lambda > 1)
+            {
+                return false;
+            }
+            x = ray * lambda;
+            n = v;
+            advanced = true;
+        }
+        else if (v * v - v * w <= GJK_RELATIVE_TOLERANCE * (v * v) + GJK_ABSOLUTE_TOLERANCE)
+        {
+            // 已收敛,x与Minkowski差的距离不再减小
+            break;
+        }
+
+        // 支撑点已在单纯形中且x未前进时v已收敛到0
+        bool repeated = false;
+        for (size_t j = 0; j < simplex.count; ++j)
+        {
+            repeated = repeated || simplex.points[j] == p;
+        }
+        if (repeated && !advanced)
+        {
+            break;
+        }
+        if (!repeated)
+        {
+            simplex.points[simplex.count] = p;
+            simplex.contacts[simplex.count++] = point1;
+        }
+        v = reduce_simplex(simplex, x);
+        if (simplex.count == 3)
+        {
+            overlapped = true;
+            break;
+        }
+        if (v * v <= GJK_ZERO_TOLERANCE * std::max(x * x, p * p) || v.empty())
+        {
+            break;
+        }
+    }
+
+    if (lambda == 0 && overlapped)
+    {
+        // 原点位于单纯形的边上且该边位于Minkowski差的边界上时只是接触,取该边的外法向
+        const size_t index = std::min_element(simplex.weights, simplex.weights + 3) - simplex.weights;
+        const Geometry::Point &a = simplex.points[(index + 1) % 3], &b = simplex.points[(index + 2) % 3];
+        Geometry::Vector m = (b - a).vertical();
+        if (m * (simplex.points[index] - a) > 0)
+        {
+            m *= -1;
+        }
+        if (simplex.weights[index] <= GJK_CONTACT_TOLERANCE && !m.empty())
+        {
+            Collision::gjk_furthest_point(object0, m, origin, point0);
+            Collision::gjk_furthest_point(object1, origin, m, point1);
+            if (m * (point1 - point0 - a) <= GJK_CONTACT_TOLERANCE * m.length() * std::max(a.length(), 1.0))
+            {
+                overlapped = false;
+                v = m;
+            }
+        }
+    }
+    if (lambda == 0)
+    {
+        // 开始时接触,向外或沿切线移动时不算碰撞
+        if (!overlapped && !v.empty() && v * ray >= 0)
+        {
             return false;
         }
-    default:
-        return false;
+        n = overlapped || v.empty() ? ray * -1 : v;
+    }
+    t = lambda;
+    point.clear();
+    for (size_t i = 0; i < simplex.count; ++i)
+    {
+        point += simplex.contacts[i] * simplex.weights[i];
+    }
+    normal = n;
+    if (!normal.empty())
+    {
+        normal.normalize();
+    }
+    return true;
+}
+
+// 两圆的距离直接由圆心距离求得
+static double gjk_distance(const Geometry::Circle &circle0, const Geometry::Circle &circle1, Geometry::Point &point0, Geometry::Point &point1,
+    const double threshold)
+{
+    Geometry::Vector vec = circle1 - circle0;
+    const double length = vec.Geometry::Point::length(), distance = length - circle0.radius - circle1.radius;
+    if (distance > threshold)
+    {
+        return -1;
+    }
+    if (length > 0)
+    {
+        vec /= length;
+    }
+    else
+    {
+        vec.x = 1;
+        vec.y = 0;
+    }
+    point0 = circle0 + vec * circle0.radius;
+    point1 = circle1 - vec * circle1.radius;
+    if (distance <= 0)
+    {
+        // 相交时取两个圆上最近点的中点
+        point0 = point1 = (point0 + point1) / 2;
+        return 0;
+    }
+    return distance;
+}
+
+// 在Minkowski差points0 - points1上迭代求距离原点最近的点v,单纯形中保存points1 - points0上的点与points1上的点
+// 沿-v方向的支撑点给出距离的下界,v的长度为上界,两者足够接近时结束
+template <typename L, typename R>
+static double gjk_distance(const L &points0, const R &points1, Geometry::Point &point0, Geometry::Point &point1, const double threshold)
+{
+    Collision::SupportMapping<L> support0(points0);
+    Collision::SupportMapping<R> support1(points1);
+    const Geometry::Point origin(0, 0);
+    Geometry::Point p0, p1;
+    Geometry::Vector v(1, 0), w;
+    CastSimplex simplex;
+
+    // 初始方向可任取
+    support0(v, origin, p0);
+    support1(origin, v, p1);
+    simplex.points[0] = p1 - p0;
+    simplex.contacts[0] = p1;
+    simplex.weights[0] = 1;
+    simplex.count = 1;
+    v = p0 - p1;
+    for (size_t i = 0; i < GJK_MAX_ITERATIONS && !v.empty(); ++i)
+    {
+        support0(v, origin, p0);
+        support1(origin, v, p1);
+        w = p0 - p1;
+        const double vw = v * w;
+        if (vw > 0 && vw * vw > threshold * threshold * (v * v))
+        {
+            return -1;
+        }
+        if (v * v - vw <= GJK_RELATIVE_TOLERANCE * (v * v) + GJK_ABSOLUTE_TOLERANCE)
+        {
+            break;
+        }
+
+        // 支撑点已在单纯形中时v已收敛
+        bool repeated = false;
+        for (size_t j = 0; j < simplex.count; ++j)
+        {
+            repeated = repeated || simplex.points[j] == p1 - p0;
+        }
+        if (repeated)
+        {
+            break;
+        }
+        simplex.points[simplex.count] = p1 - p0;
+        simplex.contacts[simplex.count++] = p1;
+        v = reduce_simplex(simplex, origin);
+        if (simplex.count == 3)
+        {
+            // 原点在单纯形内,两者相交
+            v.clear();
+        }
+        else if (v * v <= GJK_ZERO_TOLERANCE * (w * w))
+        {
+            break;
+        }
+    }
+
+    const double distance = v.Geometry::Point::length();
+    if (distance > threshold)
+    {
+        return -1;
+    }
+    point1.clear();
+    for (size_t i = 0; i < simplex.count; ++i)
+    {
+        point1 += simplex.contacts[i] * simplex.weights[i];
     }
+    point0 = point1 + v;
+    return distance;
 }
 
+template <Geometry::Type L, Geometry::Type R>
+struct GJKDistanceKernel
+{
+    static double run(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Point &point0, Geometry::Point &point1,
+        const double threshold)
+    {
+        if constexpr (std::is_void<typename ObjectOf<L>::type>::value || std::is_void<typename ObjectOf<R>::type>::value)
+        {
+            return -1;
+        }
+        else if constexpr (L > R)
+        {
+            // 距离与参数顺序无关,交换参数使每对类型只实例化一次
+            return GJKDistanceKernel<R, L>::run(points1, points0, point1, point0, threshold);
+        }
+        else
+        {
+            return ::gjk_distance(kernel_cast<L>(points0), kernel_cast<R>(points1), point0, point1, threshold);
+        }
+    }
+};
+
+static constexpr auto GJK_DISTANCE_TABLE = make_dispatch_table<GJKDistanceKernel>(std::make_index_sequence<TYPE_COUNT * TYPE_COUNT>());
+
+double Collision::gjk_distance(const Geometry::GeometryObject *object0, const Geometry::GeometryObject *object1, Geometry::Point &point0,
+    Geometry::Point &point1, const double threshold)
+{
+    return GJK_DISTANCE_TABLE[object0->type() * TYPE_COUNT + object1->type()](object0, object1, point0, point1, threshold);
+}
 
 double Collision::epa(const Geometry::Circle &circle0, const Geometry::Circle &circle1, Geometry::Vector &vec)
 {
@@ -578,17 +1086,19 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Polygon &p
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    // 圆整个在图形内时与各边都不相交,仍需移出
+    const bool inside = Collision::is_point_inside(circle, polygon);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Collision::is_point_inside(circle, polygon))
+    if (inside)
     {
         if (Geometry::foot_point(polygon[index - 1], polygon[index], circle, vec, false))
         {
@@ -647,17 +1157,18 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Rectangle
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, vec, false))
         {
@@ -718,17 +1229,18 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::AABBRect &
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, vec, false))
         {
@@ -789,17 +1301,18 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Square &sq
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, square);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, square))
+    if (inside)
     {
         if (Geometry::foot_point(square[index > 0 ? index - 1 : 3], square[index], circle, vec, false))
         {
@@ -860,17 +1373,18 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Triangle &
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, triangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, triangle))
+    if (inside)
     {
         if (Geometry::foot_point(triangle[index > 0 ? index - 1 : 2], triangle[index], circle, vec, false))
         {
@@ -931,17 +1445,18 @@ double Collision::epa(const Geometry::Polygon &polygon, const Geometry::Circle &
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Collision::is_point_inside(circle, polygon);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Collision::is_point_inside(circle, polygon))
+    if (inside)
     {
         if (Geometry::foot_point(polygon[index - 1], polygon[index], circle, vec, false))
         {
@@ -1000,17 +1515,18 @@ double Collision::epa(const Geometry::Rectangle &rectangle, const Geometry::Circ
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, vec, false))
         {
@@ -1071,17 +1587,18 @@ double Collision::epa(const Geometry::AABBRect &rectangle, const Geometry::Circl
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, vec, false))
         {
@@ -1142,17 +1659,18 @@ double Collision::epa(const Geometry::Square &square, const Geometry::Circle &ci
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, square);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, square))
+    if (inside)
     {
         if (Geometry::foot_point(square[index > 0 ? index - 1 : 3], square[index], circle, vec, false))
         {
@@ -1213,17 +1731,18 @@ double Collision::epa(const Geometry::Triangle &triangle, const Geometry::Circle
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, triangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
     Geometry::Point point;
-    if (Geometry::is_inside(circle, triangle))
+    if (inside)
     {
         if (Geometry::foot_point(triangle[index > 0 ? index - 1 : 2], triangle[index], circle, vec, false))
         {
@@ -1272,216 +1791,12 @@ double Collision::epa(const Geometry::Triangle &triangle, const Geometry::Circle
 
 double Collision::epa(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Vector &vec)
 {
-    switch (points0->type())
-    {
-    case Geometry::Type::POLYGON:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Line *>(points1), vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::RECTANGLE:
-    case Geometry::Type::SQUARE:
-    case Geometry::Type::AABBRECT:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::TRIANGLE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::CIRCLE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::POLYLINE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Line *>(points1), vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::BEZIER:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Line *>(points1), vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::LINE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Line *>(points1), vec);
-        default:
-            return -1;
-        }
-    default:
-        return -1;
-    }
+    return EPA_TABLE[points0->type() * TYPE_COUNT + points1->type()](points0, points1, vec);
+}
+
+double Collision::epa(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Vector &vec, Collision::GJKCache &cache)
+{
+    return EPA_CACHE_TABLE[points0->type() * TYPE_COUNT + points1->type()](points0, points1, vec, cache);
 }
 
 
@@ -1519,16 +1834,17 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Polygon &p
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Collision::is_point_inside(circle, polygon);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Collision::is_point_inside(circle, polygon))
+    if (inside)
     {
         if (Geometry::foot_point(polygon[index - 1], polygon[index], circle, tail, false))
         {
@@ -1584,16 +1900,17 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Rectangle
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, tail, false))
         {
@@ -1651,16 +1968,17 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::AABBRect &
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, tail, false))
         {
@@ -1718,16 +2036,17 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Square &sq
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, square);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, square))
+    if (inside)
     {
         if (Geometry::foot_point(square[index > 0 ? index - 1 : 3], square[index], circle, tail, false))
         {
@@ -1785,16 +2104,17 @@ double Collision::epa(const Geometry::Circle &circle, const Geometry::Triangle &
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, triangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, triangle))
+    if (inside)
     {
         if (Geometry::foot_point(triangle[index > 0 ? index - 1 : 2], triangle[index], circle, tail, false))
         {
@@ -1852,16 +2172,17 @@ double Collision::epa(const Geometry::Polygon &polygon, const Geometry::Circle &
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Collision::is_point_inside(circle, polygon);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Collision::is_point_inside(circle, polygon))
+    if (inside)
     {
         if (Geometry::foot_point(polygon[index - 1], polygon[index], circle, head, false))
         {
@@ -1917,16 +2238,17 @@ double Collision::epa(const Geometry::Rectangle &rectangle, const Geometry::Circ
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, head, false))
         {
@@ -1984,16 +2306,17 @@ double Collision::epa(const Geometry::AABBRect &rectangle, const Geometry::Circl
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, rectangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, rectangle))
+    if (inside)
     {
         if (Geometry::foot_point(rectangle[index > 0 ? index - 1 : 3], rectangle[index], circle, head, false))
         {
@@ -2051,16 +2374,17 @@ double Collision::epa(const Geometry::Square &square, const Geometry::Circle &ci
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, square);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, square))
+    if (inside)
     {
         if (Geometry::foot_point(square[index > 0 ? index - 1 : 3], square[index], circle, head, false))
         {
@@ -2118,16 +2442,17 @@ double Collision::epa(const Geometry::Triangle &triangle, const Geometry::Circle
             index = i;
         }
     }
-    if (length > circle.radius * circle.radius)
+    const bool inside = Geometry::is_inside(circle, triangle);
+    if (!inside && length > circle.radius * circle.radius)
     {
         return -1;
     }
-    else if (length == circle.radius * circle.radius)
+    else if (!inside && length == circle.radius * circle.radius)
     {
         return 0;
     }
 
-    if (Geometry::is_inside(circle, triangle))
+    if (inside)
     {
         if (Geometry::foot_point(triangle[index > 0 ? index - 1 : 2], triangle[index], circle, head, false))
         {
@@ -2174,216 +2499,7 @@ double Collision::epa(const Geometry::Triangle &triangle, const Geometry::Circle
 
 double Collision::epa(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, Geometry::Point &head, Geometry::Point &tail)
 {
-    switch (points0->type())
-    {
-    case Geometry::Type::POLYGON:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), head, tail);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), head, tail);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), head, tail);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), head, tail);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), head, tail);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), head, tail);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Line *>(points1), head, tail);
-        default:
-            return -1;
-        }
-    case Geometry::Type::RECTANGLE:
-    case Geometry::Type::SQUARE:
-    case Geometry::Type::AABBRECT:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), head, tail);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), head, tail);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), head, tail);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), head, tail);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), head, tail);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), head, tail);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), head, tail);
-        default:
-            return -1;
-        }
-    case Geometry::Type::TRIANGLE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), head, tail);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), head, tail);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), head, tail);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), head, tail);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), head, tail);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), head, tail);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), head, tail);
-        default:
-            return -1;
-        }
-    case Geometry::Type::CIRCLE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), head, tail);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), head, tail);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), head, tail);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), head, tail);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), head, tail);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), head, tail);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), head, tail);
-        default:
-            return -1;
-        }
-    case Geometry::Type::POLYLINE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), head, tail);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), head, tail);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), head, tail);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), head, tail);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), head, tail);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), head, tail);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Line *>(points1), head, tail);
-        default:
-            return -1;
-        }
-    case Geometry::Type::BEZIER:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), head, tail);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), head, tail);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), head, tail);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), head, tail);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), head, tail);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), head, tail);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Line *>(points1), head, tail);
-        default:
-            return -1;
-        }
-    case Geometry::Type::LINE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), head, tail);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), head, tail);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), head, tail);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), head, tail);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), head, tail);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), head, tail);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Line *>(points1), head, tail);
-        default:
-            return -1;
-        }
-    default:
-        return -1;
-    }
+    return EPA_POINTS_TABLE[points0->type() * TYPE_COUNT + points1->type()](points0, points1, head, tail);
 }
 
 
@@ -2394,214 +2510,5 @@ double Collision::epa(const Geometry::Circle &circle0, const Geometry::Circle &c
 
 double Collision::epa(const Geometry::GeometryObject *points0, const Geometry::GeometryObject *points1, const double tx, const double ty, Geometry::Vector &vec)
 {
-     switch (points0->type())
-    {
-    case Geometry::Type::POLYGON:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), tx, ty, vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), tx, ty, vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), tx, ty, vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), tx, ty, vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), tx, ty, vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), tx, ty, vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Polygon *>(points0),
-                *static_cast<const Geometry::Line *>(points1), tx, ty, vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::RECTANGLE:
-    case Geometry::Type::SQUARE:
-    case Geometry::Type::AABBRECT:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), tx, ty, vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), tx, ty, vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), tx, ty, vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), tx, ty, vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), tx, ty, vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), tx, ty, vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Rectangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), tx, ty, vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::TRIANGLE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), tx, ty, vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), tx, ty, vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), tx, ty, vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), tx, ty, vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), tx, ty, vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), tx, ty, vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Triangle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), tx, ty, vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::CIRCLE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), tx, ty, vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), tx, ty, vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), tx, ty, vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), tx, ty, vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), tx, ty, vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Circle *>(points0),
-                *static_cast<const Geometry::Line *>(points1), tx, ty, vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::POLYLINE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), tx, ty, vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), tx, ty, vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), tx, ty, vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), tx, ty, vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), tx, ty, vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), tx, ty, vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Polyline *>(points0),
-                *static_cast<const Geometry::Line *>(points1), tx, ty, vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::BEZIER:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), tx, ty, vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), tx, ty, vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), tx, ty, vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), tx, ty, vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), tx, ty, vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), tx, ty, vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Bezier *>(points0),
-                *static_cast<const Geometry::Line *>(points1), tx, ty, vec);
-        default:
-            return -1;
-        }
-    case Geometry::Type::LINE:
-        switch (points0->type())
-        {
-        case Geometry::Type::POLYGON:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polygon *>(points1), tx, ty, vec);
-        case Geometry::Type::RECTANGLE:
-        case Geometry::Type::SQUARE:
-        case Geometry::Type::AABBRECT:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Rectangle *>(points1), tx, ty, vec);
-        case Geometry::Type::TRIANGLE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Triangle *>(points1), tx, ty, vec);
-        case Geometry::Type::CIRCLE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Circle *>(points1), tx, ty, vec);
-        case Geometry::Type::POLYLINE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Polyline *>(points1), tx, ty, vec);
-        case Geometry::Type::BEZIER:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Bezier *>(points1), tx, ty, vec);
-        case Geometry::Type::LINE:
-            return Collision::epa(*static_cast<const Geometry::Line *>(points0),
-                *static_cast<const Geometry::Line *>(points1), tx, ty, vec);
-        default:
-            return -1;
-        }
-    default:
-        return -1;
-    }
+    return EPA_DIRECTION_TABLE[points0->type() * TYPE_COUNT + points1->type()](points0, points1, tx, ty, vec);
 }
\ No newline at end of file
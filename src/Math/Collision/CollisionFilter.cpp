@@ -0,0 +1,67 @@
+#include "Math/Collision/CollisionFilter.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+static const Collision::CollisionLayer DEFAULT_LAYER;
+
+bool Collision::CollisionLayer::accepts(const Collision::CollisionLayer &layer) const
+{
+    return (category & layer.mask) != 0 && (layer.category & mask) != 0;
+}
+
+const Collision::CollisionLayer &Collision::CollisionFilter::default_layer()
+{
+    return DEFAULT_LAYER;
+}
+
+bool Collision::CollisionFilter::is_default(const Collision::CollisionLayer &layer)
+{
+    return layer.category == DEFAULT_LAYER.category && layer.mask == DEFAULT_LAYER.mask;
+}
+
+const Collision::CollisionLayer &Collision::CollisionFilter::layer(const size_t index) const
+{
+    return index < _layers.size() ? _layers[index] : DEFAULT_LAYER;
+}
+
+void Collision::CollisionFilter::set_layer(const size_t index, const Collision::CollisionLayer &layer)
+{
+    if (index >= _layers.size())
+    {
+        if (is_default(layer))
+        {
+            return;
+        }
+        _layers.resize(index + 1);
+    }
+    _count -= is_default(_layers[index]) ? 0 : 1;
+    _count += is_default(layer) ? 0 : 1;
+    _layers[index] = layer;
+}
+
+void Collision::CollisionFilter::reset(const size_t index)
+{
+    set_layer(index, DEFAULT_LAYER);
+}
+
+void Collision::CollisionFilter::clear()
+{
+    _layers.clear();
+    _count = 0;
+}
+
+bool Collision::CollisionFilter::empty() const
+{
+    return _count == 0;
+}
+
+bool Collision::CollisionFilter::accepts(const size_t index0, const size_t index1) const
+{
+    return _count == 0 || layer(index0).accepts(layer(index1));
+}
+
+bool Collision::CollisionFilter::accepts(const Collision::CollisionLayer &layer, const size_t index) const
+{
+    return _count == 0 || layer.accepts(this->layer(index));
+}
\ No newline at end of file
@@ -13,73 +13,147 @@ Collision::DirectMode::DirectMode()
 }
 
 Collision::DirectMode::DirectMode(const std::vector<Geometry::GeometryObject *> &objects)
-    : _objects(objects)
 {
-
+    build(objects.cbegin(), objects.cend());
 }
 
 Collision::DirectMode::DirectMode(const std::initializer_list<Geometry::GeometryObject *> &objects)
-    : _objects(objects.begin(), objects.end())
 {
-
+    build(std::vector<Geometry::GeometryObject *>(objects.begin(), objects.end()));
 }
 
 Collision::DirectMode::DirectMode(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end)
-    : _objects(begin, end)
 {
-
+    build(begin, end);
 }
 
 void Collision::DirectMode::build(const std::vector<Geometry::GeometryObject *> &objects)
 {
-    _objects.assign(objects.cbegin(), objects.cend());
+    if (&objects == &_objects)
+    {
+        return update();
+    }
+    build(objects.cbegin(), objects.cend());
 }
 
 void Collision::DirectMode::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, const std::vector<Geometry::GeometryObject *>::const_iterator &end)
 {
-    _objects.assign(begin, end);
+    clear();
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+    {
+        if (_indexs.emplace(*it, _objects.size()).second)
+        {
+            _objects.push_back(*it);
+            _rects.emplace_back((*it)->bounding_rect());
+        }
+    }
 }
 
 void Collision::DirectMode::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
 {
-    _objects.assign(objects.cbegin(), objects.cend());
+    if (&objects == &_objects)
+    {
+        return;
+    }
+
+    clear();
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        if (_indexs.emplace(objects[i], _objects.size()).second)
+        {
+            _objects.push_back(objects[i]);
+            _rects.emplace_back(rects[i]);
+        }
+    }
 }
 
-void Collision::DirectMode::append(Geometry::GeometryObject *object)
+size_t Collision::DirectMode::append(Geometry::GeometryObject *object)
 {
-    if (std::find(_objects.begin(), _objects.end(), object) == _objects.end())
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        return it->second;
+    }
+
+    size_t index = _objects.size();
+    if (_free_indexs.empty())
     {
         _objects.push_back(object);
+        _rects.emplace_back(object->bounding_rect());
     }
+    else
+    {
+        index = _free_indexs.back();
+        _free_indexs.pop_back();
+        _objects[index] = object;
+        _rects[index] = object->bounding_rect();
+    }
+    _indexs[object] = index;
+    return index;
 }
 
 void Collision::DirectMode::remove(Geometry::GeometryObject *object)
 {
-    std::vector<Geometry::GeometryObject *>::const_iterator it = std::find(_objects.begin(), _objects.end(), object);
-    if (it == _objects.end())
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
     {
-        _objects.erase(it);
+        _objects[it->second] = nullptr;
+        _free_indexs.push_back(it->second);
+        _filter.reset(it->second);
+        _indexs.erase(it);
     }
 }
 
 void Collision::DirectMode::update(Geometry::GeometryObject *object)
 {
-
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        _rects[it->second] = object->bounding_rect();
+    }
 }
 
 void Collision::DirectMode::update()
 {
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            _rects[i] = _objects[i]->bounding_rect();
+        }
+    }
+}
 
+void Collision::DirectMode::update(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    update(objects.cbegin(), objects.cend());
+}
+
+void Collision::DirectMode::update(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+    {
+        std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator index = _indexs.find(*it);
+        if (index != _indexs.end())
+        {
+            _rects[index->second] = (*it)->bounding_rect();
+        }
+    }
 }
 
 bool Collision::DirectMode::has(Geometry::GeometryObject *object) const
 {
-    return std::find(_objects.begin(), _objects.end(), object) != _objects.end();
+    return _indexs.find(object) != _indexs.end();
 }
 
 void Collision::DirectMode::clear()
 {
     _objects.clear();
+    _rects.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
 }
 
 bool Collision::DirectMode::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
@@ -87,6 +161,10 @@ bool Collision::DirectMode::select(const Geometry::Point &pos, std::vector<Geome
     const size_t size = objects.size();
     for (Geometry::GeometryObject *object : _objects)
     {
+        if (object == nullptr)
+        {
+            continue;
+        }
         switch (object->type())
         {
         case Geometry::Type::POLYGON:
@@ -161,6 +239,10 @@ bool Collision::DirectMode::select(const Geometry::AABBRect &rect, std::vector<G
     const size_t size = objects.size();
     for (Geometry::GeometryObject *object : _objects)
     {
+        if (object == nullptr)
+        {
+            continue;
+        }
         switch (object->type())
         {
         case Geometry::Type::POLYGON:
@@ -230,31 +312,92 @@ bool Collision::DirectMode::select(const Geometry::AABBRect &rect, std::vector<G
     return objects.size() > size;
 }
 
+bool Collision::DirectMode::query_radius(const Geometry::Point &pos, const double radius,
+    std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
+{
+    return Collision::query_radius(_objects, _rects, pos, radius, objects);
+}
+
+bool Collision::DirectMode::query_knn(const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
+{
+    return Collision::query_knn(_objects, _rects, pos, k, objects);
+}
+
+const Collision::CollisionLayer &Collision::DirectMode::layer(const Geometry::GeometryObject *object) const
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(const_cast<Geometry::GeometryObject *>(object));
+    return it == _indexs.end() ? Collision::CollisionFilter::default_layer() : _filter.layer(it->second);
+}
+
+void Collision::DirectMode::set_layer(Geometry::GeometryObject *object, const Collision::CollisionLayer &layer)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        _filter.set_layer(it->second, layer);
+    }
+}
+
 bool Collision::DirectMode::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat) const
 {
+    if (object == nullptr)
+    {
+        return false;
+    }
+
     const size_t size = objects.size();
-    for (Geometry::GeometryObject *obj : _objects)
+    const Geometry::AABBRect rect(object->bounding_rect());
+    const Collision::CollisionLayer &layer = this->layer(object);
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
     {
-        if (obj != object && Geometry::is_intersected(object, obj))
+        if (_objects[i] != nullptr && _objects[i] != object && Geometry::is_intersected(rect, _rects[i])
+            && _filter.accepts(layer, i) && Geometry::NoAABBTest::is_intersected(object, _objects[i]))
         {
-            objects.push_back(obj);
+            objects.push_back(_objects[i]);
         }
     }
     return objects.size() > size;
 }
 
-bool Collision::DirectMode::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+bool Collision::DirectMode::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    const bool norepeat, const bool narrow) const
 {
     const size_t size = pairs.size();
     for (size_t i = 0, count = _objects.size(); i < count; ++i)
     {
+        if (_objects[i] == nullptr)
+        {
+            continue;
+        }
         for (size_t j = i + 1; j < count; ++j)
         {
-            if (Geometry::is_intersected(_objects[i], _objects[j]))
+            if (_objects[j] != nullptr && Geometry::is_intersected(_rects[i], _rects[j]) && _filter.accepts(i, j)
+                && (!narrow || Geometry::NoAABBTest::is_intersected(_objects[i], _objects[j])))
             {
                 pairs.emplace_back(_objects[i], _objects[j]);
             }
         }
     }
     return pairs.size() > size;
+}
+
+bool Collision::DirectMode::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+{
+    return find_collision_pairs(pairs, norepeat, true);
+}
+
+bool Collision::DirectMode::find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
+{
+    return find_collision_pairs(pairs, true, false);
+}
+
+bool Collision::DirectMode::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, Collision::RaycastHit &hit) const
+{
+    return Collision::raycast(_objects, _rects, origin, dir, max_t, hit);
+}
+
+bool Collision::DirectMode::raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    std::vector<Collision::RaycastHit> &hits) const
+{
+    return Collision::raycast_all(_objects, _rects, origin, dir, max_t, hits);
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
-#include <set>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
 #include "Math/Collision/GridMap.hpp"
 #include "Math/Collision/Algorithm.hpp"
 #include "Math/Geometry/Algorithm.hpp"
@@ -34,31 +36,83 @@ const Geometry::AABBRect &Collision::GridNode::rect() const
     return _rect;
 }
 
-bool Collision::GridNode::append(Geometry::GeometryObject *object)
+size_t Collision::GridNode::append(Geometry::GeometryObject *object, const size_t index, const Geometry::AABBRect &rect)
 {
-    if (std::find(_objects.begin(), _objects.end(), object) == _objects.end())
-    {
-        _objects.push_back(object);
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    _objects.push_back(object);
+    _indexs.push_back(index);
+    _lefts.push_back(rect.left());
+    _tops.push_back(rect.top());
+    _rights.push_back(rect.right());
+    _bottoms.push_back(rect.bottom());
+    return _objects.size() - 1;
+}
+
+void Collision::GridNode::remove(const size_t pos)
+{
+    _objects[pos] = _objects.back();
+    _objects.pop_back();
+    _indexs[pos] = _indexs.back();
+    _indexs.pop_back();
+    _lefts[pos] = _lefts.back();
+    _lefts.pop_back();
+    _tops[pos] = _tops.back();
+    _tops.pop_back();
+    _rights[pos] = _rights.back();
+    _rights.pop_back();
+    _bottoms[pos] = _bottoms.back();
+    _bottoms.pop_back();
+}
+
+void Collision::GridNode::resize(const size_t size)
+{
+    _objects.resize(size);
+    _indexs.resize(size);
+    _lefts.resize(size);
+    _tops.resize(size);
+    _rights.resize(size);
+    _bottoms.resize(size);
+}
+
+void Collision::GridNode::set(const size_t pos, Geometry::GeometryObject *object, const size_t index, const Geometry::AABBRect &rect)
+{
+    _objects[pos] = object;
+    _indexs[pos] = index;
+    _lefts[pos] = rect.left();
+    _tops[pos] = rect.top();
+    _rights[pos] = rect.right();
+    _bottoms[pos] = rect.bottom();
+}
+
+size_t Collision::GridNode::size() const
+{
+    return _objects.size();
+}
+
+size_t Collision::GridNode::index(const size_t pos) const
+{
+    return _indexs[pos];
 }
 
-bool Collision::GridNode::remove(Geometry::GeometryObject *object)
-{   
-    std::vector<Geometry::GeometryObject *>::iterator it = std::find(_objects.begin(), _objects.end(), object);
-    if (it == _objects.end())
+size_t Collision::GridNode::filter(const double left, const double top, const double right, const double bottom,
+    const size_t begin, std::vector<size_t> &positions) const
+{
+    const size_t count = _objects.size();
+    if (begin >= count)
     {
-        return false;
+        positions.clear();
+        return 0;
     }
-    else
+
+    // 无分支地写入候选位置,循环可被编译器向量化
+    positions.resize(count - begin);
+    size_t num = 0;
+    for (size_t i = begin; i < count; ++i)
     {
-        _objects.erase(it);
-        return true;
+        positions[num] = i;
+        num += (_lefts[i] <= right) & (_rights[i] >= left) & (_bottoms[i] <= top) & (_tops[i] >= bottom);
     }
+    positions.resize(num);
+    return num;
 }
 
 bool Collision::GridNode::has(Geometry::GeometryObject *object) const
@@ -69,6 +123,69 @@ bool Collision::GridNode::has(Geometry::GeometryObject *object) const
 void Collision::GridNode::clear()
 {
     _objects.clear();
+    _indexs.clear();
+    _lefts.clear();
+    _tops.clear();
+    _rights.clear();
+    _bottoms.clear();
+}
+
+bool Collision::GridNode::is_selected(const Geometry::Point &pos, const Geometry::GeometryObject *object)
+{
+    switch (object->type())
+    {
+    case Geometry::Type::POLYGON:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::Polygon *>(object), true);
+    case Geometry::Type::RECTANGLE:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::Rectangle *>(object));
+    case Geometry::Type::AABBRECT:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::AABBRect *>(object));
+    case Geometry::Type::SQUARE:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::Square *>(object));
+    case Geometry::Type::POLYLINE:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::Polyline *>(object));
+    case Geometry::Type::BEZIER:
+        return Geometry::is_inside(pos, static_cast<const Geometry::Bezier *>(object)->shape());
+    case Geometry::Type::TRIANGLE:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::Triangle *>(object), true);
+    case Geometry::Type::CIRCLE:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::Circle *>(object), true);
+    case Geometry::Type::LINE:
+        return Geometry::is_inside(pos, *static_cast<const Geometry::Line *>(object));
+    case Geometry::Type::POINT:
+        return pos == *static_cast<const Geometry::Point *>(object);
+    default:
+        return false;
+    }
+}
+
+bool Collision::GridNode::is_selected(const Geometry::AABBRect &rect, const Geometry::GeometryObject *object)
+{
+    switch (object->type())
+    {
+    case Geometry::Type::POLYGON:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::Polygon *>(object));
+    case Geometry::Type::POLYLINE:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::Polyline *>(object));
+    case Geometry::Type::RECTANGLE:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::Rectangle *>(object));
+    case Geometry::Type::AABBRECT:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::AABBRect *>(object));
+    case Geometry::Type::SQUARE:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::Square *>(object));
+    case Geometry::Type::TRIANGLE:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::Triangle *>(object));
+    case Geometry::Type::BEZIER:
+        return Geometry::is_intersected(rect, static_cast<const Geometry::Bezier *>(object)->shape());
+    case Geometry::Type::CIRCLE:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::Circle *>(object));
+    case Geometry::Type::LINE:
+        return Geometry::is_intersected(rect, *static_cast<const Geometry::Line *>(object));
+    case Geometry::Type::POINT:
+        return Geometry::is_inside(*static_cast<const Geometry::Point *>(object), rect);
+    default:
+        return false;
+    }
 }
 
 bool Collision::GridNode::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
@@ -76,70 +193,9 @@ bool Collision::GridNode::select(const Geometry::Point &pos, std::vector<Geometr
     const size_t size = objects.size();
     for (Geometry::GeometryObject *object : _objects)
     {
-        switch (object->type())
+        if (is_selected(pos, object))
         {
-        case Geometry::Type::POLYGON:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::Polygon *>(object), true))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::RECTANGLE:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::Rectangle *>(object)))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::AABBRECT:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::AABBRect *>(object)))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::SQUARE:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::Square *>(object)))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::POLYLINE:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::Polyline *>(object)))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::BEZIER:
-            if (Geometry::is_inside(pos, static_cast<Geometry::Bezier *>(object)->shape()))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::TRIANGLE:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::Triangle *>(object), true))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::CIRCLE:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::Circle *>(object), true))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::LINE:
-            if (Geometry::is_inside(pos, *static_cast<Geometry::Line *>(object)))
-            {
-                objects.push_back(object);
-            }
-            break;
-        case Geometry::Type::POINT:
-            if (pos == *static_cast<Geometry::Point *>(object))
-            {
-                objects.push_back(object);
-            }
-            break;
-        default:
-            break;
+            objects.push_back(object);
         }
     }
     return objects.size() > size;
@@ -150,515 +206,1061 @@ bool Collision::GridNode::select(const Geometry::AABBRect &rect, std::vector<Geo
     const size_t size = objects.size();
     for (Geometry::GeometryObject *object : _objects)
     {
-        switch (object->type())
+        if (is_selected(rect, object))
+        {
+            objects.push_back(object);
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::GridNode::query_radius(const Geometry::Point &pos, const double radius,
+    std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
+{
+    const size_t size = objects.size();
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (Collision::distance(pos, _lefts[i], _tops[i], _rights[i], _bottoms[i]) <= radius)
         {
-        case Geometry::Type::POLYGON:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::Polygon *>(object)))
+            const double value = Collision::distance(pos, _objects[i]);
+            if (value <= radius)
             {
-                objects.push_back(object);
+                objects.emplace_back(_objects[i], value);
             }
-            break;
-        case Geometry::Type::POLYLINE:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::Polyline *>(object)))
+        }
+    }
+    return objects.size() > size;
+}
+
+template <typename F>
+void Collision::GridNode::query_knn(const Geometry::Point &pos, const size_t k, const size_t begin,
+    std::vector<std::pair<Geometry::GeometryObject *, double>> &objects, const F &is_owner) const
+{
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        // AABB矩形的距离不大于对象的距离
+        if (Collision::distance(pos, _lefts[i], _tops[i], _rights[i], _bottoms[i]) <= Collision::nearest_bound(objects, begin, k) && is_owner(_indexs[i]))
+        {
+            Collision::push_nearest(objects, begin, k, _objects[i], Collision::distance(pos, _objects[i]));
+        }
+    }
+}
+
+bool Collision::GridNode::find_collision_objects(const Geometry::GeometryObject *object, const Geometry::AABBRect &rect, const Collision::CollisionLayer &layer,
+    const Collision::CollisionFilter &collision_filter, std::vector<Geometry::GeometryObject *> &objects, Collision::CollisionStatistics &statistics) const
+{
+    const size_t size = objects.size();
+    std::vector<size_t> positions;
+    const size_t num = filter(rect.left(), rect.top(), rect.right(), rect.bottom(), 0, positions);
+    statistics.candidates += _objects.size();
+    statistics.aabb_rejected += _objects.size() - num;
+    for (const size_t pos : positions)
+    {
+        const Geometry::GeometryObject *obj = _objects[pos];
+        if (obj == object)
+        {
+            --statistics.candidates;
+        }
+        else if (!collision_filter.accepts(layer, _indexs[pos]))
+        {
+            ++statistics.layer_rejected;
+        }
+        else if (Collision::gjk(obj, object))
+        {
+            objects.push_back(_objects[pos]);
+        }
+        else
+        {
+            ++statistics.gjk_rejected;
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::GridNode::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, Collision::RaycastHit &hit) const
+{
+    bool result = false;
+    double enter, exit;
+    Collision::RaycastHit current;
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (Collision::raycast(origin, dir, hit.t, _lefts[i], _tops[i], _rights[i], _bottoms[i], enter, exit)
+            && Collision::raycast(_objects[i], origin, dir, hit.t, current) && (hit.object == nullptr || current.t < hit.t))
+        {
+            hit = current;
+            result = true;
+        }
+    }
+    return result;
+}
+
+bool Collision::GridNode::raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    std::vector<Collision::RaycastHit> &hits) const
+{
+    const size_t size = hits.size();
+    double enter, exit;
+    Collision::RaycastHit hit;
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (Collision::raycast(origin, dir, max_t, _lefts[i], _tops[i], _rights[i], _bottoms[i], enter, exit)
+            && Collision::raycast(_objects[i], origin, dir, max_t, hit))
+        {
+            hits.push_back(hit);
+        }
+    }
+    return hits.size() > size;
+}
+
+Collision::CollisionStatistics &Collision::CollisionStatistics::operator+=(const Collision::CollisionStatistics &statistics)
+{
+    candidates += statistics.candidates;
+    aabb_rejected += statistics.aabb_rejected;
+    repeat_rejected += statistics.repeat_rejected;
+    layer_rejected += statistics.layer_rejected;
+    gjk_rejected += statistics.gjk_rejected;
+    return *this;
+}
+
+void Collision::split_pair_tasks(const std::vector<size_t> &sizes, const size_t count, std::vector<Collision::PairTask> &tasks)
+{
+    // 第i个对象需与其后的size - i - 1个对象检测,按此估计工作量
+    size_t total = 0;
+    for (const size_t size : sizes)
+    {
+        total += size * (size - (size > 0)) / 2;
+    }
+    const size_t target = std::max<size_t>(total / (std::max<size_t>(count, 1) * 8), 256);
+
+    tasks.clear();
+    for (size_t node = 0, node_count = sizes.size(); node < node_count; ++node)
+    {
+        size_t begin = 0, work = 0;
+        for (size_t i = 0, size = sizes[node]; i < size; ++i)
+        {
+            work += size - i - 1;
+            if (work >= target || i + 1 == size)
             {
-                objects.push_back(object);
+                tasks.emplace_back();
+                tasks.back().node = node;
+                tasks.back().begin = begin;
+                tasks.back().end = i + 1;
+                begin = i + 1;
+                work = 0;
             }
-            break;
-        case Geometry::Type::RECTANGLE:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::Rectangle *>(object)))
+        }
+    }
+}
+
+
+Collision::GridMap::GridMap(const Collision::GridMapConfig &config)
+    : _config(config)
+{
+    rebuild();
+}
+
+Collision::GridMap::GridMap(const std::vector<Geometry::GeometryObject *> &objects, const Collision::GridMapConfig &config)
+    : _config(config)
+{
+    build(objects);
+}
+
+Collision::GridMap::GridMap(const std::initializer_list<Geometry::GeometryObject *> &objects, const Collision::GridMapConfig &config)
+    : _config(config)
+{
+    build(std::vector<Geometry::GeometryObject *>(objects.begin(), objects.end()));
+}
+
+Collision::GridMap::GridMap(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, 
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end, const Collision::GridMapConfig &config)
+    : _config(config)
+{
+    build(begin, end);
+}
+
+Collision::GridMap::GridRange Collision::GridMap::grid_range(const Geometry::AABBRect &rect) const
+{
+    // 网格按列优先排列,第i列第j行的网格下标为i * _rows + j,行号自上而下递增
+    Collision::GridMap::GridRange range;
+    const double x_step = (_right - _left) / _columns, y_step = (_top - _bottom) / _rows;
+    if (x_step > 0)
+    {
+        range.left = static_cast<size_t>(std::clamp((rect.left() - _left) / x_step, 0.0, _columns - 1.0));
+        range.right = static_cast<size_t>(std::clamp((rect.right() - _left) / x_step, 0.0, _columns - 1.0));
+    }
+    if (y_step > 0)
+    {
+        range.top = static_cast<size_t>(std::clamp((_top - rect.top()) / y_step, 0.0, _rows - 1.0));
+        range.bottom = static_cast<size_t>(std::clamp((_top - rect.bottom()) / y_step, 0.0, _rows - 1.0));
+    }
+    return range;
+}
+
+size_t Collision::GridMap::owner_grid(const size_t grid0, const size_t grid1) const
+{
+    return std::max(grid0 / _rows, grid1 / _rows) * _rows + std::max(grid0 % _rows, grid1 % _rows);
+}
+
+template <typename F>
+void Collision::GridMap::traverse(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, const F &visit) const
+{
+    double enter, exit;
+    if (!Collision::raycast(origin, dir, max_t, _left, _top, _right, _bottom, enter, exit))
+    {
+        return;
+    }
+
+    // 网格的列号自左向右递增,行号自上而下递增
+    const double x_step = (_right - _left) / _columns, y_step = (_top - _bottom) / _rows;
+    const Geometry::Point start = origin + dir * enter;
+    long long column = 0, row = 0;
+    double next_x = DBL_MAX, next_y = DBL_MAX, delta_x = 0, delta_y = 0;
+    if (x_step > 0)
+    {
+        column = std::clamp(static_cast<long long>(std::floor((start.x - _left) / x_step)), 0LL, static_cast<long long>(_columns) - 1);
+        if (dir.x != 0)
+        {
+            next_x = (_left + (column + (dir.x > 0 ? 1 : 0)) * x_step - origin.x) / dir.x;
+            delta_x = x_step / std::abs(dir.x);
+        }
+    }
+    if (y_step > 0)
+    {
+        row = std::clamp(static_cast<long long>(std::floor((_top - start.y) / y_step)), 0LL, static_cast<long long>(_rows) - 1);
+        if (dir.y != 0)
+        {
+            next_y = (_top - (row + (dir.y < 0 ? 1 : 0)) * y_step - origin.y) / dir.y;
+            delta_y = y_step / std::abs(dir.y);
+        }
+    }
+
+    while (true)
+    {
+        const double leave = std::min(std::min(next_x, next_y), exit);
+        if (visit(static_cast<size_t>(column) * _rows + static_cast<size_t>(row), leave) || leave >= exit)
+        {
+            return;
+        }
+        if (next_x < next_y)
+        {
+            column += dir.x > 0 ? 1 : -1;
+            next_x += delta_x;
+        }
+        else
+        {
+            row += dir.y < 0 ? 1 : -1;
+            next_y += delta_y;
+        }
+        if (column < 0 || row < 0 || column >= static_cast<long long>(_columns) || row >= static_cast<long long>(_rows))
+        {
+            return;
+        }
+    }
+}
+
+bool Collision::GridMap::is_in_bounds(const Geometry::AABBRect &rect) const
+{
+    return rect.left() >= _left && rect.right() <= _right && rect.top() <= _top && rect.bottom() >= _bottom;
+}
+
+void Collision::GridMap::insert_grids(const size_t index)
+{
+    const Collision::GridMap::GridRange range = grid_range(_rects[index]);
+    std::vector<Collision::GridMap::GridEntry> &entries = _entries[index];
+    for (size_t i = range.left; i <= range.right; ++i)
+    {
+        for (size_t j = range.top; j <= range.bottom; ++j)
+        {
+            entries.emplace_back();
+            entries.back().grid = i * _rows + j;
+            entries.back().pos = _grids[entries.back().grid].append(_objects[index], index, _rects[index]);
+        }
+    }
+}
+
+void Collision::GridMap::remove_grids(const size_t index)
+{
+    for (const Collision::GridMap::GridEntry &entry : _entries[index])
+    {
+        GridNode &grid = _grids[entry.grid];
+        grid.remove(entry.pos);
+        if (entry.pos < grid.size())
+        {
+            // 网格末尾的对象被移动到了entry.pos
+            for (Collision::GridMap::GridEntry &moved_entry : _entries[grid.index(entry.pos)])
             {
-                objects.push_back(object);
+                if (moved_entry.grid == entry.grid)
+                {
+                    moved_entry.pos = entry.pos;
+                    break;
+                }
             }
-            break;
-        case Geometry::Type::AABBRECT:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::AABBRect *>(object)))
+        }
+    }
+    _entries[index].clear();
+}
+
+void Collision::GridMap::rebuild()
+{
+    rebuild(nullptr);
+}
+
+void Collision::GridMap::rebuild(Collision::ThreadPool *pool)
+{
+    const size_t count = _objects.size();
+    // 每段至少1024个对象,串行时只有一段
+    const size_t chunks = pool == nullptr ? 1 : std::max<size_t>(std::min(pool->size() * 4, count / 1024), 1);
+    const auto run = [&](const auto &task)
+    {
+        if (pool == nullptr)
+        {
+            task(0, 0, count);
+        }
+        else
+        {
+            pool->run(chunks, [&](const size_t chunk, const size_t) { task(chunk, count * chunk / chunks, count * (chunk + 1) / chunks); });
+        }
+    };
+
+    _bounds.resize(chunks * 4);
+    run([&](const size_t chunk, const size_t begin, const size_t end)
+    {
+        double left = DBL_MAX, top = -DBL_MAX, right = -DBL_MAX, bottom = DBL_MAX;
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (_objects[i] != nullptr)
             {
-                objects.push_back(object);
+                left = std::min(_rects[i].left(), left);
+                top = std::max(_rects[i].top(), top);
+                right = std::max(_rects[i].right(), right);
+                bottom = std::min(_rects[i].bottom(), bottom);
             }
-            break;
-        case Geometry::Type::SQUARE:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::Square *>(object)))
+        }
+        _bounds[chunk * 4] = left;
+        _bounds[chunk * 4 + 1] = top;
+        _bounds[chunk * 4 + 2] = right;
+        _bounds[chunk * 4 + 3] = bottom;
+    });
+    _left = _bottom = DBL_MAX;
+    _right = _top = -DBL_MAX;
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        _left = std::min(_bounds[i * 4], _left);
+        _top = std::max(_bounds[i * 4 + 1], _top);
+        _right = std::max(_bounds[i * 4 + 2], _right);
+        _bottom = std::min(_bounds[i * 4 + 3], _bottom);
+    }
+    if (_indexs.empty())
+    {
+        _left = _bottom = 0;
+        _right = _top = 100;
+    }
+
+    if (_indexs.size() > _config.split_objects || (_right - _left) > _config.split_width)
+    {
+        _columns = std::max<size_t>(_config.columns, 1);
+        _rows = std::max<size_t>(_config.rows, 1);
+        if (_config.cell_size > 0)
+        {
+            _columns = std::min(_columns, static_cast<size_t>(std::max((_right - _left) / _config.cell_size, 1.0)));
+            _rows = std::min(_rows, static_cast<size_t>(std::max((_top - _bottom) / _config.cell_size, 1.0)));
+        }
+    }
+    else
+    {
+        _columns = _rows = 1;
+    }
+    // 保留已有网格的容量
+    const size_t grid_count = _columns * _rows;
+    _grids.resize(grid_count);
+    const double x_step = (_right - _left) / _columns, y_step = (_top - _bottom) / _rows;
+    for (size_t i = 0; i < _columns; ++i)
+    {
+        for (size_t j = 0; j < _rows; ++j)
+        {
+            _grids[i * _rows + j].set_rect(Geometry::AABBRect(_left + x_step * i, _top - y_step * j,
+                _left + x_step * i + x_step, _top - y_step * j - y_step));
+        }
+    }
+
+    _ranges.resize(count);
+    _offsets.assign(chunks * grid_count, 0);
+    run([&](const size_t chunk, const size_t begin, const size_t end)
+    {
+        size_t *counts = _offsets.data() + chunk * grid_count;
+        for (size_t k = begin; k < end; ++k)
+        {
+            if (_objects[k] == nullptr)
             {
-                objects.push_back(object);
+                continue;
             }
-            break;
-        case Geometry::Type::TRIANGLE:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::Triangle *>(object)))
+            const Collision::GridMap::GridRange &range = _ranges[k] = grid_range(_rects[k]);
+            for (size_t i = range.left; i <= range.right; ++i)
             {
-                objects.push_back(object);
+                for (size_t j = range.top; j <= range.bottom; ++j)
+                {
+                    ++counts[i * _rows + j];
+                }
             }
-            break;
-        case Geometry::Type::BEZIER:
-            if (Geometry::is_intersected(rect, static_cast<Geometry::Bezier *>(object)->shape()))
+        }
+    });
+
+    // 各网格中的对象按段的顺序排列,与逐个插入的顺序一致
+    for (size_t i = 0; i < grid_count; ++i)
+    {
+        size_t total = 0;
+        for (size_t j = 0; j < chunks; ++j)
+        {
+            const size_t num = _offsets[j * grid_count + i];
+            _offsets[j * grid_count + i] = total;
+            total += num;
+        }
+        _grids[i].resize(total);
+    }
+
+    _entries.resize(count);
+    run([&](const size_t chunk, const size_t begin, const size_t end)
+    {
+        size_t *offsets = _offsets.data() + chunk * grid_count;
+        for (size_t k = begin; k < end; ++k)
+        {
+            std::vector<Collision::GridMap::GridEntry> &entries = _entries[k];
+            entries.clear();
+            if (_objects[k] == nullptr)
             {
-                objects.push_back(object);
+                continue;
             }
-            break;
-        case Geometry::Type::CIRCLE:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::Circle *>(object)))
+            const Collision::GridMap::GridRange &range = _ranges[k];
+            for (size_t i = range.left; i <= range.right; ++i)
             {
-                objects.push_back(object);
+                for (size_t j = range.top; j <= range.bottom; ++j)
+                {
+                    entries.emplace_back();
+                    entries.back().grid = i * _rows + j;
+                    entries.back().pos = offsets[entries.back().grid]++;
+                    _grids[entries.back().grid].set(entries.back().pos, _objects[k], k, _rects[k]);
+                }
             }
-            break;
-        case Geometry::Type::LINE:
-            if (Geometry::is_intersected(rect, *static_cast<Geometry::Line *>(object)))
+        }
+    });
+}
+
+void Collision::GridMap::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, 
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    _objects.clear();
+    _rects.clear();
+    _entries.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+    {
+        if (_indexs.emplace(*it, _objects.size()).second)
+        {
+            _objects.push_back(*it);
+            _rects.emplace_back((*it)->bounding_rect());
+        }
+    }
+    rebuild();
+}
+
+void Collision::GridMap::build(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    if (&objects == &_objects)
+    {
+        return update();
+    }
+    build(objects.cbegin(), objects.cend());
+}
+
+void Collision::GridMap::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
+{
+    if (&objects != &_objects)
+    {
+        _objects.clear();
+        _rects.clear();
+        _entries.clear();
+        _free_indexs.clear();
+        _indexs.clear();
+        _filter.clear();
+        for (size_t i = 0, count = objects.size(); i < count; ++i)
+        {
+            if (_indexs.emplace(objects[i], _objects.size()).second)
             {
-                objects.push_back(object);
+                _objects.push_back(objects[i]);
+                _rects.emplace_back(rects[i]);
             }
-            break;
-        case Geometry::Type::POINT:
-            if (Geometry::is_inside(*static_cast<Geometry::Point *>(object), rect))
+        }
+    }
+    rebuild();
+}
+
+void Collision::GridMap::build(const std::vector<Geometry::GeometryObject *> &objects, Collision::ThreadPool &pool)
+{
+    if (&objects != &_objects)
+    {
+        _objects.clear();
+        _entries.clear();
+        _free_indexs.clear();
+        _indexs.clear();
+        _filter.clear();
+        for (Geometry::GeometryObject *object : objects)
+        {
+            if (_indexs.emplace(object, _objects.size()).second)
             {
-                objects.push_back(object);
+                _objects.push_back(object);
             }
-            break;
-        default:
-            break;
+        }
+        _rects.resize(_objects.size());
+    }
+    update(pool);
+}
+
+size_t Collision::GridMap::append(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        return it->second;
+    }
+
+    size_t index = _objects.size();
+    if (_free_indexs.empty())
+    {
+        _objects.push_back(object);
+        _rects.emplace_back(object->bounding_rect());
+        _entries.emplace_back();
+    }
+    else
+    {
+        index = _free_indexs.back();
+        _free_indexs.pop_back();
+        _objects[index] = object;
+        _rects[index] = object->bounding_rect();
+    }
+    _indexs[object] = index;
+
+    if (is_in_bounds(_rects[index]))
+    {
+        insert_grids(index);
+    }
+    else
+    {
+        rebuild();
+    }
+    return index;
+}
+
+void Collision::GridMap::remove(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    remove_grids(index);
+    _filter.reset(it->second);
+    _indexs.erase(it);
+    _objects[index] = nullptr;
+    _free_indexs.push_back(index);
+}
+
+void Collision::GridMap::update(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    _rects[index] = object->bounding_rect();
+    if (is_in_bounds(_rects[index]))
+    {
+        remove_grids(index);
+        insert_grids(index);
+    }
+    else
+    {
+        rebuild();
+    }
+}
+
+void Collision::GridMap::update()
+{
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            _rects[i] = _objects[i]->bounding_rect();
         }
     }
-    return objects.size() > size;
+    rebuild();
 }
 
-bool Collision::GridNode::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects) const
+void Collision::GridMap::update(const std::vector<Geometry::GeometryObject *> &objects)
 {
-    const size_t size = objects.size();
-    for (Geometry::GeometryObject *obj : _objects)
+    update(objects.cbegin(), objects.cend());
+}
+
+void Collision::GridMap::update(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    std::vector<size_t> indexs;
+    bool in_bounds = true;
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
     {
-        if (obj != object && Collision::gjk(obj, object))
+        std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator index = _indexs.find(*it);
+        if (index != _indexs.end())
         {
-            objects.push_back(obj);
+            _rects[index->second] = (*it)->bounding_rect();
+            in_bounds = in_bounds && is_in_bounds(_rects[index->second]);
+            indexs.push_back(index->second);
         }
     }
-    return objects.size() > size;
+
+    // 有对象移出边界或大部分对象都移动时整体重建一次
+    if (!in_bounds || indexs.size() * 2 > _indexs.size())
+    {
+        return rebuild();
+    }
+    for (const size_t index : indexs)
+    {
+        remove_grids(index);
+        insert_grids(index);
+    }
 }
 
-bool Collision::GridNode::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
+void Collision::GridMap::update(Collision::ThreadPool &pool)
 {
-    const size_t size = pairs.size();
-    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    const size_t count = _objects.size(), chunks = std::max<size_t>(std::min(pool.size() * 4, count / 1024), 1);
+    pool.run(chunks, [&](const size_t chunk, const size_t)
     {
-        for (size_t j = i + 1; j < count; ++j)
+        for (size_t i = count * chunk / chunks, end = count * (chunk + 1) / chunks; i < end; ++i)
         {
-            if (Collision::gjk(_objects[i], _objects[j]))
+            if (_objects[i] != nullptr)
             {
-                pairs.emplace_back(_objects[i], _objects[j]);
+                _rects[i] = _objects[i]->bounding_rect();
             }
         }
-    }
-    return pairs.size() > size;
+    });
+    rebuild(&pool);
 }
 
-
-Collision::GridMap::GridMap()
+bool Collision::GridMap::has(Geometry::GeometryObject *object) const
 {
-
+    return _indexs.find(object) != _indexs.end();
 }
 
-Collision::GridMap::GridMap(const std::vector<Geometry::GeometryObject *> &objects)
-    : _objects(objects)
+void Collision::GridMap::clear()
 {
-    build(_objects);
+    _objects.clear();
+    _rects.clear();
+    _entries.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+    rebuild();
 }
 
-Collision::GridMap::GridMap(const std::initializer_list<Geometry::GeometryObject *> &objects)
-    : _objects(objects.begin(), objects.end())
+const Collision::GridMapConfig &Collision::GridMap::config() const
 {
-    build(_objects);
+    return _config;
 }
 
-Collision::GridMap::GridMap(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, 
-    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
-    : _objects(begin, end)
+void Collision::GridMap::set_config(const Collision::GridMapConfig &config)
 {
-    build(_objects);
+    _config = config;
+    rebuild();
 }
 
-void Collision::GridMap::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin, 
-    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+bool Collision::GridMap::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
 {
-    if (begin == end)
+    if (pos.x >= _left && pos.x <= _right && pos.y >= _bottom && pos.y <= _top)
     {
-        _left = _bottom = 0;
-        _right = _top = 100;
-        _rects.clear();
-        _objects.clear();
-        _grids.clear();
-        _grids.emplace_back(_left, _top, _right, _bottom);
-        return;
+        const Collision::GridMap::GridRange range = grid_range(Geometry::AABBRect(pos.x, pos.y, pos.x, pos.y));
+        return _grids[range.left * _rows + range.top].select(pos, objects);
     }
+    return false;
+}
 
-    _left = _bottom = DBL_MAX;
-    _right = _top = -DBL_MAX;
-    _rects.clear();
-    _objects.clear();
-    _grids.clear();
-    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+bool Collision::GridMap::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    if (rect.right() < _left || rect.left() > _right || rect.bottom() > _top || rect.top() < _bottom)
     {
-        _objects.push_back(*it);
-        _rects.emplace_back((*it)->bounding_rect());
-        _left = std::min(_rects.back().left(), _left);
-        _top = std::max(_rects.back().top(), _top);
-        _right = std::max(_rects.back().right(), _right);
-        _bottom = std::min(_rects.back().bottom(), _bottom);
+        return false;
     }
 
-    if (_objects.size() > 40 || (_right - _left) > 800)
+    const size_t size = objects.size();
+    const Collision::GridMap::GridRange range = grid_range(rect);
+    const size_t first_grid = range.left * _rows + range.top;
+    for (size_t i = range.left; i <= range.right; ++i)
     {
-        double x_step = (_right - _left) / 8, y_step = (_top - _bottom) / 4;
-        for (size_t i = 0; i < 8; ++i)
+        for (size_t j = range.top; j <= range.bottom; ++j)
         {
-            for (size_t j = 0; j < 4; ++j)
+            const size_t grid = i * _rows + j;
+            size_t count = objects.size();
+            _grids[grid].select(rect, objects);
+            // 只保留重叠区域左上角位于当前网格的对象
+            for (size_t k = count, end = objects.size(); k < end; ++k)
             {
-                _grids.emplace_back(_left + x_step * i, _top - y_step * j,
-                    _left + x_step * i + x_step, _top - y_step * j - y_step);
-
-                for (size_t k = 0, count = _rects.size(); k < count; ++k)
+                if (owner_grid(first_grid, _entries[_indexs.find(objects[k])->second].front().grid) == grid)
                 {
-                    if (Geometry::is_intersected(_grids.back().rect(), _rects[k]))
-                    {
-                        _grids.back().append(_objects[k]);
-                    }
+                    objects[count++] = objects[k];
                 }
             }
+            objects.resize(count);
         }
     }
-    else
-    {
-        _grids.emplace_back(_left, _top, _right, _bottom);
-        for (Geometry::GeometryObject *object : _objects)
-        {
-            _grids.back().append(object);
-        }
-    }
+    return objects.size() > size;
 }
 
-void Collision::GridMap::build(const std::vector<Geometry::GeometryObject *> &objects)
+bool Collision::GridMap::query_radius(const Geometry::Point &pos, const double radius,
+    std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
 {
-    if (objects.empty())
-    {
-        _left = _bottom = 0;
-        _right = _top = 100;
-        _rects.clear();
-        _objects.clear();
-        _grids.clear();
-        _grids.emplace_back(_left, _top, _right, _bottom);
-        return;
-    }
-
-    _left = _bottom = DBL_MAX;
-    _right = _top = -DBL_MAX;
-    _rects.clear();
-    _grids.clear();
-    for (Geometry::GeometryObject *object : objects)
-    {
-        _rects.emplace_back(object->bounding_rect());
-        _left = std::min(_rects.back().left(), _left);
-        _top = std::max(_rects.back().top(), _top);
-        _right = std::max(_rects.back().right(), _right);
-        _bottom = std::min(_rects.back().bottom(), _bottom);
-    }
-    if (&objects != &_objects)
+    const Geometry::AABBRect rect(pos.x - radius, pos.y + radius, pos.x + radius, pos.y - radius);
+    if (radius < 0 || rect.right() < _left || rect.left() > _right || rect.bottom() > _top || rect.top() < _bottom)
     {
-        _objects.assign(objects.begin(), objects.end());
+        return false;
     }
 
-    if (_objects.size() > 40 || (_right - _left) > 800)
+    const size_t size = objects.size();
+    const Collision::GridMap::GridRange range = grid_range(rect);
+    const size_t first_grid = range.left * _rows + range.top;
+    for (size_t i = range.left; i <= range.right; ++i)
     {
-        double x_step = (_right - _left) / 8, y_step = (_top - _bottom) / 4;
-        for (size_t i = 0; i < 8; ++i)
+        for (size_t j = range.top; j <= range.bottom; ++j)
         {
-            for (size_t j = 0; j < 4; ++j)
+            const size_t grid = i * _rows + j;
+            size_t count = objects.size();
+            _grids[grid].query_radius(pos, radius, objects);
+            // 只保留重叠区域左上角位于当前网格的对象
+            for (size_t k = count, end = objects.size(); k < end; ++k)
             {
-                _grids.emplace_back(_left + x_step * i, _top - y_step * j,
-                    _left + x_step * i + x_step, _top - y_step * j - y_step);
-
-                for (size_t k = 0, count = _rects.size(); k < count; ++k)
+                if (owner_grid(first_grid, _entries[_indexs.find(objects[k].first)->second].front().grid) == grid)
                 {
-                    if (Geometry::is_intersected(_grids.back().rect(), _rects[k]))
-                    {
-                        _grids.back().append(objects[k]);
-                    }
+                    objects[count++] = objects[k];
                 }
             }
+            objects.resize(count);
         }
     }
-    else
-    {
-        _grids.emplace_back(_left, _top, _right, _bottom);
-        for (Geometry::GeometryObject *object : _objects)
-        {
-            _grids.back().append(object);
-        }
-    }
+    std::sort(objects.begin() + size, objects.end(), Collision::is_nearer);
+    return objects.size() > size;
 }
 
-void Collision::GridMap::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
+bool Collision::GridMap::query_knn(const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
 {
-    if (objects.empty())
-    {
-        _left = _bottom = 0;
-        _right = _top = 100;
-        _rects.clear();
-        _objects.clear();
-        _grids.clear();
-        _grids.emplace_back(_left, _top, _right, _bottom);
-        return;
-    }
-
-    _left = _bottom = DBL_MAX;
-    _right = _top = -DBL_MAX;
-    _grids.clear();
-    for (const Geometry::AABBRect &rect : rects)
-    {
-        _left = std::min(rect.left(), _left);
-        _top = std::max(rect.top(), _top);
-        _right = std::max(rect.right(), _right);
-        _bottom = std::min(rect.bottom(), _bottom);
-    }
-    if (&objects != &_objects)
-    {
-        _objects.assign(objects.begin(), objects.end());
-        _rects.assign(rects.begin(), rects.end());
-    }
+    const size_t size = objects.size();
+    const double x_step = (_right - _left) / _columns, y_step = (_top - _bottom) / _rows;
+    const Collision::GridMap::GridRange center = grid_range(Geometry::AABBRect(pos.x, pos.y, pos.x, pos.y));
+    const size_t ci = center.left, ri = center.top;
 
-    if (objects.size() > 40 || (_right - _left) > 800)
+    // 对象只在其AABB矩形上距离pos最近的点所在的网格中检测,该网格的距离不大于对象的距离
+    const auto visit = [&](const size_t i, const size_t j)
     {
-        double x_step = (_right - _left) / 8, y_step = (_top - _bottom) / 4;
-        for (size_t i = 0; i < 8; ++i)
+        const size_t grid = i * _rows + j;
+        if (_grids[grid].size() == 0)
         {
-            for (size_t j = 0; j < 4; ++j)
-            {
-                _grids.emplace_back(_left + x_step * i, _top - y_step * j,
-                    _left + x_step * i + x_step, _top - y_step * j - y_step);
-
-                for (size_t k = 0, count = rects.size(); k < count; ++k)
-                {
-                    if (Geometry::is_intersected(_grids.back().rect(), rects[k]))
-                    {
-                        _grids.back().append(objects[k]);
-                    }
-                }
-            }
+            return;
         }
-    }
-    else
-    {
-        _grids.emplace_back(_left, _top, _right, _bottom);
-        for (Geometry::GeometryObject *object : objects)
+        const Geometry::AABBRect &rect = _grids[grid].rect();
+        if (Collision::distance(pos, rect.left(), rect.top(), rect.right(), rect.bottom()) > Collision::nearest_bound(objects, size, k))
         {
-            _grids.back().append(object);
+            return;
         }
-    }
-}
+        _grids[grid].query_knn(pos, k, size, objects, [&](const size_t index)
+            {
+                const Geometry::Point point = Collision::nearest_point(pos, _rects[index]);
+                const Collision::GridMap::GridRange range = grid_range(Geometry::AABBRect(point.x, point.y, point.x, point.y));
+                return range.left * _rows + range.top == grid;
+            });
+    };
 
-void Collision::GridMap::append(Geometry::GeometryObject *object)
-{
-    if (std::find(_objects.begin(), _objects.end(), object) != _objects.end())
+    // 以pos所在网格为中心逐圈向外扩展,第r圈由距中心网格切比雪夫距离为r的网格组成
+    visit(ci, ri);
+    for (size_t r = 1;; ++r)
     {
-        return;
-    }
+        const bool has_left = ci >= r, has_right = ci + r < _columns, has_top = ri >= r, has_bottom = ri + r < _rows;
+        if (!has_left && !has_right && !has_top && !has_bottom)
+        {
+            break;
+        }
 
-    _objects.push_back(object);
-    _rects.emplace_back(object->bounding_rect());
-    if (_rects.back().left() >= _left && _rects.back().right() <= _right
-        && _rects.back().top() <= _top && _rects.back().bottom() >= _bottom)
-    {
-        for (GridNode &grid : _grids)
+        // 第r圈的网格都位于四条边界之外,取仍有网格一侧的最小距离作为本圈的距离下界,该下界随r单调不减
+        double bound = DBL_MAX;
+        if (has_left)
         {
-            if (Geometry::is_intersected(grid.rect(), _rects.back()))
-            {
-                grid.append(object);
-            }
+            bound = std::min(bound, pos.x - (_left + (ci - r + 1) * x_step));
+        }
+        if (has_right)
+        {
+            bound = std::min(bound, _left + (ci + r) * x_step - pos.x);
+        }
+        if (has_top)
+        {
+            bound = std::min(bound, _top - (ri - r + 1) * y_step - pos.y);
+        }
+        if (has_bottom)
+        {
+            bound = std::min(bound, pos.y - (_top - (ri + r) * y_step));
+        }
+        if (bound > Collision::nearest_bound(objects, size, k))
+        {
+            break;
         }
-    }
-    else
-    {
-        _grids.clear();
-        _left = std::min(_left, _rects.back().left());
-        _top = std::max(_top, _rects.back().top());
-        _right = std::max(_right, _rects.back().right());
-        _bottom = std::min(_bottom, _rects.back().bottom());
 
-        if (_objects.size() > 40 || (_right - _left) > 800)
+        const size_t i0 = has_left ? ci - r : 0, i1 = has_right ? ci + r : _columns - 1;
+        const size_t j0 = has_top ? ri - r : 0, j1 = has_bottom ? ri + r : _rows - 1;
+        for (size_t i = i0; i <= i1; ++i)
         {
-            double x_step = (_right - _left) / 8, y_step = (_top - _bottom) / 4;
-            for (size_t i = 0; i < 8; ++i)
+            if ((has_left && i == i0) || (has_right && i == i1))
             {
-                for (size_t j = 0; j < 4; ++j)
+                for (size_t j = j0; j <= j1; ++j)
                 {
-                    _grids.emplace_back(_left + x_step * i, _top - y_step * j,
-                        _left + x_step * i + x_step, _top - y_step * j - y_step);
-
-                    for (size_t k = 0, count = _rects.size(); k < count; ++k)
-                    {
-                        if (Geometry::is_intersected(_grids.back().rect(), _rects[k]))
-                        {
-                            _grids.back().append(_objects[k]);
-                        }
-                    }
+                    visit(i, j);
                 }
             }
-        }
-        else
-        {
-            _grids.emplace_back(_left, _top, _right, _bottom);
-            for (Geometry::GeometryObject *object : _objects)
+            else
             {
-                _grids.back().append(object);
+                if (has_top)
+                {
+                    visit(i, j0);
+                }
+                if (has_bottom)
+                {
+                    visit(i, j1);
+                }
             }
         }
     }
+    Collision::sort_nearest(objects, size);
+    return objects.size() > size;
 }
 
-void Collision::GridMap::remove(Geometry::GeometryObject *object)
+const Collision::CollisionLayer &Collision::GridMap::layer(const Geometry::GeometryObject *object) const
 {
-    std::vector<Geometry::GeometryObject *>::iterator it = std::find(_objects.begin(), _objects.end(), object);
-    if (it == _objects.end())
-    {
-        return;
-    }
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(const_cast<Geometry::GeometryObject *>(object));
+    return it == _indexs.end() ? Collision::CollisionFilter::default_layer() : _filter.layer(it->second);
+}
 
-    for (GridNode &grid : _grids)
+void Collision::GridMap::set_layer(Geometry::GeometryObject *object, const Collision::CollisionLayer &layer)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(object);
+    if (it != _indexs.end())
     {
-        grid.remove(object);
+        _filter.set_layer(it->second, layer);
     }
-    _rects.erase(_rects.begin() + std::distance(_objects.begin(), it));
-    _objects.erase(it);
 }
 
-void Collision::GridMap::update(Geometry::GeometryObject *object)
+bool Collision::GridMap::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat) const
+{
+    Collision::CollisionStatistics statistics;
+    return find_collision_objects(object, objects, statistics, norepeat);
+}
+
+bool Collision::GridMap::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects,
+    Collision::CollisionStatistics &statistics, const bool norepeat) const
 {
-    std::vector<Geometry::GeometryObject *>::iterator it = std::find(_objects.begin(), _objects.end(), object);
-    if (it == _objects.end())
+    if (object == nullptr)
     {
-        return;
+        return false;
     }
 
-    const size_t index = std::distance(_objects.begin(), it);
-    _rects[index] = object->bounding_rect();
-    if (_rects[index].left() >= _left && _rects[index].right() <= _right
-        && _rects[index].top() <= _top && _rects[index].bottom() >= _bottom)
+    const size_t size = objects.size();
+    const Geometry::AABBRect rect(object->bounding_rect());
+    if (rect.right() < _left || rect.left() > _right || rect.bottom() > _top || rect.top() < _bottom)
+    {
+        return false;
+    }
+    const Collision::CollisionLayer &layer = this->layer(object);
+    const Collision::GridMap::GridRange range = grid_range(rect);
+    if (!norepeat)
     {
-        for (GridNode &grid : _grids)
+        for (size_t i = range.left; i <= range.right; ++i)
         {
-            if (Geometry::is_intersected(grid.rect(), _rects[index]))
-            {
-                grid.append(object);
-            }
-            else
+            for (size_t j = range.top; j <= range.bottom; ++j)
             {
-                grid.remove(object);
+                _grids[i * _rows + j].find_collision_objects(object, rect, layer, _filter, objects, statistics);
             }
         }
+        return objects.size() > size;
     }
-    else
+
+    const size_t first_grid = range.left * _rows + range.top;
+    std::vector<size_t> positions;
+    for (size_t i = range.left; i <= range.right; ++i)
     {
-        _grids.clear();
-        build(_objects, _rects);
+        for (size_t j = range.top; j <= range.bottom; ++j)
+        {
+            const size_t grid = i * _rows + j;
+            const GridNode &node = _grids[grid];
+            const size_t num = node.filter(rect.left(), rect.top(), rect.right(), rect.bottom(), 0, positions);
+            statistics.candidates += node.size();
+            statistics.aabb_rejected += node.size() - num;
+            for (const size_t pos : positions)
+            {
+                const size_t index = node.index(pos);
+                const Geometry::GeometryObject *obj = _objects[index];
+                if (obj == object)
+                {
+                    --statistics.candidates;
+                }
+                else if (owner_grid(first_grid, _entries[index].front().grid) != grid)
+                {
+                    ++statistics.repeat_rejected;
+                }
+                else if (!_filter.accepts(layer, index))
+                {
+                    ++statistics.layer_rejected;
+                }
+                else if (Collision::gjk(obj, object))
+                {
+                    objects.push_back(_objects[index]);
+                }
+                else
+                {
+                    ++statistics.gjk_rejected;
+                }
+            }
+        }
     }
+    return objects.size() > size;
 }
 
-void Collision::GridMap::update()
-{
-    _grids.clear();
-    build(_objects, _rects);
-}
-
-bool Collision::GridMap::has(Geometry::GeometryObject *object) const
-{
-    return std::find(_objects.begin(), _objects.end(), object) != _objects.end();
-}
-
-void Collision::GridMap::clear()
-{
-    _objects.clear();
-    _rects.clear();
-    _grids.clear();
-}
-
-bool Collision::GridMap::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
+void Collision::GridMap::find_collision_pairs(const size_t grid, const size_t begin, const size_t end, const bool norepeat, const bool narrow,
+    std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, std::vector<size_t> &positions,
+    Collision::CollisionStatistics &statistics) const
 {
-    if (pos.x >= _left && pos.x <= _right && pos.y >= _bottom && pos.y <= _top)
+    // 同时位于多个网格中的一对对象只由其共同覆盖范围左上角的网格记录
+    const GridNode &node = _grids[grid];
+    for (size_t i = begin, count = node.size(); i < end; ++i)
     {
-        for (const GridNode &grid : _grids)
+        const size_t index0 = node.index(i);
+        const Geometry::AABBRect &rect = _rects[index0];
+        const size_t num = node.filter(rect.left(), rect.top(), rect.right(), rect.bottom(), i + 1, positions);
+        statistics.candidates += count - i - 1;
+        statistics.aabb_rejected += count - i - 1 - num;
+        const size_t first_grid = _entries[index0].front().grid;
+        const Geometry::GeometryObject *object0 = _objects[index0];
+        for (const size_t j : positions)
         {
-            if (Geometry::is_inside(pos, grid.rect()))
+            const size_t index1 = node.index(j);
+            const Geometry::GeometryObject *object1 = _objects[index1];
+            if (norepeat && owner_grid(first_grid, _entries[index1].front().grid) != grid)
+            {
+                ++statistics.repeat_rejected;
+            }
+            else if (!_filter.accepts(index0, index1))
             {
-                return grid.select(pos, objects);
+                ++statistics.layer_rejected;
+            }
+            else if (!narrow || Collision::gjk(object0, object1))
+            {
+                pairs.emplace_back(_objects[index0], _objects[index1]);
+            }
+            else
+            {
+                ++statistics.gjk_rejected;
             }
         }
     }
-    return false;
 }
 
-bool Collision::GridMap::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
+bool Collision::GridMap::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
 {
-    if (rect.right() < _left || rect.left() > _right || rect.bottom() > _top || rect.top() < _bottom)
-    {
-        return false;
-    }
+    Collision::CollisionStatistics statistics;
+    return find_collision_pairs(pairs, statistics, norepeat);
+}
 
-    const size_t size = objects.size();
-    for (const GridNode &grid : _grids)
+bool Collision::GridMap::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    Collision::CollisionStatistics &statistics, const bool norepeat) const
+{
+    const size_t size = pairs.size();
+    std::vector<size_t> positions;
+    for (size_t i = 0, count = _grids.size(); i < count; ++i)
     {
-        if (Geometry::is_intersected(rect, grid.rect()))
-        {
-            grid.select(rect, objects);
-        }
+        find_collision_pairs(i, 0, _grids[i].size(), norepeat, true, pairs, positions, statistics);
     }
-    std::set<Geometry::GeometryObject *> temp(objects.begin(), objects.end());
-    objects.assign(temp.begin(), temp.end());
-    return objects.size() > size;
+    return pairs.size() > size;
 }
 
-bool Collision::GridMap::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat) const
+bool Collision::GridMap::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    Collision::ThreadPool &pool, const bool norepeat) const
 {
-    if (object == nullptr)
-    {
-        return false;
-    }
+    Collision::CollisionStatistics statistics;
+    return find_collision_pairs(pairs, pool, statistics, norepeat);
+}
 
-    const size_t size = objects.size();
-    const Geometry::AABBRect rect(object->bounding_rect());
+bool Collision::GridMap::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    Collision::ThreadPool &pool, Collision::CollisionStatistics &statistics, const bool norepeat) const
+{
+    std::vector<size_t> sizes;
     for (const GridNode &grid : _grids)
     {
-        if (Geometry::is_intersected(rect, grid.rect()))
-        {
-            grid.find_collision_objects(object, objects);
-        }
+        sizes.push_back(grid.size());
     }
+    std::vector<Collision::PairTask> tasks;
+    Collision::split_pair_tasks(sizes, pool.size(), tasks);
 
-    if (norepeat)
+    // 每个任务的结果单独存放,按任务顺序合并后与串行结果完全一致
+    std::vector<std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>>> results(tasks.size());
+    std::vector<std::vector<size_t>> positions(pool.size());
+    std::vector<Collision::CollisionStatistics> thread_statistics(pool.size());
+    pool.run(tasks.size(), [&](const size_t task, const size_t thread)
+        {
+            find_collision_pairs(tasks[task].node, tasks[task].begin, tasks[task].end, norepeat, true,
+                results[task], positions[thread], thread_statistics[thread]);
+        });
+
+    const size_t size = pairs.size();
+    for (const std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &result : results)
     {
-        std::set<Geometry::GeometryObject *> temp(objects.begin(), objects.end());
-        objects.assign(temp.begin(), temp.end());
+        pairs.insert(pairs.end(), result.begin(), result.end());
     }
-    return objects.size() > size;
+    for (const Collision::CollisionStatistics &value : thread_statistics)
+    {
+        statistics += value;
+    }
+    return pairs.size() > size;
 }
 
-bool Collision::GridMap::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+bool Collision::GridMap::find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
 {
     const size_t size = pairs.size();
-    for (const GridNode &grid : _grids)
+    std::vector<size_t> positions;
+    Collision::CollisionStatistics statistics;
+    for (size_t i = 0, count = _grids.size(); i < count; ++i)
     {
-        grid.find_collision_pairs(pairs);
+        find_collision_pairs(i, 0, _grids[i].size(), true, false, pairs, positions, statistics);
     }
+    return pairs.size() > size;
+}
 
-    if (norepeat)
+bool Collision::GridMap::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, Collision::RaycastHit &hit) const
+{
+    hit = Collision::RaycastHit();
+    hit.t = max_t;
+    traverse(origin, dir, max_t, [&](const size_t grid, const double leave)
     {
-        for (size_t i = 0, count = pairs.size(); i < count; ++i)
-        {
-            for (size_t j = count - 1; j > i; --j)
-            {
-                if ((pairs[i].first == pairs[j].first && pairs[i].second == pairs[j].second)
-                    || (pairs[i].first == pairs[j].second && pairs[i].second == pairs[j].first))
-                {
-                    pairs.erase(pairs.begin() + j);
-                    --count;
-                }
-            }
-        }
-    }
+        // 之后的网格中的交点都不早于leave
+        _grids[grid].raycast(origin, dir, hit);
+        return hit.object != nullptr && hit.t <= leave;
+    });
+    return hit.object != nullptr;
+}
 
-    return pairs.size() > size;
+bool Collision::GridMap::raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    std::vector<Collision::RaycastHit> &hits) const
+{
+    const size_t size = hits.size();
+    traverse(origin, dir, max_t, [&](const size_t grid, const double)
+    {
+        _grids[grid].raycast_all(origin, dir, max_t, hits);
+        return false;
+    });
+    Collision::sort_raycast_hits(hits, size);
+    return hits.size() > size;
 }
\ No newline at end of file
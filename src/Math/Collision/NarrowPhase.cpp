@@ -0,0 +1,197 @@
+#include "Math/Collision/NarrowPhase.hpp"
+#include "Math/Collision/Algorithm.hpp"
+
+// MSVC的/arch:AVX2同时定义__AVX__,x64默认支持SSE2,其他平台使用逐个检测
+#if defined(__AVX__)
+#include <immintrin.h>
+#define NARROW_PHASE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NARROW_PHASE_SSE2
+#endif
+
+
+using namespace ToyGameEngine::Math;
+
+// 每次打包的碰撞对数量,打包数组放在栈上并反复使用,避免为全部碰撞对分配内存
+static constexpr size_t BATCH_SIZE = 256;
+
+// 圆与圆碰撞对的坐标与半径,indexs为碰撞对在results中的下标
+struct CircleBatch
+{
+    double x0[BATCH_SIZE], y0[BATCH_SIZE], radius0[BATCH_SIZE], x1[BATCH_SIZE], y1[BATCH_SIZE], radius1[BATCH_SIZE];
+    size_t indexs[BATCH_SIZE];
+    size_t count = 0;
+
+    // 打包数组已满时返回true
+    bool append(const Geometry::Circle &circle0, const Geometry::Circle &circle1, const size_t index)
+    {
+        x0[count] = circle0.x;
+        y0[count] = circle0.y;
+        radius0[count] = circle0.radius;
+        x1[count] = circle1.x;
+        y1[count] = circle1.y;
+        radius1[count] = circle1.radius;
+        indexs[count] = index;
+        return ++count == BATCH_SIZE;
+    }
+};
+
+// AABB矩形与AABB矩形碰撞对的边界
+struct RectBatch
+{
+    double left0[BATCH_SIZE], top0[BATCH_SIZE], right0[BATCH_SIZE], bottom0[BATCH_SIZE];
+    double left1[BATCH_SIZE], top1[BATCH_SIZE], right1[BATCH_SIZE], bottom1[BATCH_SIZE];
+    size_t indexs[BATCH_SIZE];
+    size_t count = 0;
+
+    bool append(const Geometry::AABBRect &rect0, const Geometry::AABBRect &rect1, const size_t index)
+    {
+        left0[count] = rect0.left();
+        top0[count] = rect0.top();
+        right0[count] = rect0.right();
+        bottom0[count] = rect0.bottom();
+        left1[count] = rect1.left();
+        top1[count] = rect1.top();
+        right1[count] = rect1.right();
+        bottom1[count] = rect1.bottom();
+        indexs[count] = index;
+        return ++count == BATCH_SIZE;
+    }
+};
+
+// mask的低count位为从start开始的检测结果
+static void write_mask(const size_t *indexs, const size_t start, const size_t count, const int mask, std::vector<unsigned char> &results)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[indexs[start + i]] = (mask >> i) & 1;
+    }
+}
+
+// 与gjk(Circle, Circle)相同,圆心距离不大于半径之和时相交
+static void run_circle_batch(CircleBatch &batch, std::vector<unsigned char> &results)
+{
+    const size_t count = batch.count;
+    size_t i = 0;
+#if defined(NARROW_PHASE_AVX)
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(batch.x0 + i), _mm256_loadu_pd(batch.x1 + i));
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(batch.y0 + i), _mm256_loadu_pd(batch.y1 + i));
+        const __m256d radius = _mm256_add_pd(_mm256_loadu_pd(batch.radius0 + i), _mm256_loadu_pd(batch.radius1 + i));
+        const __m256d length = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        write_mask(batch.indexs, i, 4, _mm256_movemask_pd(_mm256_cmp_pd(length, _mm256_mul_pd(radius, radius), _CMP_LE_OQ)), results);
+    }
+#elif defined(NARROW_PHASE_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128d dx = _mm_sub_pd(_mm_loadu_pd(batch.x0 + i), _mm_loadu_pd(batch.x1 + i));
+        const __m128d dy = _mm_sub_pd(_mm_loadu_pd(batch.y0 + i), _mm_loadu_pd(batch.y1 + i));
+        const __m128d radius = _mm_add_pd(_mm_loadu_pd(batch.radius0 + i), _mm_loadu_pd(batch.radius1 + i));
+        const __m128d length = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        write_mask(batch.indexs, i, 2, _mm_movemask_pd(_mm_cmple_pd(length, _mm_mul_pd(radius, radius))), results);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const double dx = batch.x0[i] - batch.x1[i], dy = batch.y0[i] - batch.y1[i], radius = batch.radius0[i] + batch.radius1[i];
+        results[batch.indexs[i]] = dx * dx + dy * dy <= radius * radius;
+    }
+    batch.count = 0;
+}
+
+// 两个区间在x与y方向上都有重叠时相交,边界接触也视为相交
+static void run_rect_batch(RectBatch &batch, std::vector<unsigned char> &results)
+{
+    const size_t count = batch.count;
+    size_t i = 0;
+#if defined(NARROW_PHASE_AVX)
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m256d x = _mm256_and_pd(
+            _mm256_cmp_pd(_mm256_loadu_pd(batch.left0 + i), _mm256_loadu_pd(batch.right1 + i), _CMP_LE_OQ),
+            _mm256_cmp_pd(_mm256_loadu_pd(batch.left1 + i), _mm256_loadu_pd(batch.right0 + i), _CMP_LE_OQ));
+        const __m256d y = _mm256_and_pd(
+            _mm256_cmp_pd(_mm256_loadu_pd(batch.bottom0 + i), _mm256_loadu_pd(batch.top1 + i), _CMP_LE_OQ),
+            _mm256_cmp_pd(_mm256_loadu_pd(batch.bottom1 + i), _mm256_loadu_pd(batch.top0 + i), _CMP_LE_OQ));
+        write_mask(batch.indexs, i, 4, _mm256_movemask_pd(_mm256_and_pd(x, y)), results);
+    }
+#elif defined(NARROW_PHASE_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        const __m128d x = _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(batch.left0 + i), _mm_loadu_pd(batch.right1 + i)),
+            _mm_cmple_pd(_mm_loadu_pd(batch.left1 + i), _mm_loadu_pd(batch.right0 + i)));
+        const __m128d y = _mm_and_pd(_mm_cmple_pd(_mm_loadu_pd(batch.bottom0 + i), _mm_loadu_pd(batch.top1 + i)),
+            _mm_cmple_pd(_mm_loadu_pd(batch.bottom1 + i), _mm_loadu_pd(batch.top0 + i)));
+        write_mask(batch.indexs, i, 2, _mm_movemask_pd(_mm_and_pd(x, y)), results);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        results[batch.indexs[i]] = batch.left0[i] <= batch.right1[i] && batch.left1[i] <= batch.right0[i]
+            && batch.bottom0[i] <= batch.top1[i] && batch.bottom1[i] <= batch.top0[i];
+    }
+    batch.count = 0;
+}
+
+// results[i - begin]为pairs[i]的检测结果
+static void batch_gjk(const std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const size_t begin,
+    std::vector<unsigned char> &results)
+{
+    results.assign(pairs.size() - begin, 0);
+    CircleBatch circles;
+    RectBatch rects;
+    for (size_t i = begin, count = pairs.size(); i < count; ++i)
+    {
+        const Geometry::GeometryObject *object0 = pairs[i].first, *object1 = pairs[i].second;
+        const Geometry::Type type0 = object0->type(), type1 = object1->type();
+        if (type0 == Geometry::Type::CIRCLE && type1 == Geometry::Type::CIRCLE)
+        {
+            if (circles.append(*static_cast<const Geometry::Circle *>(object0), *static_cast<const Geometry::Circle *>(object1), i - begin))
+            {
+                run_circle_batch(circles, results);
+            }
+        }
+        else if (type0 == Geometry::Type::AABBRECT && type1 == Geometry::Type::AABBRECT
+            && !static_cast<const Geometry::AABBRect *>(object0)->empty() && !static_cast<const Geometry::AABBRect *>(object1)->empty())
+        {
+            if (rects.append(*static_cast<const Geometry::AABBRect *>(object0), *static_cast<const Geometry::AABBRect *>(object1), i - begin))
+            {
+                run_rect_batch(rects, results);
+            }
+        }
+        else
+        {
+            results[i - begin] = Collision::gjk(object0, object1);
+        }
+    }
+    // 剩余不足BATCH_SIZE的碰撞对
+    run_circle_batch(circles, results);
+    run_rect_batch(rects, results);
+}
+
+void Collision::batch_gjk(const std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, std::vector<unsigned char> &results)
+{
+    ::batch_gjk(pairs, 0, results);
+}
+
+bool Collision::filter_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const size_t begin)
+{
+    if (begin >= pairs.size())
+    {
+        return false;
+    }
+    std::vector<unsigned char> results;
+    ::batch_gjk(pairs, begin, results);
+    size_t index = begin;
+    for (size_t i = begin, count = pairs.size(); i < count; ++i)
+    {
+        if (results[i - begin])
+        {
+            pairs[index++] = pairs[i];
+        }
+    }
+    pairs.resize(index);
+    return pairs.size() > begin;
+}
\ No newline at end of file
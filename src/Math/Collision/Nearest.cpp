@@ -0,0 +1,133 @@
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "Math/Collision/Nearest.hpp"
+#include "Math/Geometry/Algorithm.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+double Collision::distance(const Geometry::Point &pos, const Geometry::GeometryObject *object)
+{
+    switch (object->type())
+    {
+    case Geometry::Type::POLYGON:
+        {
+            const Geometry::Polygon &polygon = *static_cast<const Geometry::Polygon *>(object);
+            return Geometry::is_inside(pos, polygon, true) ? 0 : Geometry::distance(pos, polygon);
+        }
+    case Geometry::Type::RECTANGLE:
+    case Geometry::Type::AABBRECT:
+    case Geometry::Type::SQUARE:
+        {
+            const Geometry::Rectangle &rect = *static_cast<const Geometry::Rectangle *>(object);
+            return Geometry::is_inside(pos, rect, true) ? 0 : Geometry::distance(pos, rect);
+        }
+    case Geometry::Type::TRIANGLE:
+        {
+            const Geometry::Triangle &triangle = *static_cast<const Geometry::Triangle *>(object);
+            if (Geometry::is_inside(pos, triangle, true))
+            {
+                return 0;
+            }
+            return std::min(Geometry::distance(pos, triangle[0], triangle[1]),
+                std::min(Geometry::distance(pos, triangle[1], triangle[2]), Geometry::distance(pos, triangle[2], triangle[0])));
+        }
+    case Geometry::Type::CIRCLE:
+        {
+            const Geometry::Circle &circle = *static_cast<const Geometry::Circle *>(object);
+            return std::max(Geometry::distance(pos, static_cast<const Geometry::Point &>(circle)) - circle.radius, 0.0);
+        }
+    case Geometry::Type::POLYLINE:
+        return Geometry::distance(pos, *static_cast<const Geometry::Polyline *>(object));
+    case Geometry::Type::BEZIER:
+        return Geometry::distance(pos, static_cast<const Geometry::Bezier *>(object)->shape());
+    case Geometry::Type::LINE:
+        return Geometry::distance(pos, *static_cast<const Geometry::Line *>(object));
+    case Geometry::Type::POINT:
+        return Geometry::distance(pos, *static_cast<const Geometry::Point *>(object));
+    default:
+        return DBL_MAX;
+    }
+}
+
+double Collision::distance(const Geometry::Point &pos, const double left, const double top, const double right, const double bottom)
+{
+    const double dx = std::max(std::max(left - pos.x, pos.x - right), 0.0), dy = std::max(std::max(bottom - pos.y, pos.y - top), 0.0);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+Geometry::Point Collision::nearest_point(const Geometry::Point &pos, const Geometry::AABBRect &rect)
+{
+    return Geometry::Point(std::clamp(pos.x, rect.left(), rect.right()), std::clamp(pos.y, rect.bottom(), rect.top()));
+}
+
+bool Collision::is_nearer(const std::pair<Geometry::GeometryObject *, double> &object0, const std::pair<Geometry::GeometryObject *, double> &object1)
+{
+    return object0.second < object1.second;
+}
+
+void Collision::push_nearest(std::vector<std::pair<Geometry::GeometryObject *, double>> &objects, const size_t begin, const size_t k,
+    Geometry::GeometryObject *object, const double distance)
+{
+    if (k == 0 || (objects.size() - begin == k && distance >= objects[begin].second))
+    {
+        return;
+    }
+    if (objects.size() - begin == k)
+    {
+        std::pop_heap(objects.begin() + begin, objects.end(), Collision::is_nearer);
+        objects.back().first = object;
+        objects.back().second = distance;
+    }
+    else
+    {
+        objects.emplace_back(object, distance);
+    }
+    std::push_heap(objects.begin() + begin, objects.end(), Collision::is_nearer);
+}
+
+double Collision::nearest_bound(const std::vector<std::pair<Geometry::GeometryObject *, double>> &objects, const size_t begin, const size_t k)
+{
+    return objects.size() - begin < k ? DBL_MAX : (k == 0 ? -1 : objects[begin].second);
+}
+
+void Collision::sort_nearest(std::vector<std::pair<Geometry::GeometryObject *, double>> &objects, const size_t begin)
+{
+    std::sort_heap(objects.begin() + begin, objects.end(), Collision::is_nearer);
+}
+
+bool Collision::query_radius(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+    const Geometry::Point &pos, const double radius, std::vector<std::pair<Geometry::GeometryObject *, double>> &result)
+{
+    const size_t size = result.size();
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        if (objects[i] != nullptr && Collision::distance(pos, rects[i].left(), rects[i].top(), rects[i].right(), rects[i].bottom()) <= radius)
+        {
+            const double value = Collision::distance(pos, objects[i]);
+            if (value <= radius)
+            {
+                result.emplace_back(objects[i], value);
+            }
+        }
+    }
+    std::sort(result.begin() + size, result.end(), Collision::is_nearer);
+    return result.size() > size;
+}
+
+bool Collision::query_knn(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+    const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &result)
+{
+    const size_t size = result.size();
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        if (objects[i] != nullptr
+            && Collision::distance(pos, rects[i].left(), rects[i].top(), rects[i].right(), rects[i].bottom()) <= Collision::nearest_bound(result, size, k))
+        {
+            Collision::push_nearest(result, size, k, objects[i], Collision::distance(pos, objects[i]));
+        }
+    }
+    Collision::sort_nearest(result, size);
+    return result.size() > size;
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include <cstdint>
+#include <algorithm>
+#include "Math/Collision/PairCache.hpp"
+#include "Math/Collision/Algorithm.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+bool Collision::PairCache::PairKey::operator==(const Collision::PairCache::PairKey &key) const
+{
+    return object0 == key.object0 && object1 == key.object1;
+}
+
+size_t Collision::PairCache::PairKeyHash::operator()(const Collision::PairCache::PairKey &key) const
+{
+    unsigned long long value = static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(key.object0)) * 0x9E3779B97F4A7C15ULL;
+    value ^= static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(key.object1)) + 0x7F4A7C159E3779B9ULL + (value << 6) + (value >> 2);
+    return static_cast<size_t>(value ^ (value >> 32));
+}
+
+Collision::PairCache::PairKey Collision::PairCache::make_key(const Geometry::GeometryObject *object0, const Geometry::GeometryObject *object1)
+{
+    Collision::PairCache::PairKey key;
+    if (object0 < object1)
+    {
+        key.object0 = object0;
+        key.object1 = object1;
+    }
+    else
+    {
+        key.object0 = object1;
+        key.object1 = object0;
+    }
+    return key;
+}
+
+size_t Collision::PairCache::refresh(const Geometry::GeometryObject *object)
+{
+    Collision::PairCache::Proxy &proxy = _proxies[object];
+    if (proxy.frame == _frame)
+    {
+        return proxy.version;
+    }
+
+    const Geometry::AABBRect rect(object->bounding_rect());
+    if (proxy.frame == 0 || rect.left() < proxy.left || rect.top() > proxy.top
+        || rect.right() > proxy.right || rect.bottom() < proxy.bottom)
+    {
+        const double margin = std::max(rect.right() - rect.left(), rect.top() - rect.bottom()) * _margin;
+        proxy.left = rect.left() - margin;
+        proxy.top = rect.top() + margin;
+        proxy.right = rect.right() + margin;
+        proxy.bottom = rect.bottom() - margin;
+        proxy.version = ++_version;
+    }
+    proxy.frame = _frame;
+    return proxy.version;
+}
+
+void Collision::PairCache::update(const std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &candidates,
+    std::vector<Collision::ContactEvent> &events)
+{
+    ++_frame;
+    _gjk_count = 0;
+    Collision::ContactEvent event;
+    for (const std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *> &candidate : candidates)
+    {
+        const Collision::PairCache::PairKey key = make_key(candidate.first, candidate.second);
+        std::unordered_map<Collision::PairCache::PairKey, size_t, Collision::PairCache::PairKeyHash>::iterator it = _indexs.find(key);
+        size_t index = 0;
+        bool touching = false;
+        if (it == _indexs.end())
+        {
+            if (_free_indexs.empty())
+            {
+                index = _pairs.size();
+                _pairs.emplace_back();
+            }
+            else
+            {
+                index = _free_indexs.back();
+                _free_indexs.pop_back();
+            }
+            _indexs[key] = index;
+            Collision::PairCache::PairEntry &entry = _pairs[index];
+            entry.object0 = candidate.first;
+            entry.object1 = candidate.second;
+            entry.version0 = refresh(entry.object0);
+            entry.version1 = refresh(entry.object1);
+            entry.touching = false;
+            entry.used = true;
+            entry.gjk_cache.clear();
+            touching = Collision::gjk(static_cast<const Geometry::GeometryObject *>(entry.object0),
+                static_cast<const Geometry::GeometryObject *>(entry.object1), entry.gjk_cache);
+            ++_gjk_count;
+        }
+        else
+        {
+            index = it->second;
+            Collision::PairCache::PairEntry &entry = _pairs[index];
+            if (entry.frame == _frame)
+            {
+                continue;
+            }
+            const size_t version0 = refresh(entry.object0), version1 = refresh(entry.object1);
+            if (version0 == entry.version0 && version1 == entry.version1)
+            {
+                touching = entry.touching;
+            }
+            else
+            {
+                entry.version0 = version0;
+                entry.version1 = version1;
+                touching = Collision::gjk(static_cast<const Geometry::GeometryObject *>(entry.object0),
+                    static_cast<const Geometry::GeometryObject *>(entry.object1), entry.gjk_cache);
+                ++_gjk_count;
+            }
+        }
+
+        Collision::PairCache::PairEntry &entry = _pairs[index];
+        entry.frame = _frame;
+        if (touching || entry.touching)
+        {
+            event.id = index;
+            event.object0 = entry.object0;
+            event.object1 = entry.object1;
+            event.state = touching ? (entry.touching ? Collision::ContactState::STAY : Collision::ContactState::BEGIN) : Collision::ContactState::END;
+            events.push_back(event);
+        }
+        entry.touching = touching;
+    }
+
+    // 本帧不再是候选的碰撞对,接触中的输出结束事件
+    for (size_t i = 0, count = _pairs.size(); i < count; ++i)
+    {
+        Collision::PairCache::PairEntry &entry = _pairs[i];
+        if (!entry.used || entry.frame == _frame)
+        {
+            continue;
+        }
+        if (entry.touching)
+        {
+            event.id = i;
+            event.object0 = entry.object0;
+            event.object1 = entry.object1;
+            event.state = Collision::ContactState::END;
+            events.push_back(event);
+        }
+        _indexs.erase(make_key(entry.object0, entry.object1));
+        entry = Collision::PairCache::PairEntry();
+        _free_indexs.push_back(i);
+    }
+
+    for (std::unordered_map<const Geometry::GeometryObject *, Collision::PairCache::Proxy>::iterator it = _proxies.begin(); it != _proxies.end();)
+    {
+        if (it->second.frame == _frame)
+        {
+            ++it;
+        }
+        else
+        {
+            it = _proxies.erase(it);
+        }
+    }
+}
+
+void Collision::PairCache::clear()
+{
+    _pairs.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _proxies.clear();
+    _gjk_count = 0;
+}
+
+size_t Collision::PairCache::size() const
+{
+    return _indexs.size();
+}
+
+double Collision::PairCache::margin() const
+{
+    return _margin;
+}
+
+void Collision::PairCache::set_margin(const double value)
+{
+    _margin = std::max(value, 0.0);
+    _proxies.clear();
+}
+
+size_t Collision::PairCache::gjk_count() const
+{
+    return _gjk_count;
+}
\ No newline at end of file
@@ -1,611 +1,1338 @@
-#include <set>
+#include <cfloat>
+#include <algorithm>
+#include <functional>
 #include "Math/Collision/QuadTree.hpp"
+#include "Math/Collision/Algorithm.hpp"
 #include "Math/Geometry/Algorithm.hpp"
 
 
 using namespace ToyGameEngine::Math;
 
-Collision::QuadTreeNode::QuadTreeNode()
+static bool is_overlapped(const Geometry::AABBRect &rect0, const Geometry::AABBRect &rect1)
+{
+    return rect0.left() <= rect1.right() && rect0.right() >= rect1.left()
+        && rect0.bottom() <= rect1.top() && rect0.top() >= rect1.bottom();
+}
+
+Collision::QuadTree::QuadTree(const Collision::QuadTreeConfig &config)
+    : _config(config)
 {
 
 }
 
-Collision::QuadTreeNode::QuadTreeNode(const Geometry::AABBRect &rect)
-    : Collision::GridNode(rect)
+Collision::QuadTree::QuadTree(const std::vector<Geometry::GeometryObject *> &objects, const Collision::QuadTreeConfig &config)
+    : _config(config)
 {
+    build(objects);
+}
 
+Collision::QuadTree::QuadTree(const std::initializer_list<Geometry::GeometryObject *> &objects, const Collision::QuadTreeConfig &config)
+    : _config(config)
+{
+    build(std::vector<Geometry::GeometryObject *>(objects.begin(), objects.end()));
 }
 
-Collision::QuadTreeNode::QuadTreeNode(const double left, const double top, const double right, const double bottom)
-    : Collision::GridNode(left, top, right, bottom)
+Collision::QuadTree::QuadTree(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end, const Collision::QuadTreeConfig &config)
+    : _config(config)
 {
+    build(begin, end);
+}
 
+bool Collision::QuadTree::is_overlapped(const Collision::QuadTree::Node &node, const Geometry::AABBRect &rect) const
+{
+    const double dx = (node.right - node.left) * _config.looseness, dy = (node.top - node.bottom) * _config.looseness;
+    return node.left - dx <= rect.right() && node.right + dx >= rect.left()
+        && node.bottom - dy <= rect.top() && node.top + dy >= rect.bottom();
 }
 
-Collision::QuadTreeNode::~QuadTreeNode()
+bool Collision::QuadTree::is_contained(const Collision::QuadTree::Node &node, const Geometry::AABBRect &rect) const
 {
-    if (_nodes[0] != nullptr)
-    {
-        Collision::QuadTreeNode *node;
-        std::vector<Collision::QuadTreeNode*> nodes({_nodes[0], _nodes[1], _nodes[2], _nodes[3]});
-        while (!nodes.empty())
-        {
-            node = nodes.back();
-            nodes.pop_back();
-            if (node->_nodes[0] != nullptr)
-            {
-                nodes.push_back(node->_nodes[0]);
-                nodes.push_back(node->_nodes[1]);
-                nodes.push_back(node->_nodes[2]);
-                nodes.push_back(node->_nodes[3]);
-            }
-            node->_nodes[0] = nullptr;
-            delete node;
-        }   
-    }
+    const double dx = (node.right - node.left) * _config.looseness, dy = (node.top - node.bottom) * _config.looseness;
+    return node.left - dx <= rect.left() && node.right + dx >= rect.right()
+        && node.bottom - dy <= rect.bottom() && node.top + dy >= rect.top();
+}
+
+bool Collision::QuadTree::raycast(const Collision::QuadTree::Node &node, const Geometry::Point &origin, const Geometry::Vector &dir,
+    const double max_t, double &enter) const
+{
+    const double dx = (node.right - node.left) * _config.looseness, dy = (node.top - node.bottom) * _config.looseness;
+    double exit;
+    return Collision::raycast(origin, dir, max_t, node.left - dx, node.top + dy, node.right + dx, node.bottom - dy, enter, exit);
+}
+
+double Collision::QuadTree::distance(const Collision::QuadTree::Node &node, const Geometry::Point &pos) const
+{
+    const double dx = (node.right - node.left) * _config.looseness, dy = (node.top - node.bottom) * _config.looseness;
+    return Collision::distance(pos, node.left - dx, node.top + dy, node.right + dx, node.bottom - dy);
+}
+
+uint32_t Collision::QuadTree::child(const uint32_t node, const Geometry::Point &pos) const
+{
+    const uint32_t children = _nodes[node].children;
+    return children + (pos.x < _nodes[children].right ? 0 : 1) + (pos.y > _nodes[children].bottom ? 0 : 2);
+}
+
+bool Collision::QuadTree::need_split(const Collision::QuadTree::Node &node, const size_t depth) const
+{
+    return depth < _config.max_depth && node.right - node.left >= _config.min_size * 2 && node.top - node.bottom >= _config.min_size * 2
+        && node.count >= node.unsplit * 2 && (node.count > _config.max_objects || (node.count > _config.min_objects && node.right - node.left > _config.split_width));
+}
+
+bool Collision::QuadTree::can_merge(const Collision::QuadTree::Node &node, const size_t count) const
+{
+    return count < _config.min_objects || (count <= _config.max_objects && node.right - node.left <= _config.split_width);
 }
 
-void Collision::QuadTreeNode::split()
+bool Collision::QuadTree::is_owner(const Collision::QuadTree::Node &node, const Geometry::Point &pos) const
 {
-    const double left = _rect.left(), top = _rect.top(),
-        right = _rect.right(), bottom = _rect.bottom();
-    _nodes[0] = new QuadTreeNode(left, top, (left + right) / 2, (top + bottom) / 2);
-    _nodes[1] = new QuadTreeNode((left + right) / 2, top, right, (top + bottom) / 2);
-    _nodes[2] = new QuadTreeNode(left, (top + bottom) / 2, (left + right) / 2, bottom);
-    _nodes[3] = new QuadTreeNode((left + right) / 2, (top + bottom) / 2, right, bottom);
+    const Collision::QuadTree::Node &root = _nodes.front();
+    return pos.x >= node.left && (pos.x < node.right || node.right >= root.right)
+        && pos.y <= node.top && (pos.y > node.bottom || node.bottom <= root.bottom);
+}
 
-    for (Geometry::GeometryObject *object : _objects)
+uint32_t Collision::QuadTree::allocate_children()
+{
+    uint32_t children;
+    if (_free_nodes.empty())
+    {
+        children = static_cast<uint32_t>(_nodes.size());
+        _nodes.resize(_nodes.size() + 4);
+    }
+    else
     {
-        const Geometry::AABBRect rect(object->bounding_rect());
+        children = _free_nodes.back();
+        _free_nodes.pop_back();
         for (size_t i = 0; i < 4; ++i)
         {
-            if (Geometry::is_intersected(_nodes[i]->_rect, rect))
-            {
-                _nodes[i]->append(object);
-            }
+            _nodes[children + i] = Collision::QuadTree::Node();
         }
     }
-    _objects.clear();
+    return children;
 }
 
-bool Collision::QuadTreeNode::is_tail_node() const
+void Collision::QuadTree::push_element(const uint32_t node, const uint32_t index)
 {
-    return _nodes[0] == nullptr;
+    uint32_t element = _free_element;
+    if (element == NULL_INDEX)
+    {
+        element = static_cast<uint32_t>(_elements.size());
+        _elements.emplace_back();
+    }
+    else
+    {
+        _free_element = _elements[element].next;
+    }
+    _elements[element].index = index;
+    _elements[element].next = _nodes[node].first;
+    _nodes[node].first = element;
+    ++_nodes[node].count;
 }
 
-bool Collision::QuadTreeNode::merge()
+void Collision::QuadTree::clear_elements(const uint32_t node)
 {
-    if (_nodes[0] == nullptr)
+    uint32_t element = _nodes[node].first;
+    while (element != NULL_INDEX)
     {
-        return true;
+        const uint32_t next = _elements[element].next;
+        _elements[element].next = _free_element;
+        _free_element = element;
+        element = next;
     }
-    else if (_nodes[0]->is_tail_node() && _nodes[1]->is_tail_node()
-        && _nodes[2]->is_tail_node() && _nodes[3]->is_tail_node())
+    _nodes[node].first = NULL_INDEX;
+    _nodes[node].count = 0;
+    _nodes[node].unsplit = 0;
+}
+
+void Collision::QuadTree::split(const uint32_t node, const size_t depth)
+{
+    const uint32_t children = allocate_children();
+    const Collision::QuadTree::Node parent = _nodes[node];
+    // 相邻子节点共用同一个中点,保证边界完全一致
+    const double x = (parent.left + parent.right) / 2, y = (parent.top + parent.bottom) / 2;
+    const double lefts[4] = {parent.left, x, parent.left, x}, rights[4] = {x, parent.right, x, parent.right};
+    const double tops[4] = {parent.top, parent.top, y, y}, bottoms[4] = {y, y, parent.bottom, parent.bottom};
+    for (size_t i = 0; i < 4; ++i)
     {
-        size_t count = _nodes[0]->_objects.size();
-        count += _nodes[1]->_objects.size();
-        count += _nodes[2]->_objects.size();
-        count += _nodes[3]->_objects.size();
-        if (count < 4 || (count <= 40 && _rect.width() <= 200))
+        _nodes[children + i].left = lefts[i];
+        _nodes[children + i].top = tops[i];
+        _nodes[children + i].right = rights[i];
+        _nodes[children + i].bottom = bottoms[i];
+    }
+
+    _nodes[node].children = children;
+
+    // 松散模式下放不进子节点的对象留在当前节点,递归分裂子节点前_buffer已使用完毕
+    _buffer.clear();
+    for (uint32_t element = parent.first; element != NULL_INDEX;)
+    {
+        const uint32_t index = _elements[element].index;
+        element = _elements[element].next;
+        if (_config.looseness > 0)
         {
-            for (size_t i = 0; i < 4; ++i)
+            const uint32_t next = child(node, _rects[index].center());
+            if (is_contained(_nodes[next], _rects[index]))
             {
-                _objects.insert(_objects.end(), _nodes[i]->_objects.begin(), _nodes[i]->_objects.end());
-                delete _nodes[i];
-                _nodes[i] = nullptr;
+                push_element(next, index);
             }
-            return true;
+            else
+            {
+                _buffer.push_back(index);
+            }
+            continue;
         }
-        else
+        // 对象必然与当前节点相交,只需与中点比较即可确定相交的子节点
+        const Geometry::AABBRect &rect = _rects[index];
+        const bool left = rect.left() <= x, right = rect.right() >= x, top = rect.top() >= y, bottom = rect.bottom() <= y;
+        if (left && top)
         {
-            return false;
+            push_element(children, index);
+        }
+        if (right && top)
+        {
+            push_element(children + 1, index);
+        }
+        if (left && bottom)
+        {
+            push_element(children + 2, index);
+        }
+        if (right && bottom)
+        {
+            push_element(children + 3, index);
         }
     }
-    else
+
+    // 对象都无法下移,或节点已不大于多数对象而使对象平均重复存放超过2份时,分裂没有意义,撤销分裂
+    // 多个子节点都包含全部对象时对象都跨越同一条中线,继续分裂只会使节点数量成倍增加
+    uint32_t full = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        full += _nodes[children + i].count == parent.count ? 1 : 0;
+    }
+    if (_buffer.size() == parent.count || full > 1 || _nodes[children].count + _nodes[children + 1].count
+        + _nodes[children + 2].count + _nodes[children + 3].count > parent.count * 2)
     {
-        bool flag0 = _nodes[0]->merge();
-        bool flag1 = _nodes[1]->merge();
-        bool flag2 = _nodes[2]->merge();
-        bool flag3 = _nodes[3]->merge();
-        if (flag0 && flag1 && flag2 && flag3)
+        for (uint32_t i = 0; i < 4; ++i)
         {
-            size_t count = _nodes[0]->_objects.size();
-            count += _nodes[1]->_objects.size();
-            count += _nodes[2]->_objects.size();
-            count += _nodes[3]->_objects.size();
-            if (count < 4 || (count <= 40 && _rect.width() <= 200))
-            {
-                for (size_t i = 0; i < 4; ++i)
-                {
-                    _objects.insert(_objects.end(), _nodes[i]->_objects.begin(), _nodes[i]->_objects.end());
-                    delete _nodes[i];
-                    _nodes[i] = nullptr;
-                }
-                return true;
-            }
-            else
-            {
-                return false;
-            }
+            clear_elements(children + i);
         }
-        else
+        _nodes[node].children = 0;
+        _nodes[node].unsplit = parent.count;
+        _free_nodes.push_back(children);
+        return;
+    }
+    clear_elements(node);
+    for (const uint32_t index : _buffer)
+    {
+        push_element(node, index);
+    }
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        if (need_split(_nodes[children + i], depth + 1))
         {
-            return false;
+            split(children + i, depth + 1);
         }
     }
 }
 
-bool Collision::QuadTreeNode::append(Geometry::GeometryObject *object)
+bool Collision::QuadTree::merge(const uint32_t node)
 {
-    if (_nodes[0] == nullptr && _nodes[1] == nullptr && _nodes[2] == nullptr && _nodes[3] == nullptr)
+    const uint32_t children = _nodes[node].children;
+    size_t count = _nodes[node].count;
+    for (uint32_t i = 0; i < 4; ++i)
     {
-        if (std::find(_objects.begin(), _objects.end(), object) == _objects.end())
+        if (_nodes[children + i].children != 0)
         {
-            _objects.push_back(object);
-            if (_objects.size() > 40 || (_objects.size() > 4 && _rect.width() > 200))
-            {
-                split();
-            }
-            return true;
+            return false;
         }
+        count += _nodes[children + i].count;
+    }
+    if (!can_merge(_nodes[node], count))
+    {
         return false;
     }
-    else
+
+    // 跨越多个子节点的对象只保留一份
+    _buffer.clear();
+    for (uint32_t i = 0; i < 4; ++i)
     {
-        const Geometry::AABBRect rect(object->bounding_rect());
-        bool flag = false;
-        for (size_t i = 0; i < 4; ++i)
+        for (uint32_t element = _nodes[children + i].first; element != NULL_INDEX; element = _elements[element].next)
+        {
+            _buffer.push_back(_elements[element].index);
+        }
+        clear_elements(children + i);
+    }
+    std::sort(_buffer.begin(), _buffer.end());
+    _buffer.erase(std::unique(_buffer.begin(), _buffer.end()), _buffer.end());
+
+    _nodes[node].children = 0;
+    _free_nodes.push_back(children);
+    for (const uint32_t index : _buffer)
+    {
+        push_element(node, index);
+    }
+    return true;
+}
+
+void Collision::QuadTree::insert(const size_t index)
+{
+    const Geometry::AABBRect &rect = _rects[index];
+    if (_config.looseness > 0)
+    {
+        // 沿中心点所在的子节点下降,直到子节点无法完全包含对象
+        const Geometry::Point center(rect.center());
+        uint32_t node = 0;
+        size_t depth = 0;
+        while (_nodes[node].children != 0 && is_contained(_nodes[child(node, center)], rect))
+        {
+            node = child(node, center);
+            ++depth;
+        }
+        push_element(node, static_cast<uint32_t>(index));
+        if (_nodes[node].children == 0 && need_split(_nodes[node], depth))
         {
-            if (_nodes[i] != nullptr && Geometry::is_intersected(_nodes[i]->_rect, rect))
+            split(node, depth);
+        }
+        return;
+    }
+
+    std::vector<std::pair<uint32_t, size_t>> nodes({{0, 0}});
+    while (!nodes.empty())
+    {
+        const uint32_t node = nodes.back().first;
+        const size_t depth = nodes.back().second;
+        nodes.pop_back();
+        const uint32_t children = _nodes[node].children;
+        if (children == 0)
+        {
+            push_element(node, static_cast<uint32_t>(index));
+            if (need_split(_nodes[node], depth))
+            {
+                split(node, depth);
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < 4; ++i)
             {
-                if (_nodes[i]->append(object))
+                if (is_overlapped(_nodes[children + i], rect))
                 {
-                    flag = true;
+                    nodes.emplace_back(children + i, depth + 1);
                 }
             }
         }
-        return flag;
     }
 }
 
-void Collision::QuadTreeNode::append_node(const size_t index, Collision::QuadTreeNode *node)
+bool Collision::QuadTree::remove(const uint32_t node, const size_t index, const Geometry::AABBRect &rect)
 {
-    if (_nodes[index] != nullptr)
+    const uint32_t children = _nodes[node].children;
+    uint32_t *link = &_nodes[node].first;
+    while (*link != NULL_INDEX && _elements[*link].index != index)
     {
-        delete _nodes[index];
+        link = &_elements[*link].next;
     }
-    _nodes[index] = node;
-}
-
-bool Collision::QuadTreeNode::remove(Geometry::GeometryObject *object)
-{
-    if (_nodes[0] == nullptr)
+    const bool found = *link != NULL_INDEX;
+    if (found)
     {
-        std::vector<Geometry::GeometryObject *>::iterator it = std::find(_objects.begin(), _objects.end(), object);
-        if (it == _objects.end())
+        const uint32_t element = *link;
+        *link = _elements[element].next;
+        _elements[element].next = _free_element;
+        _free_element = element;
+        if (--_nodes[node].count * 2 <= _nodes[node].unsplit)
         {
-            return false;
+            _nodes[node].unsplit = 0;
         }
-        _objects.erase(it);
-        merge();
-        return true;
+        // 松散模式下对象只存放在一个节点中
+        if (_config.looseness > 0)
+        {
+            if (children != 0)
+            {
+                merge(node);
+            }
+            return true;
+        }
+    }
+
+    if (children == 0)
+    {
+        return found;
     }
     else
     {
         bool flag = false;
-        for (size_t i = 0; i < 4; ++i)
+        for (uint32_t i = 0; i < 4; ++i)
         {
-            if (_nodes[i]->remove(object))
+            if (is_overlapped(_nodes[children + i], rect) && remove(children + i, index, rect))
             {
                 flag = true;
             }
         }
-        merge();
+        if (flag)
+        {
+            merge(node);
+        }
         return flag;
     }
 }
 
-bool Collision::QuadTreeNode::has(Geometry::GeometryObject *object) const
+void Collision::QuadTree::expand(const Geometry::AABBRect &rect)
 {
-    if (_nodes[0] == nullptr)
-    {
-        return std::find(_objects.begin(), _objects.end(), object) != _objects.end();
-    }
-    else
+    while (rect.left() < _nodes.front().left || rect.top() > _nodes.front().top
+        || rect.right() > _nodes.front().right || rect.bottom() < _nodes.front().bottom)
     {
-        return _nodes[0]->has(object) || _nodes[1]->has(object) || _nodes[2]->has(object) || _nodes[3]->has(object);
+        const Collision::QuadTree::Node root = _nodes.front();
+        const double left_space = root.left - rect.left(), top_space = rect.top() - root.top,
+            right_space = rect.right() - root.right, bottom_space = root.bottom - rect.bottom();
+        double left = root.left, top = root.top, right = root.right, bottom = root.bottom, x, y;
+        size_t pos = 0;
+        if (left_space > right_space)
+        {
+            left -= (root.right - root.left);
+            x = root.left;
+            pos += 1;
+        }
+        else
+        {
+            right += (root.right - root.left);
+            x = root.right;
+        }
+        if (bottom_space > top_space)
+        {
+            bottom -= (root.top - root.bottom);
+            y = root.bottom;
+        }
+        else
+        {
+            top += (root.top - root.bottom);
+            y = root.top;
+            pos += 2;
+        }
+
+        // 原根节点成为新根节点的一个子节点,子树保持不变
+        const uint32_t children = allocate_children();
+        const double lefts[4] = {left, x, left, x}, rights[4] = {x, right, x, right};
+        const double tops[4] = {top, top, y, y}, bottoms[4] = {y, y, bottom, bottom};
+        for (size_t i = 0; i < 4; ++i)
+        {
+            _nodes[children + i].left = lefts[i];
+            _nodes[children + i].top = tops[i];
+            _nodes[children + i].right = rights[i];
+            _nodes[children + i].bottom = bottoms[i];
+        }
+        _nodes[children + pos] = root;
+
+        Collision::QuadTree::Node &node = _nodes.front();
+        node = Collision::QuadTree::Node();
+        node.left = left;
+        node.top = top;
+        node.right = right;
+        node.bottom = bottom;
+        node.children = children;
     }
 }
 
-void Collision::QuadTreeNode::clear()
+void Collision::QuadTree::rebuild()
 {
-    if (_nodes[0] == nullptr)
+    _nodes.clear();
+    _free_nodes.clear();
+    _elements.clear();
+    _free_element = NULL_INDEX;
+
+    double left = DBL_MAX, top = -DBL_MAX, right = -DBL_MAX, bottom = DBL_MAX;
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
     {
-        _objects.clear();
+        if (_objects[i] != nullptr)
+        {
+            left = std::min(left, _rects[i].left());
+            top = std::max(top, _rects[i].top());
+            right = std::max(right, _rects[i].right());
+            bottom = std::min(bottom, _rects[i].bottom());
+        }
     }
-    else
+    if (_indexs.empty())
     {
-        for (size_t i = 0; i < 4; ++i)
+        left = bottom = 0;
+        top = right = 100;
+    }
+
+    _nodes.emplace_back();
+    _nodes.front().left = left;
+    _nodes.front().top = top;
+    // 根节点需要有面积,否则无法向外扩展
+    _nodes.front().right = std::max(right, left + 1);
+    _nodes.front().bottom = std::min(bottom, top - 1);
+    // 元素以头插法入链,倒序放入使链表保持句柄递增的顺序
+    for (size_t i = _objects.size(); i-- > 0;)
+    {
+        if (_objects[i] != nullptr)
         {
-            delete _nodes[i];
-            _nodes[i] = nullptr;
+            push_element(0, static_cast<uint32_t>(i));
         }
     }
+    if (need_split(_nodes.front(), 0))
+    {
+        split(0, 0);
+    }
 }
 
-bool Collision::QuadTreeNode::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
+void Collision::QuadTree::occupied(std::vector<uint32_t> &nodes) const
 {
-    if (_nodes[0] == nullptr)
+    std::vector<uint32_t> stack({0});
+    while (!stack.empty())
     {
-        return Collision::GridNode::select(pos, objects);
+        const uint32_t node = stack.back();
+        stack.pop_back();
+        if (_nodes[node].count > 0)
+        {
+            nodes.push_back(node);
+        }
+        const uint32_t children = _nodes[node].children;
+        if (children != 0)
+        {
+            stack.push_back(children + 3);
+            stack.push_back(children + 2);
+            stack.push_back(children + 1);
+            stack.push_back(children);
+        }
     }
-    else
+}
+
+void Collision::QuadTree::gather(const uint32_t node, Collision::GridNode &grid) const
+{
+    grid.clear();
+    for (uint32_t element = _nodes[node].first; element != NULL_INDEX; element = _elements[element].next)
     {
-        const size_t size = objects.size();
-        _nodes[0]->select(pos, objects);
-        _nodes[1]->select(pos, objects);
-        _nodes[2]->select(pos, objects);
-        _nodes[3]->select(pos, objects);
-        std::set<Geometry::GeometryObject *> temp(objects.begin(), objects.end());
-        objects.assign(temp.begin(), temp.end());
-        return objects.size() > size;
+        const uint32_t index = _elements[element].index;
+        grid.append(_objects[index], index, _rects[index]);
     }
 }
 
-bool Collision::QuadTreeNode::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
+void Collision::QuadTree::find_collision_pairs(const uint32_t node, const Collision::GridNode &grid, const size_t begin, const size_t end, const bool norepeat, const bool narrow,
+    std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, std::vector<size_t> &positions,
+    Collision::CollisionStatistics &statistics) const
 {
-    if (_nodes[0] == nullptr)
+    // 跨越多个节点的一对对象只由其重叠区域左上角所在的节点记录,松散模式下对象不会重复存放
+    const bool loose = _config.looseness > 0;
+    std::vector<uint32_t> nodes;
+    for (size_t i = begin, count = grid.size(); i < end; ++i)
     {
-        return Collision::GridNode::select(rect, objects);
+        const size_t index0 = grid.index(i);
+        const Geometry::AABBRect &rect = _rects[index0];
+        const size_t num = grid.filter(rect.left(), rect.top(), rect.right(), rect.bottom(), i + 1, positions);
+        statistics.candidates += count - i - 1;
+        statistics.aabb_rejected += count - i - 1 - num;
+        const Geometry::GeometryObject *object0 = _objects[index0];
+        for (const size_t j : positions)
+        {
+            const size_t index1 = grid.index(j);
+            const Geometry::GeometryObject *object1 = _objects[index1];
+            if (norepeat && !loose && !is_owner(_nodes[node], Geometry::Point(std::max(rect.left(), _rects[index1].left()),
+                std::min(rect.top(), _rects[index1].top()))))
+            {
+                ++statistics.repeat_rejected;
+            }
+            else if (!_filter.accepts(index0, index1))
+            {
+                ++statistics.layer_rejected;
+            }
+            else if (!narrow || Collision::gjk(object0, object1))
+            {
+                pairs.emplace_back(_objects[index0], _objects[index1]);
+            }
+            else
+            {
+                ++statistics.gjk_rejected;
+            }
+        }
+
+        if (!loose)
+        {
+            continue;
+        }
+        // 不同节点中的一对对象由下标较小的节点记录
+        nodes.assign(1, 0);
+        while (!nodes.empty())
+        {
+            const uint32_t current = nodes.back();
+            nodes.pop_back();
+            if (!is_overlapped(_nodes[current], rect))
+            {
+                continue;
+            }
+            if (_nodes[current].children != 0)
+            {
+                const uint32_t children = _nodes[current].children;
+                nodes.insert(nodes.end(), {children + 3, children + 2, children + 1, children});
+            }
+            if (current <= node)
+            {
+                continue;
+            }
+            for (uint32_t element = _nodes[current].first; element != NULL_INDEX; element = _elements[element].next)
+            {
+                const uint32_t index1 = _elements[element].index;
+                ++statistics.candidates;
+                if (!::is_overlapped(rect, _rects[index1]))
+                {
+                    ++statistics.aabb_rejected;
+                }
+                else if (!_filter.accepts(index0, index1))
+                {
+                    ++statistics.layer_rejected;
+                }
+                else if (!narrow || Collision::gjk(object0, static_cast<const Geometry::GeometryObject *>(_objects[index1])))
+                {
+                    pairs.emplace_back(_objects[index0], _objects[index1]);
+                }
+                else
+                {
+                    ++statistics.gjk_rejected;
+                }
+            }
+        }
     }
-    else
+}
+
+void Collision::QuadTree::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    _objects.clear();
+    _rects.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
     {
-        const size_t size = objects.size();
-        _nodes[0]->select(rect, objects);
-        _nodes[1]->select(rect, objects);
-        _nodes[2]->select(rect, objects);
-        _nodes[3]->select(rect, objects);
-        std::set<Geometry::GeometryObject *> temp(objects.begin(), objects.end());
-        objects.assign(temp.begin(), temp.end());
-        return objects.size() > size;
+        if (_indexs.emplace(*it, _objects.size()).second)
+        {
+            _objects.push_back(*it);
+            _rects.emplace_back((*it)->bounding_rect());
+        }
     }
+    rebuild();
 }
 
-bool Collision::QuadTreeNode::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat) const
+void Collision::QuadTree::build(const std::vector<Geometry::GeometryObject *> &objects)
 {
-    if (_nodes[0] == nullptr)
+    if (&objects == &_objects)
     {
-        return Collision::GridNode::find_collision_objects(object, objects);
+        return update();
     }
-    else
-    {
-        const size_t size = objects.size();
-        _nodes[0]->find_collision_objects(object, objects);
-        _nodes[1]->find_collision_objects(object, objects);
-        _nodes[2]->find_collision_objects(object, objects);
-        _nodes[3]->find_collision_objects(object, objects);
+    build(objects.cbegin(), objects.cend());
+}
 
-        if (norepeat)
+void Collision::QuadTree::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
+{
+    if (&objects != &_objects)
+    {
+        _objects.clear();
+        _rects.clear();
+        _free_indexs.clear();
+        _indexs.clear();
+        _filter.clear();
+        for (size_t i = 0, count = objects.size(); i < count; ++i)
         {
-            std::set<Geometry::GeometryObject *> temp(objects.begin(), objects.end());
-            objects.assign(temp.begin(), temp.end());
+            if (_indexs.emplace(objects[i], _objects.size()).second)
+            {
+                _objects.push_back(objects[i]);
+                _rects.emplace_back(rects[i]);
+            }
         }
-
-        return objects.size() > size;
     }
+    rebuild();
 }
 
-bool Collision::QuadTreeNode::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+void Collision::QuadTree::build(const std::vector<Geometry::GeometryObject *> &objects, Collision::ThreadPool &pool)
 {
-    if (_nodes[0] == nullptr)
-    {
-        return Collision::GridNode::find_collision_pairs(pairs);
-    }
-    else
+    if (&objects != &_objects)
     {
-        const size_t size = pairs.size();
-        _nodes[0]->find_collision_pairs(pairs);
-        _nodes[1]->find_collision_pairs(pairs);
-        _nodes[2]->find_collision_pairs(pairs);
-        _nodes[3]->find_collision_pairs(pairs);
-
-        if (norepeat)
+        _objects.clear();
+        _free_indexs.clear();
+        _indexs.clear();
+        _filter.clear();
+        for (Geometry::GeometryObject *object : objects)
         {
-            for (size_t i = 0, count = pairs.size(); i < count; ++i)
+            if (_indexs.emplace(object, _objects.size()).second)
             {
-                for (size_t j = count - 1; j > i; --j)
-                {
-                    if ((pairs[i].first == pairs[j].first && pairs[i].second == pairs[j].second)
-                        || (pairs[i].first == pairs[j].second && pairs[i].second == pairs[j].first))
-                    {
-                        pairs.erase(pairs.begin() + j);
-                        --count;
-                    }
-                }
+                _objects.push_back(object);
             }
         }
-
-        return pairs.size() > size;
+        _rects.resize(_objects.size());
     }
+    update(pool);
 }
 
-
-Collision::QuadTree::QuadTree()
+size_t Collision::QuadTree::append(Geometry::GeometryObject *object)
 {
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        return it->second;
+    }
 
+    size_t index = _objects.size();
+    if (_free_indexs.empty())
+    {
+        _objects.push_back(object);
+        _rects.emplace_back(object->bounding_rect());
+    }
+    else
+    {
+        index = _free_indexs.back();
+        _free_indexs.pop_back();
+        _objects[index] = object;
+        _rects[index] = object->bounding_rect();
+    }
+    _indexs[object] = index;
+
+    if (_nodes.empty())
+    {
+        rebuild();
+    }
+    else
+    {
+        expand(_rects[index]);
+        insert(index);
+    }
+    return index;
 }
 
-Collision::QuadTree::QuadTree(const std::vector<Geometry::GeometryObject *> &objects)
-    : _objects(objects)
+void Collision::QuadTree::remove(Geometry::GeometryObject *object)
 {
-    build(objects);
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    remove(0, index, _rects[index]);
+    _filter.reset(it->second);
+    _indexs.erase(it);
+    _objects[index] = nullptr;
+    _free_indexs.push_back(index);
 }
 
-Collision::QuadTree::QuadTree(const std::initializer_list<Geometry::GeometryObject *> &objects)
-    : _objects(objects)
+void Collision::QuadTree::update(Geometry::GeometryObject *object)
 {
-    build(_objects);
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    // 按旧的AABB矩形删除,只访问对象所在的节点
+    const size_t index = it->second;
+    remove(0, index, _rects[index]);
+    _rects[index] = object->bounding_rect();
+    expand(_rects[index]);
+    insert(index);
 }
 
-Collision::QuadTree::QuadTree(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
-    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
-    : _objects(begin, end)
+void Collision::QuadTree::update()
 {
-    build(_objects);
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            _rects[i] = _objects[i]->bounding_rect();
+        }
+    }
+    rebuild();
 }
 
-Collision::QuadTree::~QuadTree()
+void Collision::QuadTree::update(Collision::ThreadPool &pool)
 {
-    if (_root != nullptr)
+    const size_t count = _objects.size(), chunks = std::max<size_t>(std::min(pool.size() * 4, count / 1024), 1);
+    pool.run(chunks, [&](const size_t chunk, const size_t)
     {
-        delete _root;
-    }
+        for (size_t i = count * chunk / chunks, end = count * (chunk + 1) / chunks; i < end; ++i)
+        {
+            if (_objects[i] != nullptr)
+            {
+                _rects[i] = _objects[i]->bounding_rect();
+            }
+        }
+    });
+    rebuild();
 }
 
-void Collision::QuadTree::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+void Collision::QuadTree::update(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    update(objects.cbegin(), objects.cend());
+}
+
+void Collision::QuadTree::update(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
     const std::vector<Geometry::GeometryObject *>::const_iterator &end)
 {
-    if (_root != nullptr)
+    if (_nodes.empty())
     {
-        delete _root;
+        return;
     }
 
-    if (begin == end)
+    // 大部分对象都移动时整体重建一次
+    if (static_cast<size_t>(std::distance(begin, end)) * 2 > _indexs.size())
     {
-        _left = _bottom = 0;
-        _top = _right = 100;
-        _root = new QuadTreeNode(_left, _top, _right, _bottom);
-        _objects.clear();
-        _rects.clear();
-        return;
+        for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+        {
+            std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator index = _indexs.find(*it);
+            if (index != _indexs.end())
+            {
+                _rects[index->second] = (*it)->bounding_rect();
+            }
+        }
+        return rebuild();
     }
 
-    _left = _bottom = DBL_MAX;
-    _top = _right = -DBL_MAX;
-    _rects.clear();
+    std::vector<size_t> indexs;
+    double left = DBL_MAX, top = -DBL_MAX, right = -DBL_MAX, bottom = DBL_MAX;
     for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
     {
-        _rects.emplace_back((*it)->bounding_rect());
-        _left = std::min(_left, _rects.back().left());
-        _top = std::max(_top, _rects.back().top());
-        _right = std::max(_right, _rects.back().right());
-        _bottom = std::min(_bottom, _rects.back().bottom());
+        std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator index = _indexs.find(*it);
+        if (index == _indexs.end())
+        {
+            continue;
+        }
+        remove(0, index->second, _rects[index->second]);
+        _rects[index->second] = (*it)->bounding_rect();
+        left = std::min(left, _rects[index->second].left());
+        top = std::max(top, _rects[index->second].top());
+        right = std::max(right, _rects[index->second].right());
+        bottom = std::min(bottom, _rects[index->second].bottom());
+        indexs.push_back(index->second);
+    }
+    if (indexs.empty())
+    {
+        return;
     }
-    _objects.assign(begin, end);
 
-    _root = new QuadTreeNode(_left, _top, _right, _bottom);
-    for (Geometry::GeometryObject *object : _objects)
+    // 重复出现的对象只插入一次
+    std::sort(indexs.begin(), indexs.end());
+    indexs.erase(std::unique(indexs.begin(), indexs.end()), indexs.end());
+    expand(Geometry::AABBRect(left, top, right, bottom));
+    for (const size_t index : indexs)
     {
-        _root->append(object);
+        insert(index);
     }
 }
 
-void Collision::QuadTree::build(const std::vector<Geometry::GeometryObject *> &objects)
+bool Collision::QuadTree::has(Geometry::GeometryObject *object) const
+{
+    return _indexs.find(object) != _indexs.end();
+}
+
+void Collision::QuadTree::clear()
+{
+    _nodes.clear();
+    _free_nodes.clear();
+    _elements.clear();
+    _free_element = NULL_INDEX;
+    _rects.clear();
+    _objects.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+}
+
+double Collision::QuadTree::looseness() const
+{
+    return _config.looseness;
+}
+
+const Collision::QuadTreeConfig &Collision::QuadTree::config() const
+{
+    return _config;
+}
+
+void Collision::QuadTree::set_config(const Collision::QuadTreeConfig &config)
 {
-    if (_root != nullptr)
+    _config = config;
+    _config.looseness = std::max(config.looseness, 0.0);
+    if (!_nodes.empty())
     {
-        delete _root;
+        rebuild();
     }
+}
 
-    if (objects.empty())
+void Collision::QuadTree::set_looseness(const double value)
+{
+    if (_config.looseness != std::max(value, 0.0))
     {
-        _left = _bottom = 0;
-        _top = _right = 100;
-        _root = new QuadTreeNode(_left, _top, _right, _bottom);
-        _rects.clear();
-        _objects.clear();
-        return;
+        _config.looseness = std::max(value, 0.0);
+        if (!_nodes.empty())
+        {
+            rebuild();
+        }
     }
+}
 
-    _left = _bottom = DBL_MAX;
-    _top = _right = -DBL_MAX;
-    _rects.clear();
-    for (const Geometry::GeometryObject *object : objects)
+bool Collision::QuadTree::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    if (_nodes.empty())
     {
-        _rects.emplace_back(object->bounding_rect());
-        _left = std::min(_left, _rects.back().left());
-        _top = std::max(_top, _rects.back().top());
-        _right = std::max(_right, _rects.back().right());
-        _bottom = std::min(_bottom, _rects.back().bottom());
+        return false;
     }
-    if (&objects != &_objects)
+
+    // 包含pos的对象必然位于pos所属的叶节点中,松散模式下则位于扩大后边界包含pos的节点中
+    std::vector<uint32_t> nodes;
+    if (_config.looseness > 0)
     {
-        _objects.assign(objects.cbegin(), objects.cend());
+        const Geometry::AABBRect rect(pos.x, pos.y, pos.x, pos.y);
+        std::vector<uint32_t> stack({0});
+        while (!stack.empty())
+        {
+            const uint32_t node = stack.back();
+            stack.pop_back();
+            if (is_overlapped(_nodes[node], rect))
+            {
+                nodes.push_back(node);
+                if (_nodes[node].children != 0)
+                {
+                    const uint32_t children = _nodes[node].children;
+                    stack.insert(stack.end(), {children + 3, children + 2, children + 1, children});
+                }
+            }
+        }
+    }
+    else
+    {
+        uint32_t node = 0;
+        while (_nodes[node].children != 0)
+        {
+            node = child(node, pos);
+        }
+        nodes.push_back(node);
     }
 
-    _root = new QuadTreeNode(_left, _top, _right, _bottom);
-    for (Geometry::GeometryObject *object : objects)
+    const size_t size = objects.size();
+    for (const uint32_t node : nodes)
     {
-        _root->append(object);
+        for (uint32_t element = _nodes[node].first; element != NULL_INDEX; element = _elements[element].next)
+        {
+            Geometry::GeometryObject *object = _objects[_elements[element].index];
+            if (Collision::GridNode::is_selected(pos, object))
+            {
+                objects.push_back(object);
+            }
+        }
     }
+    return objects.size() > size;
 }
 
-void Collision::QuadTree::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
+bool Collision::QuadTree::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
 {
-    if (_root != nullptr)
+    if (_nodes.empty())
     {
-        delete _root;
+        return false;
     }
 
-    if (objects.empty())
+    const bool loose = _config.looseness > 0;
+    const size_t size = objects.size();
+    std::vector<uint32_t> nodes({0});
+    while (!nodes.empty())
     {
-        _left = _bottom = 0;
-        _top = _right = 100;
-        _root = new QuadTreeNode(_left, _top, _right, _bottom);
-        _rects.clear();
-        _objects.clear();
-        return;
-    }
+        const Collision::QuadTree::Node &node = _nodes[nodes.back()];
+        nodes.pop_back();
+        if (!is_overlapped(node, rect))
+        {
+            continue;
+        }
+        if (node.children != 0)
+        {
+            nodes.insert(nodes.end(), {node.children + 3, node.children + 2, node.children + 1, node.children});
+        }
 
-    _left = _bottom = DBL_MAX;
-    _top = _right = -DBL_MAX;
-    for (const Geometry::AABBRect &rect : rects)
-    {
-        _left = std::min(_left, rect.left());
-        _top = std::max(_top, rect.top());
-        _right = std::max(_right, rect.right());
-        _bottom = std::min(_bottom, rect.bottom());
+        // 只记录重叠区域左上角位于当前节点的对象
+        for (uint32_t element = node.first; element != NULL_INDEX; element = _elements[element].next)
+        {
+            const uint32_t index = _elements[element].index;
+            if ((loose || is_owner(node, Geometry::Point(std::max(rect.left(), _rects[index].left()), std::min(rect.top(), _rects[index].top()))))
+                && Collision::GridNode::is_selected(rect, _objects[index]))
+            {
+                objects.push_back(_objects[index]);
+            }
+        }
     }
-    if (&objects != &_objects)
+    return objects.size() > size;
+}
+
+bool Collision::QuadTree::query_radius(const Geometry::Point &pos, const double radius,
+    std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
+{
+    if (_nodes.empty() || radius < 0)
     {
-        _objects.assign(objects.cbegin(), objects.cend());
-        _rects.assign(rects.cbegin(), rects.cend());
+        return false;
     }
 
-    _root = new QuadTreeNode(_left, _top, _right, _bottom);
-    for (Geometry::GeometryObject *object : objects)
+    const bool loose = _config.looseness > 0;
+    const size_t size = objects.size();
+    const Geometry::AABBRect rect(pos.x - radius, pos.y + radius, pos.x + radius, pos.y - radius);
+    std::vector<uint32_t> nodes({0});
+    while (!nodes.empty())
     {
-        _root->append(object);
+        const Collision::QuadTree::Node &node = _nodes[nodes.back()];
+        nodes.pop_back();
+        // 按外接正方形筛选节点,保证重叠区域左上角所在的节点会被访问
+        if (!is_overlapped(node, rect))
+        {
+            continue;
+        }
+        if (node.children != 0)
+        {
+            nodes.insert(nodes.end(), {node.children + 3, node.children + 2, node.children + 1, node.children});
+        }
+
+        // 只记录重叠区域左上角位于当前节点的对象
+        for (uint32_t element = node.first; element != NULL_INDEX; element = _elements[element].next)
+        {
+            const uint32_t index = _elements[element].index;
+            const Geometry::AABBRect &object_rect = _rects[index];
+            if (Collision::distance(pos, object_rect.left(), object_rect.top(), object_rect.right(), object_rect.bottom()) > radius
+                || !(loose || is_owner(node, Geometry::Point(std::max(rect.left(), object_rect.left()), std::min(rect.top(), object_rect.top())))))
+            {
+                continue;
+            }
+            const double value = Collision::distance(pos, _objects[index]);
+            if (value <= radius)
+            {
+                objects.emplace_back(_objects[index], value);
+            }
+        }
     }
+    std::sort(objects.begin() + size, objects.end(), Collision::is_nearer);
+    return objects.size() > size;
 }
 
-void Collision::QuadTree::append(Geometry::GeometryObject *object)
+bool Collision::QuadTree::query_knn(const Geometry::Point &pos, const size_t k, std::vector<std::pair<Geometry::GeometryObject *, double>> &objects) const
 {
-    if (std::find(_objects.begin(), _objects.end(), object) != _objects.end())
+    const size_t size = objects.size();
+    if (_nodes.empty() || k == 0)
     {
-        return;
+        return false;
     }
-    _objects.push_back(object);
 
-    const Geometry::AABBRect rect(object->bounding_rect());
-    if (rect.left() >= _left && rect.right() <= _right && rect.top() <= _top && rect.bottom() >= _bottom)
-    {
-        _root->append(object);
-    }
-    else
+    const bool loose = _config.looseness > 0;
+    // 以节点距离为键的最小堆
+    std::vector<std::pair<double, uint32_t>> nodes({{distance(_nodes.front(), pos), 0}});
+    while (!nodes.empty())
     {
-        Collision::QuadTreeNode *node;
-        double left_sapce = _left - rect.left(), top_space = rect.top() > _top,
-            right_space = rect.right() - _right, bottom_sapce = _bottom - rect.bottom();
-        while (left_sapce > 0 || top_space > 0 || right_space > 0 || bottom_sapce > 0)
+        std::pop_heap(nodes.begin(), nodes.end(), std::greater<std::pair<double, uint32_t>>());
+        const std::pair<double, uint32_t> item = nodes.back();
+        nodes.pop_back();
+        if (item.first > Collision::nearest_bound(objects, size, k))
+        {
+            break;
+        }
+
+        // 非松散模式下对象只在包含其AABB矩形上距离pos最近的点的叶节点中检测,该节点的距离不大于对象的距离
+        // 与插入时相同按闭区间判断包含,该点位于节点边界上时对象可能存放在多个这样的节点中,需去重
+        const Collision::QuadTree::Node &node = _nodes[item.second];
+        for (uint32_t element = node.first; element != NULL_INDEX; element = _elements[element].next)
         {
-            node = _root;
-            if (left_sapce > right_space)
+            const uint32_t index = _elements[element].index;
+            const Geometry::AABBRect &rect = _rects[index];
+            if (Collision::distance(pos, rect.left(), rect.top(), rect.right(), rect.bottom()) > Collision::nearest_bound(objects, size, k))
             {
-                _left -= (_right - _left);
-                if (bottom_sapce > top_space)
-                {
-                    _bottom -= (_top - _bottom);
-                    _root = new QuadTreeNode(_left, _top, _right, _bottom);
-                    _root->append_node(0, new QuadTreeNode(_left, _top, (_left + _right) / 2, (_top + _bottom) / 2));
-                    _root->append_node(1, node);
-                    _root->append_node(2, new QuadTreeNode(_left, (_top + _bottom) / 2, (_left + _right) / 2, _bottom));
-                    _root->append_node(3, new QuadTreeNode((_left + _right) / 2, (_top + _bottom) / 2, _right, _bottom));
-                }
-                else
-                {
-                    _top += (_top - _bottom);
-                    _root = new QuadTreeNode(_left, _top, _right, _bottom);
-                    _root->append_node(0, new QuadTreeNode(_left, _top, (_left + _right) / 2, (_top + _bottom) / 2));
-                    _root->append_node(1, new QuadTreeNode((_left + _right) / 2, _top, _right, (_top + _bottom) / 2));
-                    _root->append_node(2, new QuadTreeNode(_left, (_top + _bottom) / 2, (_left + _right) / 2, _bottom));
-                    _root->append_node(3, node);
-                }
+                continue;
             }
-            else
+            if (!loose)
             {
-                _right += (_right - _left);
-                if (bottom_sapce > top_space)
+                const Geometry::Point point = Collision::nearest_point(pos, rect);
+                if (point.x < node.left || point.x > node.right || point.y > node.top || point.y < node.bottom)
                 {
-                    _bottom -= (_top - _bottom);
-                    _root = new QuadTreeNode(_left, _top, _right, _bottom);
-                    _root->append_node(0, node);
-                    _root->append_node(1, new QuadTreeNode((_left + _right) / 2, _top, _right, (_top + _bottom) / 2));
-                    _root->append_node(2, new QuadTreeNode(_left, (_top + _bottom) / 2, (_left + _right) / 2, _bottom));
-                    _root->append_node(3, new QuadTreeNode((_left + _right) / 2, (_top + _bottom) / 2, _right, _bottom));
+                    continue;
                 }
-                else
+                if ((point.x == node.left || point.x == node.right || point.y == node.top || point.y == node.bottom)
+                    && std::find_if(objects.begin() + size, objects.end(), [&](const std::pair<Geometry::GeometryObject *, double> &nearest)
+                        { return nearest.first == _objects[index]; }) != objects.end())
                 {
-                    _top += (_top - _bottom);
-                    _root = new QuadTreeNode(_left, _top, _right, _bottom);
-                    _root->append_node(0, new QuadTreeNode(_left, _top, (_left + _right) / 2, (_top + _bottom) / 2));
-                    _root->append_node(1, new QuadTreeNode((_left + _right) / 2, _top, _right, (_top + _bottom) / 2));
-                    _root->append_node(2, node);
-                    _root->append_node(3, new QuadTreeNode((_left + _right) / 2, (_top + _bottom) / 2, _right, _bottom));
+                    continue;
                 }
             }
-
-            left_sapce = _left - rect.left();
-            top_space = rect.top() > _top;
-            right_space = rect.right() - _right;
-            bottom_sapce = _bottom - rect.bottom();
+            Collision::push_nearest(objects, size, k, _objects[index], Collision::distance(pos, _objects[index]));
+        }
+        for (uint32_t i = 0; node.children != 0 && i < 4; ++i)
+        {
+            const double value = distance(_nodes[node.children + i], pos);
+            if (value <= Collision::nearest_bound(objects, size, k))
+            {
+                nodes.emplace_back(value, node.children + i);
+                std::push_heap(nodes.begin(), nodes.end(), std::greater<std::pair<double, uint32_t>>());
+            }
         }
     }
+    Collision::sort_nearest(objects, size);
+    return objects.size() > size;
 }
 
-void Collision::QuadTree::remove(Geometry::GeometryObject *object)
+const Collision::CollisionLayer &Collision::QuadTree::layer(const Geometry::GeometryObject *object) const
 {
-    if (std::find(_objects.begin(), _objects.end(), object) != _objects.end())
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(const_cast<Geometry::GeometryObject *>(object));
+    return it == _indexs.end() ? Collision::CollisionFilter::default_layer() : _filter.layer(it->second);
+}
+
+void Collision::QuadTree::set_layer(Geometry::GeometryObject *object, const Collision::CollisionLayer &layer)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(object);
+    if (it != _indexs.end())
     {
-        _root->remove(object);
+        _filter.set_layer(it->second, layer);
     }
 }
 
-void Collision::QuadTree::update(Geometry::GeometryObject *object)
+bool Collision::QuadTree::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat) const
 {
-    if (std::find(_objects.begin(), _objects.end(), object) != _objects.end())
+    Collision::CollisionStatistics statistics;
+    return find_collision_objects(object, objects, statistics, norepeat);
+}
+
+bool Collision::QuadTree::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects,
+    Collision::CollisionStatistics &statistics, const bool norepeat) const
+{
+    if (object == nullptr || _nodes.empty())
+    {
+        return false;
+    }
+
+    const bool loose = _config.looseness > 0;
+    const size_t size = objects.size();
+    const Geometry::AABBRect rect(object->bounding_rect());
+    const Collision::CollisionLayer &layer = this->layer(object);
+    std::vector<uint32_t> nodes({0});
+    while (!nodes.empty())
     {
-        _root->remove(object);
-        _root->append(object);
+        const Collision::QuadTree::Node &node = _nodes[nodes.back()];
+        nodes.pop_back();
+        if (!is_overlapped(node, rect))
+        {
+            continue;
+        }
+        if (node.children != 0)
+        {
+            nodes.insert(nodes.end(), {node.children + 3, node.children + 2, node.children + 1, node.children});
+        }
+
+        for (uint32_t element = node.first; element != NULL_INDEX; element = _elements[element].next)
+        {
+            const uint32_t index = _elements[element].index;
+            const Geometry::GeometryObject *obj = _objects[index];
+            if (obj == object)
+            {
+                continue;
+            }
+            ++statistics.candidates;
+            if (!::is_overlapped(rect, _rects[index]))
+            {
+                ++statistics.aabb_rejected;
+            }
+            else if (norepeat && !loose && !is_owner(node, Geometry::Point(std::max(rect.left(), _rects[index].left()),
+                std::min(rect.top(), _rects[index].top()))))
+            {
+                ++statistics.repeat_rejected;
+            }
+            else if (!_filter.accepts(layer, index))
+            {
+                ++statistics.layer_rejected;
+            }
+            else if (Collision::gjk(obj, object))
+            {
+                objects.push_back(_objects[index]);
+            }
+            else
+            {
+                ++statistics.gjk_rejected;
+            }
+        }
     }
+    return objects.size() > size;
 }
 
-void Collision::QuadTree::update()
+bool Collision::QuadTree::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
 {
-    delete _root;
-    _root = nullptr;
-    build(_objects, _rects);
+    Collision::CollisionStatistics statistics;
+    return find_collision_pairs(pairs, statistics, norepeat);
 }
 
-bool Collision::QuadTree::has(Geometry::GeometryObject *object) const
+bool Collision::QuadTree::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    Collision::CollisionStatistics &statistics, const bool norepeat) const
 {
-    return std::find(_objects.begin(), _objects.end(), object) != _objects.end();
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    const size_t size = pairs.size();
+    std::vector<uint32_t> nodes;
+    occupied(nodes);
+    Collision::GridNode grid;
+    std::vector<size_t> positions;
+    for (const uint32_t node : nodes)
+    {
+        gather(node, grid);
+        find_collision_pairs(node, grid, 0, grid.size(), norepeat, true, pairs, positions, statistics);
+    }
+    return pairs.size() > size;
 }
 
-void Collision::QuadTree::clear()
+bool Collision::QuadTree::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    Collision::ThreadPool &pool, const bool norepeat) const
 {
-    _rects.clear();
-    _objects.clear();
-    delete _root;
-    _root = nullptr;
+    Collision::CollisionStatistics statistics;
+    return find_collision_pairs(pairs, pool, statistics, norepeat);
 }
 
-bool Collision::QuadTree::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
+bool Collision::QuadTree::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    Collision::ThreadPool &pool, Collision::CollisionStatistics &statistics, const bool norepeat) const
 {
-    return _root != nullptr && _root->select(pos, objects);
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> nodes;
+    occupied(nodes);
+    std::vector<size_t> sizes;
+    for (const uint32_t node : nodes)
+    {
+        sizes.push_back(_nodes[node].count);
+    }
+    std::vector<Collision::PairTask> tasks;
+    Collision::split_pair_tasks(sizes, pool.size(), tasks);
+
+    // 每个任务的结果单独存放,按任务顺序合并后与串行结果完全一致
+    std::vector<std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>>> results(tasks.size());
+    std::vector<Collision::GridNode> grids(pool.size());
+    // 各线程当前收集在grids中的叶节点,连续的任务属于同一叶节点时无需重新收集
+    std::vector<size_t> gathered(pool.size(), tasks.size());
+    std::vector<std::vector<size_t>> positions(pool.size());
+    std::vector<Collision::CollisionStatistics> thread_statistics(pool.size());
+    pool.run(tasks.size(), [&](const size_t task, const size_t thread)
+        {
+            if (gathered[thread] != tasks[task].node)
+            {
+                gather(nodes[tasks[task].node], grids[thread]);
+                gathered[thread] = tasks[task].node;
+            }
+            find_collision_pairs(nodes[tasks[task].node], grids[thread], tasks[task].begin, tasks[task].end, norepeat, true,
+                results[task], positions[thread], thread_statistics[thread]);
+        });
+
+    const size_t size = pairs.size();
+    for (const std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &result : results)
+    {
+        pairs.insert(pairs.end(), result.begin(), result.end());
+    }
+    for (const Collision::CollisionStatistics &value : thread_statistics)
+    {
+        statistics += value;
+    }
+    return pairs.size() > size;
 }
 
-bool Collision::QuadTree::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
+bool Collision::QuadTree::find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
 {
-    return _root != nullptr && _root->select(rect, objects);
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    const size_t size = pairs.size();
+    std::vector<uint32_t> nodes;
+    occupied(nodes);
+    Collision::GridNode grid;
+    std::vector<size_t> positions;
+    Collision::CollisionStatistics statistics;
+    for (const uint32_t node : nodes)
+    {
+        gather(node, grid);
+        find_collision_pairs(node, grid, 0, grid.size(), true, false, pairs, positions, statistics);
+    }
+    return pairs.size() > size;
 }
 
-bool Collision::QuadTree::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat) const
+bool Collision::QuadTree::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, Collision::RaycastHit &hit) const
 {
-    return _root != nullptr && _root->find_collision_objects(object, objects, norepeat);
+    hit = Collision::RaycastHit();
+    hit.t = max_t;
+    double enter, exit;
+    if (_nodes.empty() || !raycast(_nodes.front(), origin, dir, max_t, enter))
+    {
+        return false;
+    }
+
+    // 以进入位置为键的最小堆
+    std::vector<std::pair<double, uint32_t>> nodes({{enter, 0}});
+    Collision::RaycastHit current;
+    while (!nodes.empty())
+    {
+        std::pop_heap(nodes.begin(), nodes.end(), std::greater<std::pair<double, uint32_t>>());
+        const std::pair<double, uint32_t> item = nodes.back();
+        nodes.pop_back();
+        if (hit.object != nullptr && item.first >= hit.t)
+        {
+            break;
+        }
+
+        const Collision::QuadTree::Node &node = _nodes[item.second];
+        for (uint32_t element = node.first; element != NULL_INDEX; element = _elements[element].next)
+        {
+            const uint32_t index = _elements[element].index;
+            const Geometry::AABBRect &rect = _rects[index];
+            if (Collision::raycast(origin, dir, hit.t, rect.left(), rect.top(), rect.right(), rect.bottom(), enter, exit)
+                && Collision::raycast(_objects[index], origin, dir, hit.t, current) && (hit.object == nullptr || current.t < hit.t))
+            {
+                hit = current;
+            }
+        }
+        for (uint32_t i = 0; node.children != 0 && i < 4; ++i)
+        {
+            if (raycast(_nodes[node.children + i], origin, dir, hit.t, enter))
+            {
+                nodes.emplace_back(enter, node.children + i);
+                std::push_heap(nodes.begin(), nodes.end(), std::greater<std::pair<double, uint32_t>>());
+            }
+        }
+    }
+    return hit.object != nullptr;
 }
 
-bool Collision::QuadTree::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+bool Collision::QuadTree::raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    std::vector<Collision::RaycastHit> &hits) const
 {
-    return _root != nullptr && _root->find_collision_pairs(pairs, norepeat);
+    const size_t size = hits.size();
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    double enter, exit;
+    Collision::RaycastHit hit;
+    std::vector<uint32_t> nodes({0});
+    while (!nodes.empty())
+    {
+        const Collision::QuadTree::Node &node = _nodes[nodes.back()];
+        nodes.pop_back();
+        if (!raycast(node, origin, dir, max_t, enter))
+        {
+            continue;
+        }
+        for (uint32_t element = node.first; element != NULL_INDEX; element = _elements[element].next)
+        {
+            const uint32_t index = _elements[element].index;
+            const Geometry::AABBRect &rect = _rects[index];
+            if (Collision::raycast(origin, dir, max_t, rect.left(), rect.top(), rect.right(), rect.bottom(), enter, exit)
+                && Collision::raycast(_objects[index], origin, dir, max_t, hit))
+            {
+                hits.push_back(hit);
+            }
+        }
+        for (uint32_t i = 0; node.children != 0 && i < 4; ++i)
+        {
+            nodes.push_back(node.children + i);
+        }
+    }
+    Collision::sort_raycast_hits(hits, size);
+    return hits.size() > size;
 }
\ No newline at end of file
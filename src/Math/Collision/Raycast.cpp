@@ -0,0 +1,330 @@
+#include <cmath>
+#include <algorithm>
+#include "Math/Collision/Raycast.hpp"
+#include "Math/Collision/Algorithm.hpp"
+#include "Math/Geometry/Algorithm.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+// 射线与线段ab的交点,平行时视为不相交
+static bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const Geometry::Point &a, const Geometry::Point &b,
+    double &t, Geometry::Vector &normal)
+{
+    const Geometry::Vector edge = b - a, offset = a - origin;
+    const double denom = dir.cross(edge);
+    if (denom == 0)
+    {
+        return false;
+    }
+    const double value = offset.cross(edge) / denom, u = offset.cross(dir) / denom;
+    if (value < 0 || u < 0 || u > 1)
+    {
+        return false;
+    }
+    t = value;
+    normal.x = edge.y;
+    normal.y = -edge.x;
+    if (normal * dir > 0)
+    {
+        normal *= -1;
+    }
+    normal.normalize();
+    return true;
+}
+
+// 沿points的各条边求最近的交点,count个点依次相连,closed为true时首尾相连
+template <typename T>
+static bool raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const T &points, const size_t count, const bool closed,
+    double max_t, Collision::RaycastHit &hit)
+{
+    bool result = false;
+    double t;
+    Geometry::Vector normal;
+    for (size_t i = closed ? 0 : 1; i < count; ++i)
+    {
+        if (raycast(origin, dir, points[i == 0 ? count - 1 : i - 1], points[i], t, normal) && t <= max_t)
+        {
+            max_t = t;
+            hit.t = t;
+            hit.normal = normal;
+            result = true;
+        }
+    }
+    return result;
+}
+
+bool Collision::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    const double left, const double top, const double right, const double bottom, double &enter, double &exit)
+{
+    enter = 0;
+    exit = max_t;
+    if (dir.x == 0)
+    {
+        if (origin.x < left || origin.x > right)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        double t0 = (left - origin.x) / dir.x, t1 = (right - origin.x) / dir.x;
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+    }
+    if (dir.y == 0)
+    {
+        if (origin.y < bottom || origin.y > top)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        double t0 = (bottom - origin.y) / dir.y, t1 = (top - origin.y) / dir.y;
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+    }
+    return enter <= exit;
+}
+
+bool Collision::raycast(Geometry::GeometryObject *object, const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    Collision::RaycastHit &hit)
+{
+    if (max_t < 0)
+    {
+        return false;
+    }
+
+    bool inside = false, result = false;
+    switch (object->type())
+    {
+    case Geometry::Type::POLYGON:
+        {
+            const Geometry::Polygon &polygon = *static_cast<const Geometry::Polygon *>(object);
+            inside = Geometry::is_inside(origin, polygon, true);
+            // 多边形首尾点相同
+            result = !inside && ::raycast(origin, dir, polygon, polygon.size(), false, max_t, hit);
+        }
+        break;
+    case Geometry::Type::RECTANGLE:
+    case Geometry::Type::AABBRECT:
+    case Geometry::Type::SQUARE:
+        {
+            const Geometry::Rectangle &rect = *static_cast<const Geometry::Rectangle *>(object);
+            inside = Geometry::is_inside(origin, rect, true);
+            result = !inside && ::raycast(origin, dir, rect, 4, true, max_t, hit);
+        }
+        break;
+    case Geometry::Type::TRIANGLE:
+        {
+            const Geometry::Triangle &triangle = *static_cast<const Geometry::Triangle *>(object);
+            inside = Geometry::is_inside(origin, triangle, true);
+            result = !inside && ::raycast(origin, dir, triangle, 3, true, max_t, hit);
+        }
+        break;
+    case Geometry::Type::CIRCLE:
+        {
+            const Geometry::Circle &circle = *static_cast<const Geometry::Circle *>(object);
+            const Geometry::Vector offset = origin - circle;
+            const double a = dir * dir, b = offset * dir, c = offset * offset - circle.radius * circle.radius;
+            inside = c <= 0;
+            const double discriminant = b * b - a * c;
+            if (!inside && a > 0 && discriminant >= 0)
+            {
+                const double t = (-b - std::sqrt(discriminant)) / a;
+                if (t >= 0 && t <= max_t)
+                {
+                    hit.t = t;
+                    hit.normal = (origin + dir * t - circle).normalize();
+                    result = true;
+                }
+            }
+        }
+        break;
+    case Geometry::Type::POLYLINE:
+        {
+            const Geometry::Polyline &polyline = *static_cast<const Geometry::Polyline *>(object);
+            result = ::raycast(origin, dir, polyline, polyline.size(), false, max_t, hit);
+        }
+        break;
+    case Geometry::Type::BEZIER:
+        {
+            const Geometry::Polyline &shape = static_cast<const Geometry::Bezier *>(object)->shape();
+            result = ::raycast(origin, dir, shape, shape.size(), false, max_t, hit);
+        }
+        break;
+    case Geometry::Type::LINE:
+        {
+            const Geometry::Line &line = *static_cast<const Geometry::Line *>(object);
+            const Geometry::Point points[2] = {line.front(), line.back()};
+            result = ::raycast(origin, dir, points, 2, false, max_t, hit);
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (inside)
+    {
+        hit.t = 0;
+        hit.normal = dir * -1;
+        if (hit.normal.x != 0 || hit.normal.y != 0)
+        {
+            hit.normal.normalize();
+        }
+        result = true;
+    }
+    if (result)
+    {
+        hit.object = object;
+        hit.point = origin + dir * hit.t;
+    }
+    return result;
+}
+
+bool Collision::raycast(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+    const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, Collision::RaycastHit &hit)
+{
+    hit = Collision::RaycastHit();
+    hit.t = max_t;
+    double enter, exit;
+    std::vector<std::pair<double, size_t>> candidates;
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        if (objects[i] != nullptr && Collision::raycast(origin, dir, max_t, rects[i].left(), rects[i].top(), rects[i].right(), rects[i].bottom(), enter, exit))
+        {
+            candidates.emplace_back(enter, i);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    Collision::RaycastHit current;
+    for (const std::pair<double, size_t> &candidate : candidates)
+    {
+        if (hit.object != nullptr && candidate.first >= hit.t)
+        {
+            break;
+        }
+        if (Collision::raycast(objects[candidate.second], origin, dir, hit.t, current) && (hit.object == nullptr || current.t < hit.t))
+        {
+            hit = current;
+        }
+    }
+    return hit.object != nullptr;
+}
+
+bool Collision::raycast_all(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects,
+    const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, std::vector<Collision::RaycastHit> &hits)
+{
+    const size_t size = hits.size();
+    double enter, exit;
+    Collision::RaycastHit hit;
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        if (objects[i] != nullptr && Collision::raycast(origin, dir, max_t, rects[i].left(), rects[i].top(), rects[i].right(), rects[i].bottom(), enter, exit)
+            && Collision::raycast(objects[i], origin, dir, max_t, hit))
+        {
+            hits.push_back(hit);
+        }
+    }
+    std::sort(hits.begin() + size, hits.end(), [](const Collision::RaycastHit &hit0, const Collision::RaycastHit &hit1)
+        { return hit0.t < hit1.t; });
+    return hits.size() > size;
+}
+
+bool Collision::shape_cast(const Geometry::GeometryObject *object, const double tx, const double ty,
+    const std::vector<Geometry::GeometryObject *> &objects, Collision::RaycastHit &hit)
+{
+    hit = Collision::RaycastHit();
+    hit.t = 1;
+    const Geometry::AABBRect rect(object->bounding_rect());
+    const Geometry::Point center((rect.left() + rect.right()) / 2, (rect.top() + rect.bottom()) / 2);
+    const double half_width = (rect.right() - rect.left()) / 2, half_height = (rect.top() - rect.bottom()) / 2;
+    const Geometry::Vector dir(tx, ty);
+
+    // 扫掠的AABB矩形与对象AABB矩形相交等价于中心点的射线与扩大后的矩形相交
+    double enter, exit;
+    std::vector<std::pair<double, size_t>> candidates;
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        if (objects[i] == nullptr || objects[i] == object)
+        {
+            continue;
+        }
+        const Geometry::AABBRect bounds(objects[i]->bounding_rect());
+        if (Collision::raycast(center, dir, 1, bounds.left() - half_width, bounds.top() + half_height,
+            bounds.right() + half_width, bounds.bottom() - half_height, enter, exit))
+        {
+            candidates.emplace_back(enter, i);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    double t;
+    Geometry::Point point;
+    Geometry::Vector normal;
+    for (const std::pair<double, size_t> &candidate : candidates)
+    {
+        if (hit.object != nullptr && candidate.first >= hit.t)
+        {
+            break;
+        }
+        if (Collision::shape_cast(object, objects[candidate.second], tx, ty, t, point, normal) && (hit.object == nullptr || t < hit.t))
+        {
+            hit.object = objects[candidate.second];
+            hit.point = point;
+            hit.normal = normal;
+            hit.t = t;
+        }
+    }
+    return hit.object != nullptr;
+}
+
+bool Collision::shape_cast_all(const Geometry::GeometryObject *object, const double tx, const double ty,
+    const std::vector<Geometry::GeometryObject *> &objects, std::vector<Collision::RaycastHit> &hits)
+{
+    const size_t size = hits.size();
+    const Geometry::AABBRect rect(object->bounding_rect());
+    const Geometry::Point center((rect.left() + rect.right()) / 2, (rect.top() + rect.bottom()) / 2);
+    const double half_width = (rect.right() - rect.left()) / 2, half_height = (rect.top() - rect.bottom()) / 2;
+    const Geometry::Vector dir(tx, ty);
+    double enter, exit;
+    Collision::RaycastHit hit;
+    for (Geometry::GeometryObject *current : objects)
+    {
+        if (current == nullptr || current == object)
+        {
+            continue;
+        }
+        const Geometry::AABBRect bounds(current->bounding_rect());
+        if (Collision::raycast(center, dir, 1, bounds.left() - half_width, bounds.top() + half_height,
+            bounds.right() + half_width, bounds.bottom() - half_height, enter, exit)
+            && Collision::shape_cast(object, current, tx, ty, hit.t, hit.point, hit.normal))
+        {
+            hit.object = current;
+            hits.push_back(hit);
+        }
+    }
+    Collision::sort_raycast_hits(hits, size);
+    return hits.size() > size;
+}
+
+void Collision::sort_raycast_hits(std::vector<Collision::RaycastHit> &hits, const size_t begin)
+{
+    // 同一对象的交点相同,保留一个即可
+    std::sort(hits.begin() + begin, hits.end(), [](const Collision::RaycastHit &hit0, const Collision::RaycastHit &hit1)
+        { return hit0.object < hit1.object; });
+    hits.erase(std::unique(hits.begin() + begin, hits.end(), [](const Collision::RaycastHit &hit0, const Collision::RaycastHit &hit1)
+        { return hit0.object == hit1.object; }), hits.end());
+    std::sort(hits.begin() + begin, hits.end(), [](const Collision::RaycastHit &hit0, const Collision::RaycastHit &hit1)
+        { return hit0.t < hit1.t; });
+}
\ No newline at end of file
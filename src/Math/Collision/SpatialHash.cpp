@@ -0,0 +1,647 @@
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "Math/Collision/SpatialHash.hpp"
+#include "Math/Collision/Algorithm.hpp"
+#include "Math/Geometry/Algorithm.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+bool Collision::SpatialHash::CellKey::operator==(const Collision::SpatialHash::CellKey &key) const
+{
+    return x == key.x && y == key.y;
+}
+
+size_t Collision::SpatialHash::CellKeyHash::operator()(const Collision::SpatialHash::CellKey &key) const
+{
+    unsigned long long value = static_cast<unsigned long long>(key.x) * 0x9E3779B97F4A7C15ULL;
+    value ^= static_cast<unsigned long long>(key.y) + 0x7F4A7C159E3779B9ULL + (value << 6) + (value >> 2);
+    return static_cast<size_t>(value ^ (value >> 32));
+}
+
+
+Collision::SpatialHash::SpatialHash()
+{
+
+}
+
+Collision::SpatialHash::SpatialHash(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    build(objects);
+}
+
+Collision::SpatialHash::SpatialHash(const std::initializer_list<Geometry::GeometryObject *> &objects)
+{
+    build(std::vector<Geometry::GeometryObject *>(objects.begin(), objects.end()));
+}
+
+Collision::SpatialHash::SpatialHash(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    build(begin, end);
+}
+
+Collision::SpatialHash::CellRange Collision::SpatialHash::cell_range(const Geometry::AABBRect &rect) const
+{
+    Collision::SpatialHash::CellRange range;
+    range.left = static_cast<long long>(std::floor(rect.left() / _cell_size));
+    range.top = static_cast<long long>(std::floor(rect.top() / _cell_size));
+    range.right = static_cast<long long>(std::floor(rect.right() / _cell_size));
+    range.bottom = static_cast<long long>(std::floor(rect.bottom() / _cell_size));
+    return range;
+}
+
+bool Collision::SpatialHash::is_large(const Collision::SpatialHash::CellRange &range) const
+{
+    return static_cast<unsigned long long>(range.right - range.left + 1) * static_cast<unsigned long long>(range.top - range.bottom + 1)
+        > Collision::SpatialHash::MAX_CELLS_PER_OBJECT;
+}
+
+void Collision::SpatialHash::insert_cells(const size_t index)
+{
+    const Collision::SpatialHash::CellRange &range = _ranges[index];
+    if (is_large(range))
+    {
+        _large_objects.push_back(index);
+        return;
+    }
+
+    if (_cells.empty())
+    {
+        _bounds = range;
+    }
+    else
+    {
+        _bounds.left = std::min(_bounds.left, range.left);
+        _bounds.top = std::max(_bounds.top, range.top);
+        _bounds.right = std::max(_bounds.right, range.right);
+        _bounds.bottom = std::min(_bounds.bottom, range.bottom);
+    }
+
+    Collision::SpatialHash::CellKey key;
+    for (key.x = range.left; key.x <= range.right; ++key.x)
+    {
+        for (key.y = range.bottom; key.y <= range.top; ++key.y)
+        {
+            _cells[key].push_back(index);
+        }
+    }
+}
+
+void Collision::SpatialHash::remove_cells(const size_t index)
+{
+    const Collision::SpatialHash::CellRange &range = _ranges[index];
+    if (is_large(range))
+    {
+        std::vector<size_t>::iterator it = std::find(_large_objects.begin(), _large_objects.end(), index);
+        if (it != _large_objects.end())
+        {
+            *it = _large_objects.back();
+            _large_objects.pop_back();
+        }
+        return;
+    }
+
+    Collision::SpatialHash::CellKey key;
+    for (key.x = range.left; key.x <= range.right; ++key.x)
+    {
+        for (key.y = range.bottom; key.y <= range.top; ++key.y)
+        {
+            std::unordered_map<CellKey, std::vector<size_t>, CellKeyHash>::iterator cell = _cells.find(key);
+            if (cell == _cells.end())
+            {
+                continue;
+            }
+            std::vector<size_t>::iterator it = std::find(cell->second.begin(), cell->second.end(), index);
+            if (it != cell->second.end())
+            {
+                *it = cell->second.back();
+                cell->second.pop_back();
+            }
+            if (cell->second.empty())
+            {
+                _cells.erase(cell);
+            }
+        }
+    }
+}
+
+void Collision::SpatialHash::rebuild_cells()
+{
+    _cells.clear();
+    _large_objects.clear();
+
+    std::vector<double> sizes;
+    sizes.reserve(_rects.size());
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            sizes.push_back(std::max(_rects[i].width(), _rects[i].height()));
+        }
+    }
+    _sized_count = sizes.size();
+    if (sizes.empty())
+    {
+        return;
+    }
+
+    // 单元格边长取AABB矩形边长中位数的两倍,大部分对象最多占据4个单元格
+    std::nth_element(sizes.begin(), sizes.begin() + sizes.size() / 2, sizes.end());
+    _cell_size = sizes[sizes.size() / 2] * 2;
+    if (_cell_size <= Geometry::EPSILON)
+    {
+        _cell_size = std::max(*std::max_element(sizes.begin(), sizes.end()), 1.0);
+    }
+    _cells.reserve(sizes.size());
+
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            _ranges[i] = cell_range(_rects[i]);
+            insert_cells(i);
+        }
+    }
+}
+
+template <typename F>
+void Collision::SpatialHash::traverse(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, const F &visit) const
+{
+    if (_cells.empty())
+    {
+        return;
+    }
+
+    double enter = 0, exit = max_t;
+    const bool clipped = !((std::abs(dir.x) + std::abs(dir.y)) * max_t / _cell_size <= _cells.size());
+    if (clipped && !Collision::raycast(origin, dir, max_t, _bounds.left * _cell_size, (_bounds.top + 1) * _cell_size,
+        (_bounds.right + 1) * _cell_size, _bounds.bottom * _cell_size, enter, exit))
+    {
+        return;
+    }
+
+    const Geometry::Point start = origin + dir * enter;
+    Collision::SpatialHash::CellKey key;
+    key.x = static_cast<long long>(std::floor(start.x / _cell_size));
+    key.y = static_cast<long long>(std::floor(start.y / _cell_size));
+    if (clipped)
+    {
+        key.x = std::clamp(key.x, _bounds.left, _bounds.right);
+        key.y = std::clamp(key.y, _bounds.bottom, _bounds.top);
+    }
+    double next_x = DBL_MAX, next_y = DBL_MAX, delta_x = 0, delta_y = 0;
+    if (dir.x != 0)
+    {
+        next_x = ((key.x + (dir.x > 0 ? 1 : 0)) * _cell_size - origin.x) / dir.x;
+        delta_x = _cell_size / std::abs(dir.x);
+    }
+    if (dir.y != 0)
+    {
+        next_y = ((key.y + (dir.y > 0 ? 1 : 0)) * _cell_size - origin.y) / dir.y;
+        delta_y = _cell_size / std::abs(dir.y);
+    }
+
+    while (true)
+    {
+        const double leave = std::min(std::min(next_x, next_y), exit);
+        std::unordered_map<CellKey, std::vector<size_t>, CellKeyHash>::const_iterator cell = _cells.find(key);
+        if (visit(cell == _cells.end() ? nullptr : &cell->second, leave) || leave >= exit)
+        {
+            return;
+        }
+        if (next_x < next_y)
+        {
+            key.x += dir.x > 0 ? 1 : -1;
+            next_x += delta_x;
+        }
+        else
+        {
+            key.y += dir.y > 0 ? 1 : -1;
+            next_y += delta_y;
+        }
+    }
+}
+
+void Collision::SpatialHash::collect_candidates(const Geometry::AABBRect &rect, std::vector<size_t> &indexs) const
+{
+    const Collision::SpatialHash::CellRange range = cell_range(rect);
+    const unsigned long long cell_count = static_cast<unsigned long long>(range.right - range.left + 1)
+        * static_cast<unsigned long long>(range.top - range.bottom + 1);
+    if (cell_count > _cells.size())
+    {
+        // 查询范围覆盖的单元格多于已占用的单元格,直接遍历已占用的单元格
+        for (const std::pair<const CellKey, std::vector<size_t>> &cell : _cells)
+        {
+            if (cell.first.x >= range.left && cell.first.x <= range.right
+                && cell.first.y >= range.bottom && cell.first.y <= range.top)
+            {
+                indexs.insert(indexs.end(), cell.second.begin(), cell.second.end());
+            }
+        }
+    }
+    else
+    {
+        Collision::SpatialHash::CellKey key;
+        for (key.x = range.left; key.x <= range.right; ++key.x)
+        {
+            for (key.y = range.bottom; key.y <= range.top; ++key.y)
+            {
+                std::unordered_map<CellKey, std::vector<size_t>, CellKeyHash>::const_iterator cell = _cells.find(key);
+                if (cell != _cells.end())
+                {
+                    indexs.insert(indexs.end(), cell->second.begin(), cell->second.end());
+                }
+            }
+        }
+    }
+    indexs.insert(indexs.end(), _large_objects.begin(), _large_objects.end());
+}
+
+void Collision::SpatialHash::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    _objects.clear();
+    _rects.clear();
+    _ranges.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+    {
+        if (_indexs.emplace(*it, _objects.size()).second)
+        {
+            _objects.push_back(*it);
+            _rects.emplace_back((*it)->bounding_rect());
+        }
+    }
+    _ranges.resize(_objects.size());
+    rebuild_cells();
+}
+
+void Collision::SpatialHash::build(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    if (&objects == &_objects)
+    {
+        return update();
+    }
+    build(objects.cbegin(), objects.cend());
+}
+
+void Collision::SpatialHash::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
+{
+    if (&objects != &_objects)
+    {
+        _objects.clear();
+        _rects.clear();
+        _free_indexs.clear();
+        _indexs.clear();
+        _filter.clear();
+        for (size_t i = 0, count = objects.size(); i < count; ++i)
+        {
+            if (_indexs.emplace(objects[i], _objects.size()).second)
+            {
+                _objects.push_back(objects[i]);
+                _rects.emplace_back(rects[i]);
+            }
+        }
+    }
+    _ranges.resize(_objects.size());
+    rebuild_cells();
+}
+
+size_t Collision::SpatialHash::append(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        return it->second;
+    }
+
+    size_t index = _objects.size();
+    if (_free_indexs.empty())
+    {
+        _objects.push_back(object);
+        _rects.emplace_back(object->bounding_rect());
+        _ranges.emplace_back();
+    }
+    else
+    {
+        index = _free_indexs.back();
+        _free_indexs.pop_back();
+        _objects[index] = object;
+        _rects[index] = object->bounding_rect();
+    }
+    _indexs[object] = index;
+
+    // 只按最初几个对象决定的单元格边长可能与之后的对象相差很大,数量翻倍时重建的总开销均摊为O(1)
+    if (_indexs.size() >= 2 * _sized_count)
+    {
+        rebuild_cells();
+        return index;
+    }
+    _ranges[index] = cell_range(_rects[index]);
+    insert_cells(index);
+    return index;
+}
+
+void Collision::SpatialHash::remove(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    remove_cells(index);
+    _filter.reset(it->second);
+    _indexs.erase(it);
+    _objects[index] = nullptr;
+    _free_indexs.push_back(index);
+}
+
+void Collision::SpatialHash::update(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    _rects[index] = object->bounding_rect();
+    const Collision::SpatialHash::CellRange range = cell_range(_rects[index]);
+    if (range.left == _ranges[index].left && range.top == _ranges[index].top
+        && range.right == _ranges[index].right && range.bottom == _ranges[index].bottom)
+    {
+        return;
+    }
+
+    remove_cells(index);
+    _ranges[index] = range;
+    insert_cells(index);
+}
+
+void Collision::SpatialHash::update()
+{
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            _rects[i] = _objects[i]->bounding_rect();
+        }
+    }
+    rebuild_cells();
+}
+
+bool Collision::SpatialHash::has(Geometry::GeometryObject *object) const
+{
+    return _indexs.find(object) != _indexs.end();
+}
+
+void Collision::SpatialHash::clear()
+{
+    _cells.clear();
+    _large_objects.clear();
+    _objects.clear();
+    _rects.clear();
+    _ranges.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+    _sized_count = 0;
+}
+
+double Collision::SpatialHash::cell_size() const
+{
+    return _cell_size;
+}
+
+bool Collision::SpatialHash::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    const size_t size = objects.size();
+    Collision::SpatialHash::CellKey key;
+    key.x = static_cast<long long>(std::floor(pos.x / _cell_size));
+    key.y = static_cast<long long>(std::floor(pos.y / _cell_size));
+    std::unordered_map<CellKey, std::vector<size_t>, CellKeyHash>::const_iterator cell = _cells.find(key);
+    if (cell != _cells.end())
+    {
+        for (const size_t index : cell->second)
+        {
+            if (Geometry::is_inside(pos, _rects[index], true)
+                && Geometry::NoAABBTest::is_intersected(_objects[index], &pos))
+            {
+                objects.push_back(_objects[index]);
+            }
+        }
+    }
+    for (const size_t index : _large_objects)
+    {
+        if (Geometry::is_inside(pos, _rects[index], true)
+            && Geometry::NoAABBTest::is_intersected(_objects[index], &pos))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::SpatialHash::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    std::vector<size_t> indexs;
+    collect_candidates(rect, indexs);
+    std::sort(indexs.begin(), indexs.end());
+    indexs.erase(std::unique(indexs.begin(), indexs.end()), indexs.end());
+
+    const size_t size = objects.size();
+    for (const size_t index : indexs)
+    {
+        if (Geometry::is_intersected(rect, _rects[index])
+            && Geometry::NoAABBTest::is_intersected(rect, _objects[index]))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+const Collision::CollisionLayer &Collision::SpatialHash::layer(const Geometry::GeometryObject *object) const
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(const_cast<Geometry::GeometryObject *>(object));
+    return it == _indexs.end() ? Collision::CollisionFilter::default_layer() : _filter.layer(it->second);
+}
+
+void Collision::SpatialHash::set_layer(Geometry::GeometryObject *object, const Collision::CollisionLayer &layer)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        _filter.set_layer(it->second, layer);
+    }
+}
+
+bool Collision::SpatialHash::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool norepeat) const
+{
+    if (object == nullptr)
+    {
+        return false;
+    }
+
+    const Geometry::AABBRect rect(object->bounding_rect());
+    std::vector<size_t> indexs;
+    collect_candidates(rect, indexs);
+    if (norepeat)
+    {
+        std::sort(indexs.begin(), indexs.end());
+        indexs.erase(std::unique(indexs.begin(), indexs.end()), indexs.end());
+    }
+
+    const size_t size = objects.size();
+    const Collision::CollisionLayer &layer = this->layer(object);
+    for (const size_t index : indexs)
+    {
+        const Geometry::GeometryObject *current_object = _objects[index];
+        if (current_object != object && Geometry::is_intersected(rect, _rects[index])
+            && _filter.accepts(layer, index) && Collision::gjk(current_object, object))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::SpatialHash::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    const bool norepeat, const bool narrow) const
+{
+    const size_t size = pairs.size();
+    for (const std::pair<const CellKey, std::vector<size_t>> &cell : _cells)
+    {
+        const std::vector<size_t> &indexs = cell.second;
+        for (size_t i = 0, count = indexs.size(); i < count; ++i)
+        {
+            const size_t index0 = indexs[i];
+            for (size_t j = i + 1; j < count; ++j)
+            {
+                const size_t index1 = indexs[j];
+                if (!Geometry::is_intersected(_rects[index0], _rects[index1]))
+                {
+                    continue;
+                }
+                // 重叠区域左下角所在的单元格才输出该对,避免跨单元格的重复
+                if (norepeat && (cell.first.x != std::max(_ranges[index0].left, _ranges[index1].left)
+                    || cell.first.y != std::max(_ranges[index0].bottom, _ranges[index1].bottom)))
+                {
+                    continue;
+                }
+                if (!_filter.accepts(index0, index1))
+                {
+                    continue;
+                }
+                const Geometry::GeometryObject *object0 = _objects[index0], *object1 = _objects[index1];
+                if (!narrow || Collision::gjk(object0, object1))
+                {
+                    pairs.emplace_back(_objects[index0], _objects[index1]);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0, count = _large_objects.size(); i < count; ++i)
+    {
+        const size_t index0 = _large_objects[i];
+        const Geometry::GeometryObject *object0 = _objects[index0];
+        for (size_t index1 = 0, total = _objects.size(); index1 < total; ++index1)
+        {
+            // 两个大对象之间只检测一次
+            if (index1 == index0 || _objects[index1] == nullptr
+                || (is_large(_ranges[index1]) && index1 < index0)
+                || !Geometry::is_intersected(_rects[index0], _rects[index1]) || !_filter.accepts(index0, index1))
+            {
+                continue;
+            }
+            const Geometry::GeometryObject *object1 = _objects[index1];
+            if (!narrow || Collision::gjk(object0, object1))
+            {
+                pairs.emplace_back(_objects[index0], _objects[index1]);
+            }
+        }
+    }
+
+    return pairs.size() > size;
+}
+
+bool Collision::SpatialHash::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+{
+    return find_collision_pairs(pairs, norepeat, true);
+}
+
+bool Collision::SpatialHash::find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
+{
+    return find_collision_pairs(pairs, true, false);
+}
+
+bool Collision::SpatialHash::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, Collision::RaycastHit &hit) const
+{
+    hit = Collision::RaycastHit();
+    hit.t = max_t;
+    double enter, exit;
+    Collision::RaycastHit current;
+    const auto test = [&](const size_t index)
+    {
+        const Geometry::AABBRect &rect = _rects[index];
+        if (Collision::raycast(origin, dir, hit.t, rect.left(), rect.top(), rect.right(), rect.bottom(), enter, exit)
+            && Collision::raycast(_objects[index], origin, dir, hit.t, current) && (hit.object == nullptr || current.t < hit.t))
+        {
+            hit = current;
+        }
+    };
+
+    for (const size_t index : _large_objects)
+    {
+        test(index);
+    }
+    traverse(origin, dir, max_t, [&](const std::vector<size_t> *indexs, const double leave)
+    {
+        for (size_t i = 0, count = indexs == nullptr ? 0 : indexs->size(); i < count; ++i)
+        {
+            test((*indexs)[i]);
+        }
+        // 之后的单元格中的交点都不早于leave
+        return hit.object != nullptr && hit.t <= leave;
+    });
+    return hit.object != nullptr;
+}
+
+bool Collision::SpatialHash::raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    std::vector<Collision::RaycastHit> &hits) const
+{
+    const size_t size = hits.size();
+    double enter, exit;
+    Collision::RaycastHit hit;
+    const auto test = [&](const size_t index)
+    {
+        const Geometry::AABBRect &rect = _rects[index];
+        if (Collision::raycast(origin, dir, max_t, rect.left(), rect.top(), rect.right(), rect.bottom(), enter, exit)
+            && Collision::raycast(_objects[index], origin, dir, max_t, hit))
+        {
+            hits.push_back(hit);
+        }
+    };
+
+    for (const size_t index : _large_objects)
+    {
+        test(index);
+    }
+    traverse(origin, dir, max_t, [&](const std::vector<size_t> *indexs, const double)
+    {
+        for (size_t i = 0, count = indexs == nullptr ? 0 : indexs->size(); i < count; ++i)
+        {
+            test((*indexs)[i]);
+        }
+        return false;
+    });
+    Collision::sort_raycast_hits(hits, size);
+    return hits.size() > size;
+}
\ No newline at end of file
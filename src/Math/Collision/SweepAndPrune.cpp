@@ -0,0 +1,550 @@
+#include <algorithm>
+#include "Math/Collision/SweepAndPrune.hpp"
+#include "Math/Collision/Algorithm.hpp"
+#include "Math/Geometry/Algorithm.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+bool Collision::SweepAndPrune::Endpoint::operator<(const Collision::SweepAndPrune::Endpoint &endpoint) const
+{
+    return value < endpoint.value || (value == endpoint.value && !is_max && endpoint.is_max);
+}
+
+
+Collision::SweepAndPrune::SweepAndPrune()
+{
+
+}
+
+Collision::SweepAndPrune::SweepAndPrune(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    build(objects);
+}
+
+Collision::SweepAndPrune::SweepAndPrune(const std::initializer_list<Geometry::GeometryObject *> &objects)
+{
+    build(std::vector<Geometry::GeometryObject *>(objects.begin(), objects.end()));
+}
+
+Collision::SweepAndPrune::SweepAndPrune(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    build(begin, end);
+}
+
+unsigned long long Collision::SweepAndPrune::pair_key(const size_t index0, const size_t index1)
+{
+    if (index0 < index1)
+    {
+        return (static_cast<unsigned long long>(index0) << 32) | static_cast<unsigned long long>(index1);
+    }
+    else
+    {
+        return (static_cast<unsigned long long>(index1) << 32) | static_cast<unsigned long long>(index0);
+    }
+}
+
+bool Collision::SweepAndPrune::is_overlapped(const size_t index0, const size_t index1) const
+{
+    const Collision::SweepAndPrune::EndpointIndex &endpoint0 = _endpoint_indexs[index0], &endpoint1 = _endpoint_indexs[index1];
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        if (_endpoints[axis][endpoint0.max[axis]].value < _endpoints[axis][endpoint1.min[axis]].value
+            || _endpoints[axis][endpoint1.max[axis]].value < _endpoints[axis][endpoint0.min[axis]].value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Collision::SweepAndPrune::set_endpoint_values(const size_t index)
+{
+    const Geometry::AABBRect &rect = _rects[index];
+    const Collision::SweepAndPrune::EndpointIndex &endpoint = _endpoint_indexs[index];
+    _endpoints[0][endpoint.min[0]].value = rect.left();
+    _endpoints[0][endpoint.max[0]].value = rect.right();
+    _endpoints[1][endpoint.min[1]].value = rect.bottom();
+    _endpoints[1][endpoint.max[1]].value = rect.top();
+    _max_width = std::max(_max_width, rect.width());
+}
+
+void Collision::SweepAndPrune::swap_endpoints(const size_t axis, const size_t pos0, const size_t pos1)
+{
+    // pos1处的端点左移越过pos0处的端点
+    std::vector<Collision::SweepAndPrune::Endpoint> &endpoints = _endpoints[axis];
+    const Collision::SweepAndPrune::Endpoint &left = endpoints[pos0], &right = endpoints[pos1];
+    if (left.index != right.index)
+    {
+        if (!right.is_max && left.is_max)
+        {
+            if (is_overlapped(left.index, right.index))
+            {
+                _overlap_pairs.insert(pair_key(left.index, right.index));
+            }
+        }
+        else if (right.is_max && !left.is_max)
+        {
+            _overlap_pairs.erase(pair_key(left.index, right.index));
+        }
+    }
+
+    std::swap(endpoints[pos0], endpoints[pos1]);
+    if (endpoints[pos0].is_max)
+    {
+        _endpoint_indexs[endpoints[pos0].index].max[axis] = pos0;
+    }
+    else
+    {
+        _endpoint_indexs[endpoints[pos0].index].min[axis] = pos0;
+    }
+    if (endpoints[pos1].is_max)
+    {
+        _endpoint_indexs[endpoints[pos1].index].max[axis] = pos1;
+    }
+    else
+    {
+        _endpoint_indexs[endpoints[pos1].index].min[axis] = pos1;
+    }
+}
+
+void Collision::SweepAndPrune::move_endpoint(const size_t axis, size_t pos)
+{
+    const std::vector<Collision::SweepAndPrune::Endpoint> &endpoints = _endpoints[axis];
+    if (pos > 0 && endpoints[pos] < endpoints[pos - 1])
+    {
+        do
+        {
+            swap_endpoints(axis, pos - 1, pos);
+        } while (--pos > 0 && endpoints[pos] < endpoints[pos - 1]);
+    }
+    else
+    {
+        for (const size_t count = endpoints.size(); pos + 1 < count && endpoints[pos + 1] < endpoints[pos]; ++pos)
+        {
+            swap_endpoints(axis, pos, pos + 1);
+        }
+    }
+}
+
+void Collision::SweepAndPrune::sort_endpoints(const size_t axis)
+{
+    // 插入排序,帧间连续时端点大多已有序,代价接近O(n + 交换次数)
+    const std::vector<Collision::SweepAndPrune::Endpoint> &endpoints = _endpoints[axis];
+    for (size_t i = 1, count = endpoints.size(); i < count; ++i)
+    {
+        for (size_t pos = i; pos > 0 && endpoints[pos] < endpoints[pos - 1]; --pos)
+        {
+            swap_endpoints(axis, pos - 1, pos);
+        }
+    }
+}
+
+void Collision::SweepAndPrune::rebuild()
+{
+    _overlap_pairs.clear();
+    _max_width = 0;
+    _endpoint_indexs.assign(_objects.size(), Collision::SweepAndPrune::EndpointIndex());
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        std::vector<Collision::SweepAndPrune::Endpoint> &endpoints = _endpoints[axis];
+        endpoints.clear();
+        endpoints.reserve(_objects.size() * 2);
+        for (size_t i = 0, count = _objects.size(); i < count; ++i)
+        {
+            if (_objects[i] == nullptr)
+            {
+                continue;
+            }
+            endpoints.emplace_back();
+            endpoints.back().value = axis == 0 ? _rects[i].left() : _rects[i].bottom();
+            endpoints.back().index = i;
+            endpoints.emplace_back();
+            endpoints.back().value = axis == 0 ? _rects[i].right() : _rects[i].top();
+            endpoints.back().index = i;
+            endpoints.back().is_max = true;
+            if (axis == 0)
+            {
+                _max_width = std::max(_max_width, _rects[i].width());
+            }
+        }
+        std::sort(endpoints.begin(), endpoints.end());
+        for (size_t i = 0, count = endpoints.size(); i < count; ++i)
+        {
+            if (endpoints[i].is_max)
+            {
+                _endpoint_indexs[endpoints[i].index].max[axis] = i;
+            }
+            else
+            {
+                _endpoint_indexs[endpoints[i].index].min[axis] = i;
+            }
+        }
+    }
+
+    // 沿x轴扫描一遍得到初始的重叠对
+    std::vector<size_t> actives, active_indexs(_objects.size());
+    for (const Collision::SweepAndPrune::Endpoint &endpoint : _endpoints[0])
+    {
+        if (endpoint.is_max)
+        {
+            const size_t pos = active_indexs[endpoint.index];
+            actives[pos] = actives.back();
+            active_indexs[actives[pos]] = pos;
+            actives.pop_back();
+        }
+        else
+        {
+            for (const size_t index : actives)
+            {
+                if (is_overlapped(index, endpoint.index))
+                {
+                    _overlap_pairs.insert(pair_key(index, endpoint.index));
+                }
+            }
+            active_indexs[endpoint.index] = actives.size();
+            actives.push_back(endpoint.index);
+        }
+    }
+}
+
+void Collision::SweepAndPrune::collect_candidates(const Geometry::AABBRect &rect, std::vector<size_t> &indexs) const
+{
+    const std::vector<Collision::SweepAndPrune::Endpoint> &endpoints = _endpoints[0];
+    Collision::SweepAndPrune::Endpoint endpoint;
+    endpoint.value = rect.left() - _max_width;
+    for (std::vector<Collision::SweepAndPrune::Endpoint>::const_iterator it = std::lower_bound(endpoints.begin(), endpoints.end(), endpoint);
+        it != endpoints.end() && it->value <= rect.right(); ++it)
+    {
+        if (!it->is_max && _endpoints[0][_endpoint_indexs[it->index].max[0]].value >= rect.left())
+        {
+            indexs.push_back(it->index);
+        }
+    }
+}
+
+void Collision::SweepAndPrune::build(const std::vector<Geometry::GeometryObject *>::const_iterator &begin,
+    const std::vector<Geometry::GeometryObject *>::const_iterator &end)
+{
+    _objects.clear();
+    _rects.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+    for (std::vector<Geometry::GeometryObject *>::const_iterator it = begin; it != end; ++it)
+    {
+        if (_indexs.emplace(*it, _objects.size()).second)
+        {
+            _objects.push_back(*it);
+            _rects.emplace_back((*it)->bounding_rect());
+        }
+    }
+    rebuild();
+}
+
+void Collision::SweepAndPrune::build(const std::vector<Geometry::GeometryObject *> &objects)
+{
+    if (&objects == &_objects)
+    {
+        return update();
+    }
+    build(objects.cbegin(), objects.cend());
+}
+
+void Collision::SweepAndPrune::build(const std::vector<Geometry::GeometryObject *> &objects, const std::vector<Geometry::AABBRect> &rects)
+{
+    if (&objects != &_objects)
+    {
+        _objects.clear();
+        _rects.clear();
+        _free_indexs.clear();
+        _indexs.clear();
+        _filter.clear();
+        for (size_t i = 0, count = objects.size(); i < count; ++i)
+        {
+            if (_indexs.emplace(objects[i], _objects.size()).second)
+            {
+                _objects.push_back(objects[i]);
+                _rects.emplace_back(rects[i]);
+            }
+        }
+    }
+    rebuild();
+}
+
+size_t Collision::SweepAndPrune::append(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        return it->second;
+    }
+
+    size_t index = _objects.size();
+    if (_free_indexs.empty())
+    {
+        _objects.push_back(object);
+        _rects.emplace_back(object->bounding_rect());
+        _endpoint_indexs.emplace_back();
+    }
+    else
+    {
+        index = _free_indexs.back();
+        _free_indexs.pop_back();
+        _objects[index] = object;
+        _rects[index] = object->bounding_rect();
+    }
+    _indexs[object] = index;
+
+    // 新端点先放在末尾,此时与任何对象都不重叠,再插入排序到正确位置
+    Collision::SweepAndPrune::EndpointIndex &endpoint = _endpoint_indexs[index];
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        endpoint.min[axis] = _endpoints[axis].size();
+        _endpoints[axis].emplace_back();
+        _endpoints[axis].back().index = index;
+        endpoint.max[axis] = _endpoints[axis].size();
+        _endpoints[axis].emplace_back();
+        _endpoints[axis].back().index = index;
+        _endpoints[axis].back().is_max = true;
+    }
+    set_endpoint_values(index);
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        move_endpoint(axis, endpoint.min[axis]);
+        move_endpoint(axis, endpoint.max[axis]);
+    }
+    return index;
+}
+
+void Collision::SweepAndPrune::remove(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        std::vector<Collision::SweepAndPrune::Endpoint> &endpoints = _endpoints[axis];
+        const size_t min_pos = _endpoint_indexs[index].min[axis], max_pos = _endpoint_indexs[index].max[axis];
+        endpoints.erase(endpoints.begin() + max_pos);
+        endpoints.erase(endpoints.begin() + min_pos);
+        for (size_t i = min_pos, count = endpoints.size(); i < count; ++i)
+        {
+            if (endpoints[i].is_max)
+            {
+                _endpoint_indexs[endpoints[i].index].max[axis] = i;
+            }
+            else
+            {
+                _endpoint_indexs[endpoints[i].index].min[axis] = i;
+            }
+        }
+    }
+
+    for (std::unordered_set<unsigned long long>::iterator pair = _overlap_pairs.begin(); pair != _overlap_pairs.end();)
+    {
+        if ((*pair >> 32) == index || (*pair & 0xFFFFFFFFULL) == index)
+        {
+            pair = _overlap_pairs.erase(pair);
+        }
+        else
+        {
+            ++pair;
+        }
+    }
+
+    _filter.reset(it->second);
+    _indexs.erase(it);
+    _objects[index] = nullptr;
+    _free_indexs.push_back(index);
+}
+
+void Collision::SweepAndPrune::update(Geometry::GeometryObject *object)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::iterator it = _indexs.find(object);
+    if (it == _indexs.end())
+    {
+        return;
+    }
+
+    const size_t index = it->second;
+    const Collision::SweepAndPrune::EndpointIndex &endpoint = _endpoint_indexs[index];
+    const double left = _endpoints[0][endpoint.min[0]].value, bottom = _endpoints[1][endpoint.min[1]].value;
+    _rects[index] = object->bounding_rect();
+    set_endpoint_values(index);
+
+    // 向左移动时先移动min端点,向右移动时先移动max端点,避免越过自身的另一端点
+    if (_rects[index].left() < left)
+    {
+        move_endpoint(0, endpoint.min[0]);
+        move_endpoint(0, endpoint.max[0]);
+    }
+    else
+    {
+        move_endpoint(0, endpoint.max[0]);
+        move_endpoint(0, endpoint.min[0]);
+    }
+    if (_rects[index].bottom() < bottom)
+    {
+        move_endpoint(1, endpoint.min[1]);
+        move_endpoint(1, endpoint.max[1]);
+    }
+    else
+    {
+        move_endpoint(1, endpoint.max[1]);
+        move_endpoint(1, endpoint.min[1]);
+    }
+}
+
+void Collision::SweepAndPrune::update()
+{
+    for (size_t i = 0, count = _objects.size(); i < count; ++i)
+    {
+        if (_objects[i] != nullptr)
+        {
+            _rects[i] = _objects[i]->bounding_rect();
+            set_endpoint_values(i);
+        }
+    }
+    sort_endpoints(0);
+    sort_endpoints(1);
+}
+
+bool Collision::SweepAndPrune::has(Geometry::GeometryObject *object) const
+{
+    return _indexs.find(object) != _indexs.end();
+}
+
+void Collision::SweepAndPrune::clear()
+{
+    _endpoints[0].clear();
+    _endpoints[1].clear();
+    _endpoint_indexs.clear();
+    _overlap_pairs.clear();
+    _objects.clear();
+    _rects.clear();
+    _free_indexs.clear();
+    _indexs.clear();
+    _filter.clear();
+    _max_width = 0;
+}
+
+bool Collision::SweepAndPrune::select(const Geometry::Point &pos, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    std::vector<size_t> indexs;
+    collect_candidates(Geometry::AABBRect(pos.x, pos.y, pos.x, pos.y), indexs);
+
+    const size_t size = objects.size();
+    for (const size_t index : indexs)
+    {
+        if (Geometry::is_inside(pos, _rects[index], true)
+            && Geometry::NoAABBTest::is_intersected(_objects[index], &pos))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::SweepAndPrune::select(const Geometry::AABBRect &rect, std::vector<Geometry::GeometryObject *> &objects) const
+{
+    std::vector<size_t> indexs;
+    collect_candidates(rect, indexs);
+
+    const size_t size = objects.size();
+    for (const size_t index : indexs)
+    {
+        if (Geometry::is_intersected(rect, _rects[index])
+            && Geometry::NoAABBTest::is_intersected(rect, _objects[index]))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+const Collision::CollisionLayer &Collision::SweepAndPrune::layer(const Geometry::GeometryObject *object) const
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(const_cast<Geometry::GeometryObject *>(object));
+    return it == _indexs.end() ? Collision::CollisionFilter::default_layer() : _filter.layer(it->second);
+}
+
+void Collision::SweepAndPrune::set_layer(Geometry::GeometryObject *object, const Collision::CollisionLayer &layer)
+{
+    std::unordered_map<Geometry::GeometryObject *, size_t>::const_iterator it = _indexs.find(object);
+    if (it != _indexs.end())
+    {
+        _filter.set_layer(it->second, layer);
+    }
+}
+
+bool Collision::SweepAndPrune::find_collision_objects(const Geometry::GeometryObject *object, std::vector<Geometry::GeometryObject *> &objects, const bool /*norepeat*/) const
+{
+    if (object == nullptr)
+    {
+        return false;
+    }
+
+    const Geometry::AABBRect rect(object->bounding_rect());
+    std::vector<size_t> indexs;
+    collect_candidates(rect, indexs);
+
+    const size_t size = objects.size();
+    const Collision::CollisionLayer &layer = this->layer(object);
+    for (const size_t index : indexs)
+    {
+        const Geometry::GeometryObject *current_object = _objects[index];
+        if (current_object != object && Geometry::is_intersected(rect, _rects[index])
+            && _filter.accepts(layer, index) && Collision::gjk(current_object, object))
+        {
+            objects.push_back(_objects[index]);
+        }
+    }
+    return objects.size() > size;
+}
+
+bool Collision::SweepAndPrune::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs,
+    const bool /*norepeat*/, const bool narrow) const
+{
+    const size_t size = pairs.size();
+    for (const unsigned long long key : _overlap_pairs)
+    {
+        const size_t index0 = static_cast<size_t>(key >> 32), index1 = static_cast<size_t>(key & 0xFFFFFFFFULL);
+        if (!Geometry::is_intersected(_rects[index0], _rects[index1]) || !_filter.accepts(index0, index1))
+        {
+            continue;
+        }
+        const Geometry::GeometryObject *object0 = _objects[index0], *object1 = _objects[index1];
+        if (!narrow || Collision::gjk(object0, object1))
+        {
+            pairs.emplace_back(_objects[index0], _objects[index1]);
+        }
+    }
+    return pairs.size() > size;
+}
+
+bool Collision::SweepAndPrune::find_collision_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs, const bool norepeat) const
+{
+    return find_collision_pairs(pairs, norepeat, true);
+}
+
+bool Collision::SweepAndPrune::find_candidate_pairs(std::vector<std::pair<Geometry::GeometryObject *, Geometry::GeometryObject *>> &pairs) const
+{
+    return find_collision_pairs(pairs, true, false);
+}
+
+bool Collision::SweepAndPrune::raycast(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t, Collision::RaycastHit &hit) const
+{
+    return Collision::raycast(_objects, _rects, origin, dir, max_t, hit);
+}
+
+bool Collision::SweepAndPrune::raycast_all(const Geometry::Point &origin, const Geometry::Vector &dir, const double max_t,
+    std::vector<Collision::RaycastHit> &hits) const
+{
+    return Collision::raycast_all(_objects, _rects, origin, dir, max_t, hits);
+}
\ No newline at end of file
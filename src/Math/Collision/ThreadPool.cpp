@@ -0,0 +1,89 @@
+#include "Math/Collision/ThreadPool.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+Collision::ThreadPool::ThreadPool(const size_t count)
+{
+    for (size_t i = 1; i < count; ++i)
+    {
+        _threads.emplace_back(&Collision::ThreadPool::work, this, i);
+    }
+}
+
+Collision::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _start_condition.notify_all();
+    for (std::thread &thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void Collision::ThreadPool::work(const size_t thread)
+{
+    size_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _start_condition.wait(lock, [&]() { return _stop || _generation != generation; });
+            if (_stop)
+            {
+                return;
+            }
+            generation = _generation;
+        }
+
+        for (size_t i = _next_task.fetch_add(1); i < _task_count; i = _next_task.fetch_add(1))
+        {
+            _task(i, thread);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_running == 0)
+        {
+            _finish_condition.notify_one();
+        }
+    }
+}
+
+size_t Collision::ThreadPool::size() const
+{
+    return _threads.size() + 1;
+}
+
+void Collision::ThreadPool::run(const size_t count, const std::function<void(const size_t, const size_t)> &task)
+{
+    if (_threads.empty() || count < 2)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            task(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = task;
+        _task_count = count;
+        _next_task = 0;
+        _running = _threads.size();
+        ++_generation;
+    }
+    _start_condition.notify_all();
+
+    for (size_t i = _next_task.fetch_add(1); i < count; i = _next_task.fetch_add(1))
+    {
+        task(i, 0);
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finish_condition.wait(lock, [&]() { return _running == 0; });
+    _task = nullptr;
+}
\ No newline at end of file
@@ -5472,7 +5472,7 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result[j] = a;
+                        result.set_point(j, a);
                     }
                     a.x = a.y = std::numeric_limits<double>::infinity();
                     Geometry::is_intersected(result.next_point(result.next_point_index(j)),
@@ -5480,7 +5480,7 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result.next_point(result.next_point_index(j)) = a;
+                        result.set_point(result.next_point_index(result.next_point_index(j)), a);
                     }
                     result.remove(result.next_point_index(j));
                     --count;
@@ -5494,7 +5494,7 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
                     {
                         if (!std::isinf(a.x) && !std::isinf(a.y))
                         {
-                            result[j] = a;
+                            result.set_point(j, a);
                         }
                         result.remove(result.next_point_index(j));
                         --count;
@@ -5511,11 +5511,11 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
 
                         if ((temp.next_point(temp.next_point_index(i)) - temp.last_point(i)) * (a - b) < 0)
                         {
-                            result.next_point(result.next_point_index(j)) = a;
+                            result.set_point(result.next_point_index(result.next_point_index(j)), a);
                         }
                         else
                         {
-                            result.last_point(j) = b;
+                            result.set_point(result.last_point_index(j), b);
                         }
 
                         size_t temp_index = result.next_point_index(j);
@@ -5563,7 +5563,7 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result[j] = a;
+                        result.set_point(j, a);
                     }
                     a.x = a.y = std::numeric_limits<double>::infinity();
                     Geometry::is_intersected(result.next_point(result.next_point_index(j)),
@@ -5571,7 +5571,7 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result.next_point(result.next_point_index(j)) = a;
+                        result.set_point(result.next_point_index(result.next_point_index(j)), a);
                     }
                     result.remove(result.next_point_index(j));
                     --count;
@@ -5585,7 +5585,7 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
                     {
                         if (!std::isinf(a.x) && !std::isinf(a.y))
                         {
-                            result[j] = a;
+                            result.set_point(j, a);
                         }
                         result.remove(result.next_point_index(j));
                         --count;
@@ -5602,11 +5602,11 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
 
                         if ((temp.next_point(temp.next_point_index(i)) - temp.last_point(i)) * (a - b) < 0)
                         {
-                            result.next_point(result.next_point_index(j)) = a;
+                            result.set_point(result.next_point_index(result.next_point_index(j)), a);
                         }
                         else
                         {
-                            result.last_point(j) = b;
+                            result.set_point(result.last_point_index(j), b);
                         }
 
                         size_t temp_index = result.next_point_index(j);
@@ -5635,7 +5635,7 @@ bool Geometry::offset(const Geometry::Polygon &input, Geometry::Polygon &result,
             --count;
         }
     }
-    result.back() = result.front();
+    result.set_point(result.size() - 1, result.front());
 
     for (size_t i = 0, count = result.size() - 1; i < count; ++i)
     {
@@ -5702,7 +5702,7 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result[j] = a;
+                        result.set_point(j, a);
                     }
                     a.x = a.y = std::numeric_limits<double>::infinity();
                     Geometry::is_intersected(result.next_point(result.next_point_index(j)),
@@ -5710,7 +5710,7 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result.next_point(result.next_point_index(j)) = a;
+                        result.set_point(result.next_point_index(result.next_point_index(j)), a);
                     }
                     result.remove(result.next_point_index(j));
                     --count;
@@ -5724,7 +5724,7 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
                     {
                         if (!std::isinf(a.x) && !std::isinf(a.y))
                         {
-                            result[j] = a;
+                            result.set_point(j, a);
                         }
                         result.remove(result.next_point_index(j));
                         --count;
@@ -5741,11 +5741,11 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
 
                         if ((temp.next_point(temp.next_point_index(i)) - temp.last_point(i)) * (a - b) < 0)
                         {
-                            result.next_point(result.next_point_index(j)) = a;
+                            result.set_point(result.next_point_index(result.next_point_index(j)), a);
                         }
                         else
                         {
-                            result.last_point(j) = b;
+                            result.set_point(result.last_point_index(j), b);
                         }
 
                         size_t temp_index = result.next_point_index(j);
@@ -5793,7 +5793,7 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result[j] = a;
+                        result.set_point(j, a);
                     }
                     a.x = a.y = std::numeric_limits<double>::infinity();
                     Geometry::is_intersected(result.next_point(result.next_point_index(j)),
@@ -5801,7 +5801,7 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
                         temp[i] + b, temp.next_point(i) + b, a, true);
                     if (!std::isinf(a.x) && !std::isinf(a.y))
                     {
-                        result.next_point(result.next_point_index(j)) = a;
+                        result.set_point(result.next_point_index(result.next_point_index(j)), a);
                     }
                     result.remove(result.next_point_index(j));
                     --count;
@@ -5815,7 +5815,7 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
                     {
                         if (!std::isinf(a.x) && !std::isinf(a.y))
                         {
-                            result[j] = a;
+                            result.set_point(j, a);
                         }
                         result.remove(result.next_point_index(j));
                         --count;
@@ -5832,11 +5832,11 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
 
                         if ((temp.next_point(temp.next_point_index(i)) - temp.last_point(i)) * (a - b) < 0)
                         {
-                            result.next_point(result.next_point_index(j)) = a;
+                            result.set_point(result.next_point_index(result.next_point_index(j)), a);
                         }
                         else
                         {
-                            result.last_point(j) = b;
+                            result.set_point(result.last_point_index(j), b);
                         }
 
                         size_t temp_index = result.next_point_index(j);
@@ -5865,7 +5865,7 @@ bool Geometry::offset_test(const Geometry::Polygon &input, Geometry::Polygon &re
             --count;
         }
     }
-    result.back() = result.front();
+    result.set_point(result.size() - 1, result.front());
 
     std::vector<Geometry::Polygon> polygons;
     if (result.is_self_intersected() && Geometry::merge_ear_cut_triangles(Geometry::ear_cut_to_triangles(result), polygons))
@@ -5962,4 +5962,4 @@ bool Geometry::offset(const Geometry::AABBRect &input, Geometry::AABBRect &resul
     {
         return false;
     }
-}
+}
\ No newline at end of file
@@ -25,12 +25,14 @@ Geometry::Polygon::Polygon(std::vector<Geometry::Point>::const_iterator begin, s
     {
         _points.emplace_back(_points.front());
     }
+    update_cache();
 }
 
 Geometry::Polygon::Polygon(std::array<Point, 4>::const_iterator begin, std::array<Point, 4>::const_iterator end)
     : Geometry::Polyline(begin, end)
 {
     _points.emplace_back(_points.front());
+    update_cache();
 }
 
 Geometry::Polygon::Polygon(const std::initializer_list<Geometry::Point> &points)
@@ -41,6 +43,7 @@ Geometry::Polygon::Polygon(const std::initializer_list<Geometry::Point> &points)
     {
         _points.emplace_back(_points.front());
     }
+    update_cache();
 }
 
 Geometry::Polygon::Polygon(const Geometry::Polyline &polyline)
@@ -51,12 +54,13 @@ Geometry::Polygon::Polygon(const Geometry::Polyline &polyline)
     {
         _points.emplace_back(_points.front());
     }
+    update_cache();
 }
 
 Geometry::Polygon::Polygon(const Geometry::AABBRect &rect)
     : Geometry::Polyline(rect.cbegin(), rect.cend())
 {
-
+    update_cache();
 }
 
 Geometry::Polygon &Geometry::Polygon::operator=(const Geometry::Polygon &polygon)
@@ -76,6 +80,7 @@ Geometry::Polygon &Geometry::Polygon::operator=(const Rectangle &rect)
         _points.emplace_back(point);
     }
     _points.emplace_back(_points.front());
+    update_cache();
     return *this;
 }
 
@@ -132,6 +137,60 @@ bool Geometry::Polygon::is_cw() const
     return result < 0;
 }
 
+void Geometry::Polygon::update_cache()
+{
+    Geometry::Polyline::update_cache();
+    _convex = check_convex();
+}
+
+bool Geometry::Polygon::is_convex() const
+{
+    return _cached ? _convex : check_convex();
+}
+
+bool Geometry::Polygon::check_convex() const
+{
+    if (size() < 4 || _points.back() != _points.front())
+    {
+        return false;
+    }
+
+    // 相邻两边的叉积同号,且边的x方向最多改变两次,排除绕行多圈的星形多边形
+    const size_t count = size() - 1;
+    double sign = 0;
+    int last_dx = 0, first_dx = 0, changes = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Geometry::Vector edge0 = _points[i + 1] - _points[i];
+        const Geometry::Vector edge1 = _points[(i + 2) % count] - _points[i + 1];
+        const double value = edge0.cross(edge1);
+        if (value == 0 || value * sign < 0)
+        {
+            return false;
+        }
+        sign = value;
+
+        const int dx = edge0.x > 0 ? 1 : (edge0.x < 0 ? -1 : 0);
+        if (dx != 0)
+        {
+            if (first_dx == 0)
+            {
+                first_dx = dx;
+            }
+            else if (dx != last_dx)
+            {
+                ++changes;
+            }
+            last_dx = dx;
+        }
+    }
+    if (last_dx != first_dx)
+    {
+        ++changes;
+    }
+    return changes <= 2;
+}
+
 void Geometry::Polygon::append(const Geometry::Point &point)
 {
     if (size() < 2)
@@ -150,6 +209,7 @@ void Geometry::Polygon::append(const Geometry::Point &point)
             _points.emplace_back(_points.front());
         }
     }
+    update_cache();
 }
 
 void Geometry::Polygon::append(const Geometry::Polyline &polyline)
@@ -174,6 +234,7 @@ void Geometry::Polygon::append(const Geometry::Polyline &polyline)
             _points.emplace_back(_points.front());
         }
     }
+    update_cache();
 }
 
 void Geometry::Polygon::append(std::vector<Geometry::Point>::const_iterator begin, std::vector<Geometry::Point>::const_iterator end)
@@ -198,6 +259,7 @@ void Geometry::Polygon::append(std::vector<Geometry::Point>::const_iterator begi
             _points.emplace_back(_points.front());
         }
     }
+    update_cache();
 }
 
 void Geometry::Polygon::insert(const size_t index, const Geometry::Point &point)
@@ -207,6 +269,7 @@ void Geometry::Polygon::insert(const size_t index, const Geometry::Point &point)
     {
         _points.back() = _points.front();
     }
+    update_cache();
 }
 
 void Geometry::Polygon::insert(const size_t index, const Geometry::Polyline &polyline)
@@ -216,6 +279,7 @@ void Geometry::Polygon::insert(const size_t index, const Geometry::Polyline &pol
     {
         _points.back() = _points.front();
     }
+    update_cache();
 }
 
 void Geometry::Polygon::insert(const size_t index, std::vector<Geometry::Point>::const_iterator begin, std::vector<Geometry::Point>::const_iterator end)
@@ -225,6 +289,7 @@ void Geometry::Polygon::insert(const size_t index, std::vector<Geometry::Point>:
     {
         _points.back() = _points.front();
     }
+    update_cache();
 }
 
 void Geometry::Polygon::remove(const size_t index)
@@ -238,6 +303,7 @@ void Geometry::Polygon::remove(const size_t index)
     {
         _points.front() = _points.back();
     }
+    update_cache();
 }
 
 void Geometry::Polygon::remove(const size_t index, const size_t count)
@@ -254,6 +320,7 @@ void Geometry::Polygon::remove(const size_t index, const size_t count)
             _points.front() = _points.back();
         }
     }
+    update_cache();
 }
 
 Geometry::Point Geometry::Polygon::pop(const size_t index)
@@ -267,9 +334,26 @@ Geometry::Point Geometry::Polygon::pop(const size_t index)
     {
         _points.front() = _points.back();
     }
+    update_cache();
     return point;
 }
 
+void Geometry::Polygon::set_point(const size_t index, const Geometry::Point &point)
+{
+    assert(index < _points.size());
+    _points[index] = point;
+    // 首尾两点相同
+    if (index == 0)
+    {
+        _points.back() = point;
+    }
+    else if (index == _points.size() - 1)
+    {
+        _points.front() = point;
+    }
+    update_cache();
+}
+
 Geometry::Polygon Geometry::Polygon::operator+(const Geometry::Point &point) const
 {
     std::vector<Geometry::Point> temp(_points);
@@ -328,18 +412,6 @@ const Geometry::Point &Geometry::Polygon::next_point(const size_t index) const
     }
 }
 
-Geometry::Point &Geometry::Polygon::next_point(const size_t index)
-{
-    if (index < _points.size() - 1)
-    {
-        return _points[index + 1];
-    }
-    else
-    {
-        return _points[1];
-    }
-}
-
 size_t Geometry::Polygon::last_point_index(const size_t index) const
 {
     if (index > 0)
@@ -364,18 +436,6 @@ const Geometry::Point &Geometry::Polygon::last_point(const size_t index) const
     }
 }
 
-Geometry::Point &Geometry::Polygon::last_point(const size_t index)
-{
-    if (index > 0)
-    {
-        return _points[index - 1];
-    }
-    else
-    {
-        return _points[_points.size() - 2];
-    }
-}
-
 size_t Geometry::Polygon::index(const double x, const double y) const
 {
     for (size_t i = 0, count = _points.size() - 1; i < count; ++i)
@@ -402,11 +462,9 @@ size_t Geometry::Polygon::index(const Geometry::Point &point) const
 
 Geometry::Point Geometry::Polygon::average_point() const
 {
-    Geometry::Point point;
-    for (size_t i = 0, count = _points.size() - 1; i < count; ++i)
-    {
-        point += _points[i];
-    }
+    // 首尾重合的点只计算一次
+    Geometry::Point point(points_sum());
+    point -= _points.back();
     point.x /= (_points.size() - 1);
     point.y /= (_points.size() - 1);
     return point;
@@ -15,7 +15,8 @@ Geometry::Polyline::Polyline()
 }
 
 Geometry::Polyline::Polyline(const Geometry::Polyline &polyline)
-    : Geometry::GeometryObject(polyline), _points(polyline._points)
+    : Geometry::GeometryObject(polyline), _points(polyline._points), _left(polyline._left), _top(polyline._top), _right(polyline._right),
+    _bottom(polyline._bottom), _sum(polyline._sum), _cached(polyline._cached), _convex(polyline._convex)
 {
 
 }
@@ -30,6 +31,7 @@ Geometry::Polyline::Polyline(std::vector<Geometry::Point>::const_iterator begin,
             _points.emplace_back(*begin);
         }
     }
+    update_cache();
 }
 
 Geometry::Polyline::Polyline(std::array<Point, 4>::const_iterator begin, std::array<Point, 4>::const_iterator end)
@@ -38,6 +40,7 @@ Geometry::Polyline::Polyline(std::array<Point, 4>::const_iterator begin, std::ar
     {
         _points.emplace_back(*(begin++));
     }
+    update_cache();
 }
 
 Geometry::Polyline::Polyline(const std::initializer_list<Geometry::Point> &points)
@@ -50,6 +53,56 @@ Geometry::Polyline::Polyline(const std::initializer_list<Geometry::Point> &point
             _points.emplace_back(point);
         }
     }
+    update_cache();
+}
+
+void Geometry::Polyline::update_cache()
+{
+    _left = _bottom = DBL_MAX;
+    _right = _top = -DBL_MAX;
+    _sum.clear();
+    for (const Point &point : _points)
+    {
+        _left = std::min(_left, point.x);
+        _bottom = std::min(_bottom, point.y);
+        _right = std::max(_right, point.x);
+        _top = std::max(_top, point.y);
+        _sum.x += point.x;
+        _sum.y += point.y;
+    }
+    _cached = true;
+}
+
+void Geometry::Polyline::extend_cache(const size_t first)
+{
+    if (!_cached || first == 0)
+    {
+        return update_cache();
+    }
+    for (size_t i = first, count = _points.size(); i < count; ++i)
+    {
+        _left = std::min(_left, _points[i].x);
+        _bottom = std::min(_bottom, _points[i].y);
+        _right = std::max(_right, _points[i].x);
+        _top = std::max(_top, _points[i].y);
+        _sum.x += _points[i].x;
+        _sum.y += _points[i].y;
+    }
+}
+
+Geometry::Point Geometry::Polyline::points_sum() const
+{
+    if (_cached)
+    {
+        return _sum;
+    }
+    Geometry::Point sum;
+    for (const Point &point : _points)
+    {
+        sum.x += point.x;
+        sum.y += point.y;
+    }
+    return sum;
 }
 
 size_t Geometry::Polyline::size() const
@@ -75,6 +128,7 @@ double Geometry::Polyline::length() const
 void Geometry::Polyline::clear()
 {
     _points.clear();
+    update_cache();
 }
 
 Geometry::Polyline *Geometry::Polyline::clone() const
@@ -110,16 +164,17 @@ bool Geometry::Polyline::is_self_intersected() const
     return false;
 }
 
-Geometry::Point &Geometry::Polyline::operator[](const size_t index)
+const Geometry::Point &Geometry::Polyline::operator[](const size_t index) const
 {
     assert(index < _points.size());
     return _points[index];
 }
 
-const Geometry::Point &Geometry::Polyline::operator[](const size_t index) const
+void Geometry::Polyline::set_point(const size_t index, const Geometry::Point &point)
 {
     assert(index < _points.size());
-    return _points[index];
+    _points[index] = point;
+    update_cache();
 }
 
 Geometry::Polyline &Geometry::Polyline::operator=(const Geometry::Polyline &polyline)
@@ -128,6 +183,13 @@ Geometry::Polyline &Geometry::Polyline::operator=(const Geometry::Polyline &poly
     {
         Geometry::GeometryObject::operator=(polyline);
         _points = polyline._points;
+        _left = polyline._left;
+        _top = polyline._top;
+        _right = polyline._right;
+        _bottom = polyline._bottom;
+        _sum = polyline._sum;
+        _cached = polyline._cached;
+        _convex = polyline._convex;
     }
     return *this;
 }
@@ -158,6 +220,7 @@ void Geometry::Polyline::operator+=(const Geometry::Point &point)
     {
         p += point;
     }
+    update_cache();
 }
 
 void Geometry::Polyline::operator-=(const Geometry::Point &point)
@@ -166,18 +229,22 @@ void Geometry::Polyline::operator-=(const Geometry::Point &point)
     {
         p -= point;
     }
+    update_cache();
 }
 
 void Geometry::Polyline::append(const Geometry::Point &point)
 {
+    const size_t first = _points.size();
     if (_points.empty() || _points.back() != point)
     {
         _points.emplace_back(point);
     }
+    extend_cache(first);
 }
 
 void Geometry::Polyline::append(const Geometry::Polyline &polyline)
 {
+    const size_t first = _points.size();
     if (_points.empty() ||  _points.back() != polyline._points.front())
     {
         _points.insert(_points.cend(), polyline._points.cbegin(), polyline._points.cend());
@@ -186,10 +253,12 @@ void Geometry::Polyline::append(const Geometry::Polyline &polyline)
     {
         _points.insert(_points.cend(), polyline._points.cbegin() + 1, polyline._points.cend());
     }
+    extend_cache(first);
 }
 
 void Geometry::Polyline::append(std::vector<Geometry::Point>::const_iterator begin, std::vector<Geometry::Point>::const_iterator end)
 {
+    const size_t first = _points.size();
     if (_points.empty() || _points.back() != *begin)
     {
         _points.insert(_points.cend(), begin, end);
@@ -198,6 +267,7 @@ void Geometry::Polyline::append(std::vector<Geometry::Point>::const_iterator beg
     {
         _points.insert(_points.cend(), begin + 1, end);
     }
+    extend_cache(first);
 }
 
 void Geometry::Polyline::insert(const size_t index, const Geometry::Point &point)
@@ -211,6 +281,7 @@ void Geometry::Polyline::insert(const size_t index, const Geometry::Point &point
     {
         _points.insert(_points.cbegin() + index, point);
     }
+    update_cache();
 }
 
 void Geometry::Polyline::insert(const size_t index, const Geometry::Polyline &polyline)
@@ -222,6 +293,7 @@ void Geometry::Polyline::insert(const size_t index, const Geometry::Polyline &po
     }
     int i = (index > 0 && _points[index - 1] == polyline._points.front()), j = _points[index] == polyline._points.back();
     _points.insert(_points.cbegin() + index, polyline._points.cbegin() + i, polyline._points.cend() - j);
+    update_cache();
 }
 
 void Geometry::Polyline::insert(const size_t index, std::vector<Geometry::Point>::const_iterator begin, std::vector<Geometry::Point>::const_iterator end)
@@ -234,18 +306,21 @@ void Geometry::Polyline::insert(const size_t index, std::vector<Geometry::Point>
     {
         _points.erase(_points.begin() + index + len + 1);
     }
+    update_cache();
 }
 
 void Geometry::Polyline::remove(const size_t index)
 {
     assert(index < _points.size());
     _points.erase(_points.begin() + index);
+    update_cache();
 }
 
 void Geometry::Polyline::remove(const size_t index, const size_t count)
 {
     assert(index < _points.size());
     _points.erase(_points.begin() + index, _points.begin() + index + count);
+    update_cache();
 }
 
 Geometry::Point Geometry::Polyline::pop(const size_t index)
@@ -253,6 +328,7 @@ Geometry::Point Geometry::Polyline::pop(const size_t index)
     assert(index < _points.size());
     Geometry::Point point(_points[index]);
     _points.erase(_points.begin() + index);
+    update_cache();
     return point;
 }
 
@@ -261,35 +337,18 @@ void Geometry::Polyline::flip()
     std::reverse(_points.begin(), _points.end());
 }
 
-Geometry::Point &Geometry::Polyline::front()
-{
-    assert(!empty());
-    return _points.front();
-}
-
 const Geometry::Point &Geometry::Polyline::front() const
 {
     assert(!empty());
     return _points.front();
 }
 
-Geometry::Point &Geometry::Polyline::back()
-{
-    assert(!empty());
-    return _points.back();
-}
-
 const Geometry::Point &Geometry::Polyline::back() const
 {
     assert(!empty());
     return _points.back();
 }
 
-std::vector<Geometry::Point>::iterator Geometry::Polyline::begin()
-{
-    return _points.begin();
-}
-
 std::vector<Geometry::Point>::const_iterator Geometry::Polyline::begin() const
 {
     return _points.cbegin();
@@ -300,11 +359,6 @@ std::vector<Geometry::Point>::const_iterator Geometry::Polyline::cbegin() const
     return _points.cbegin();
 }
 
-std::vector<Geometry::Point>::iterator Geometry::Polyline::end()
-{
-    return _points.end();
-}
-
 std::vector<Geometry::Point>::const_iterator Geometry::Polyline::end() const
 {
     return _points.cend();
@@ -315,11 +369,6 @@ std::vector<Geometry::Point>::const_iterator Geometry::Polyline::cend() const
     return _points.cend();
 }
 
-std::vector<Geometry::Point>::reverse_iterator Geometry::Polyline::rbegin()
-{
-    return _points.rbegin();
-}
-
 std::vector<Geometry::Point>::const_reverse_iterator Geometry::Polyline::rbegin() const
 {
     return _points.crbegin();
@@ -330,11 +379,6 @@ std::vector<Geometry::Point>::const_reverse_iterator Geometry::Polyline::crbegin
     return _points.crbegin();
 }
 
-std::vector<Geometry::Point>::reverse_iterator Geometry::Polyline::rend()
-{
-    return _points.rend();
-}
-
 std::vector<Geometry::Point>::const_reverse_iterator Geometry::Polyline::rend() const
 {
     return _points.crend();
@@ -345,11 +389,6 @@ std::vector<Geometry::Point>::const_reverse_iterator Geometry::Polyline::crend()
     return _points.crend();
 }
 
-std::vector<Geometry::Point>::iterator Geometry::Polyline::find(const Geometry::Point &point)
-{
-    return std::find(_points.begin(), _points.end(), point);
-}
-
 std::vector<Geometry::Point>::const_iterator Geometry::Polyline::find(const Geometry::Point &point) const
 {
     return std::find(_points.cbegin(), _points.cend(), point);
@@ -358,26 +397,44 @@ std::vector<Geometry::Point>::const_iterator Geometry::Polyline::find(const Geom
 void Geometry::Polyline::transform(const double a, const double b, const double c, const double d, const double e, const double f)
 {
     std::for_each(_points.begin(), _points.end(), [=](Geometry::Point &point){point.transform(a,b,c,d,e,f);});
+    update_cache();
 }
 
 void Geometry::Polyline::transform(const double mat[6])
 {
     std::for_each(_points.begin(), _points.end(), [=](Geometry::Point &point){point.transform(mat);});
+    update_cache();
 }
 
 void Geometry::Polyline::translate(const double tx, const double ty)
 {
     std::for_each(_points.begin(), _points.end(), [=](Geometry::Point &point){point.translate(tx, ty);});
+    // 平移不改变形状,直接平移缓存
+    if (_cached)
+    {
+        _left += tx;
+        _right += tx;
+        _top += ty;
+        _bottom += ty;
+        _sum.x += tx * _points.size();
+        _sum.y += ty * _points.size();
+    }
+    else
+    {
+        update_cache();
+    }
 }
 
 void Geometry::Polyline::rotate(const double x, const double y, const double rad)
 {
     std::for_each(_points.begin(), _points.end(), [=](Geometry::Point &point){point.rotate(x, y, rad);});
+    update_cache();
 }
 
 void Geometry::Polyline::scale(const double x, const double y, const double k)
 {
     std::for_each(_points.begin(), _points.end(), [=](Geometry::Point &point){point.scale(x, y, k);});
+    update_cache();
 }
 
 Geometry::Type Geometry::Polyline::type() const
@@ -474,15 +531,19 @@ Geometry::AABBRect Geometry::Polyline::bounding_rect() const
         return Geometry::AABBRect();
     }
 
-    double x0 = DBL_MAX, y0 = DBL_MAX, x1 = (-FLT_MAX), y1 = (-FLT_MAX);
+    if (_cached)
+    {
+        return Geometry::AABBRect(_left, _top, _right, _bottom);
+    }
+    double left = DBL_MAX, top = -DBL_MAX, right = -DBL_MAX, bottom = DBL_MAX;
     for (const Point &point : _points)
     {
-        x0 = std::min(x0, point.x);
-        y0 = std::min(y0, point.y);
-        x1 = std::max(x1, point.x);
-        y1 = std::max(y1, point.y);
+        left = std::min(left, point.x);
+        bottom = std::min(bottom, point.y);
+        right = std::max(right, point.x);
+        top = std::max(top, point.y);
     }
-    return Geometry::AABBRect(x0, y1, x1, y0);
+    return Geometry::AABBRect(left, top, right, bottom);
 }
 
 Geometry::Polygon Geometry::Polyline::mini_bounding_rect() const
@@ -514,12 +575,7 @@ Geometry::Polygon Geometry::Polyline::mini_bounding_rect() const
 
 Geometry::Point Geometry::Polyline::average_point() const
 {
-    Geometry::Point point;
-    for (const Geometry::Point &p : _points)
-    {
-        point.x += p.x;
-        point.y += p.y;
-    }
+    Geometry::Point point(points_sum());
     point.x /= _points.size();
     point.y /= _points.size();
     return point;
@@ -0,0 +1,251 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "Regression.hpp"
+#include "Math/Collision/Algorithm.hpp"
+#include "Math/Geometry/Algorithm.hpp"
+#include "Math/Geometry/AllGeometryObjects.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+// 检查GJK/EPA的冷启动(无缓存)、热启动(GJKCache)与参考结果是否一致
+
+static const size_t KIND_COUNT = 10;
+static const char *KIND_NAMES[KIND_COUNT] = {"Polygon", "AABBRect", "Rectangle", "Square", "Triangle", "Circle", "Polyline", "Line", "Point", "Bezier"};
+
+// 前5种为多边形,可用凸包的多边形求交作为参考结果;圆用圆心到凸包的距离作为参考结果
+static bool has_reference(const size_t kind)
+{
+    return kind < 6;
+}
+
+static Geometry::GeometryObject *create(const size_t kind, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> position(0, 40), size(3, 15);
+    const double x = position(rng), y = position(rng), s = size(rng);
+    switch (kind)
+    {
+    case 0:
+        return new Geometry::Polygon({Geometry::Point(x, y), Geometry::Point(x + s, y), Geometry::Point(x + s * 0.5, y + s), Geometry::Point(x, y)});
+    case 1:
+        return new Geometry::AABBRect(x, y + s, x + s, y);
+    case 2:
+        return new Geometry::Rectangle(x, y, s, s * 0.6);
+    case 3:
+        return new Geometry::Square(x, y, s);
+    case 4:
+        return new Geometry::Triangle(x, y, x + s, y, x, y + s);
+    case 5:
+        return new Geometry::Circle(x, y, s / 2);
+    case 6:
+        return new Geometry::Polyline({Geometry::Point(x, y), Geometry::Point(x + s, y + s), Geometry::Point(x + 2 * s, y)});
+    case 7:
+        return new Geometry::Line(x, y, x + s, y + s * 0.3);
+    case 8:
+        return new Geometry::Point(x, y);
+    default:
+        return new Geometry::Bezier({Geometry::Point(x, y), Geometry::Point(x + s, y), Geometry::Point(x + 2 * s, y + s)}, 2);
+    }
+}
+
+static Geometry::Polygon *create_ngon(const double x, const double y, const double r, const size_t n, const double angle)
+{
+    std::vector<Geometry::Point> points;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double a = angle + 2 * Geometry::PI * i / n;
+        points.emplace_back(x + r * std::cos(a), y + r * std::sin(a));
+    }
+    points.push_back(points.front());
+    return new Geometry::Polygon(points.cbegin(), points.cend());
+}
+
+// 圆心在凸包内或到凸包某条边的距离不大于半径时相交
+static bool reference(const Geometry::Circle &circle, const Geometry::GeometryObject *object)
+{
+    if (object->type() == Geometry::Type::CIRCLE)
+    {
+        const Geometry::Circle &other = *static_cast<const Geometry::Circle *>(object);
+        return Geometry::distance(circle, other) <= circle.radius + other.radius;
+    }
+    const Geometry::Polygon hull = object->convex_hull();
+    if (Geometry::is_inside(circle, hull, true))
+    {
+        return true;
+    }
+    for (size_t i = 1, count = hull.size(); i < count; ++i)
+    {
+        if (Geometry::distance(circle, hull[i - 1], hull[i]) <= circle.radius)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool reference(const Geometry::GeometryObject *object0, const Geometry::GeometryObject *object1)
+{
+    if (object0->type() == Geometry::Type::CIRCLE)
+    {
+        return reference(*static_cast<const Geometry::Circle *>(object0), object1);
+    }
+    if (object1->type() == Geometry::Type::CIRCLE)
+    {
+        return reference(*static_cast<const Geometry::Circle *>(object1), object0);
+    }
+    return Geometry::is_intersected(object0->convex_hull(), object1->convex_hull());
+}
+
+// 逐个类型对生成随机对象,object1每帧小步移动并复用同一个GJKCache
+// asym: gjk(a, b)与gjk(b, a)不同; warm: 热启动与冷启动不同; ref: 冷启动或热启动与参考结果不同
+static size_t check_type_pairs(const unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> step(-1, 1);
+    size_t asymmetric[KIND_COUNT][KIND_COUNT] = {}, warm[KIND_COUNT][KIND_COUNT] = {}, wrong[KIND_COUNT][KIND_COUNT] = {};
+    size_t total = 0;
+    for (size_t trial = 0; trial < 200; ++trial)
+    {
+        for (size_t i = 0; i < KIND_COUNT; ++i)
+        {
+            for (size_t j = 0; j < KIND_COUNT; ++j)
+            {
+                Geometry::GeometryObject *object0 = create(i, rng), *object1 = create(j, rng);
+                const Geometry::GeometryObject *shape0 = object0, *shape1 = object1;
+                Collision::GJKCache cache;
+                const double dx = step(rng), dy = step(rng);
+                for (size_t frame = 0; frame < 8; ++frame)
+                {
+                    const bool cold = Collision::gjk(shape0, shape1);
+                    if (cold != Collision::gjk(shape1, shape0))
+                    {
+                        ++asymmetric[i][j];
+                    }
+                    const bool result = Collision::gjk(shape0, shape1, cache);
+                    if (result != cold)
+                    {
+                        ++warm[i][j];
+                    }
+                    if (has_reference(i) && has_reference(j))
+                    {
+                        const bool expected = reference(shape0, shape1);
+                        if (cold != expected || result != expected)
+                        {
+                            ++wrong[i][j];
+                        }
+                    }
+                    object1->translate(dx, dy);
+                }
+                delete object0;
+                delete object1;
+            }
+        }
+    }
+
+    std::printf("type pairs, asym/warm/ref mismatches\n%-10s", "");
+    for (size_t j = 0; j < KIND_COUNT; ++j)
+    {
+        std::printf(" %10s", KIND_NAMES[j]);
+    }
+    std::printf("\n");
+    for (size_t i = 0; i < KIND_COUNT; ++i)
+    {
+        std::printf("%-10s", KIND_NAMES[i]);
+        for (size_t j = 0; j < KIND_COUNT; ++j)
+        {
+            std::printf(" %4zu/%zu/%-3zu", asymmetric[i][j], warm[i][j], wrong[i][j]);
+            total += asymmetric[i][j] + warm[i][j] + wrong[i][j];
+        }
+        std::printf("\n");
+    }
+    return total;
+}
+
+// 300个多边形、矩形与三角形匀速移动60帧,每个AABB矩形相交的对象对持有一个GJKCache
+// 冷启动与热启动的gjk结果不同时以多边形求交为准,分别统计两者的错误数;相交的对象对再比较两者的EPA深度
+static size_t check_coherent_motion(const unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> position(0, 80), radius(4, 12), angle(0, 2 * Geometry::PI), velocity(-0.05, 0.05);
+    std::vector<Geometry::GeometryObject *> objects;
+    std::vector<Geometry::Vector> velocities;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        const double x = position(rng), y = position(rng), r = radius(rng);
+        switch (i % 4)
+        {
+        case 0:
+            objects.push_back(create_ngon(x, y, r, 64, angle(rng)));
+            break;
+        case 1:
+            objects.push_back(new Geometry::Rectangle(x, y, r, r));
+            break;
+        case 2:
+            objects.push_back(new Geometry::Triangle(x, y, x + r, y, x, y + r));
+            break;
+        default:
+            objects.push_back(create_ngon(x, y, r, 6, angle(rng)));
+            break;
+        }
+        velocities.emplace_back(velocity(rng), velocity(rng));
+    }
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = 0, count = objects.size(); i < count; ++i)
+    {
+        for (size_t j = i + 1; j < count; ++j)
+        {
+            if (Geometry::is_intersected(objects[i]->bounding_rect(), objects[j]->bounding_rect()))
+            {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+
+    std::vector<Collision::GJKCache> caches(pairs.size());
+    size_t hits = 0, disagreements = 0, cold_wrong = 0, warm_wrong = 0, epa_mismatches = 0;
+    Geometry::Vector vec;
+    for (size_t frame = 0; frame < 60; ++frame)
+    {
+        for (size_t i = 0, count = objects.size(); i < count; ++i)
+        {
+            objects[i]->translate(velocities[i].x, velocities[i].y);
+        }
+        for (size_t k = 0, count = pairs.size(); k < count; ++k)
+        {
+            const Geometry::GeometryObject *object0 = objects[pairs[k].first], *object1 = objects[pairs[k].second];
+            const bool cold = Collision::gjk(object0, object1), warm = Collision::gjk(object0, object1, caches[k]);
+            if (cold != warm)
+            {
+                ++disagreements;
+                const bool expected = reference(object0, object1);
+                cold_wrong += cold != expected;
+                warm_wrong += warm != expected;
+            }
+            if (cold)
+            {
+                ++hits;
+                const double depth = Collision::epa(object0, object1, vec);
+                if (std::abs(depth - Collision::epa(object0, object1, vec, caches[k])) > 1e-6)
+                {
+                    ++epa_mismatches;
+                }
+            }
+        }
+    }
+    std::printf("\ncoherent motion, %zu pairs x 60 frames, %zu hits\n", pairs.size(), hits);
+    std::printf("cold/warm disagreements %zu, cold/warm ref mismatches %zu/%zu, epa mismatches %zu\n", disagreements, cold_wrong, warm_wrong,
+        epa_mismatches);
+
+    for (Geometry::GeometryObject *object : objects)
+    {
+        delete object;
+    }
+    return cold_wrong + warm_wrong + epa_mismatches;
+}
+
+size_t check_gjk(const unsigned int seed)
+{
+    return check_type_pairs(seed) + check_coherent_motion(seed);
+}
\ No newline at end of file
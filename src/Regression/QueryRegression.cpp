@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "Regression.hpp"
+#include "Math/Collision/GridMap.hpp"
+#include "Math/Collision/QuadTree.hpp"
+#include "Math/Collision/Nearest.hpp"
+#include "Math/Geometry/Algorithm.hpp"
+#include "Math/Geometry/AllGeometryObjects.hpp"
+
+
+using namespace ToyGameEngine::Math;
+
+// 对象逐个append,根节点与网格随之扩展,原边界成为内部的节点边界
+// 约1/3的对象对齐到50的整数倍,使对象的边与线段常落在节点边界上
+static void generate(std::mt19937 &rng, std::vector<Geometry::GeometryObject *> &objects)
+{
+    std::uniform_real_distribution<double> position(-2000, 4500), size(1, 60), unit(0, 1);
+    for (size_t i = 0; i < 600; ++i)
+    {
+        double x = position(rng), y = position(rng);
+        const double s = size(rng);
+        if (unit(rng) < 0.3)
+        {
+            x = std::round(x / 50) * 50;
+            y = std::round(y / 50) * 50;
+        }
+        switch (i % 5)
+        {
+        case 0:
+            objects.push_back(new Geometry::AABBRect(x, y + s, x + s, y));
+            break;
+        case 1:
+            objects.push_back(new Geometry::Circle(x, y, s / 2));
+            break;
+        case 2:
+            objects.push_back(new Geometry::Triangle(x, y, x + s, y, x, y + s));
+            break;
+        case 3:
+            objects.push_back(new Geometry::Line(x, y, x, y + s));
+            break;
+        default:
+            objects.push_back(new Geometry::Line(x, y, x + s, y));
+            break;
+        }
+    }
+}
+
+template <typename T>
+static size_t check_detector(const T &detector, const std::vector<Geometry::GeometryObject *> &objects, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> position(-2000, 4500), radius(5, 300);
+    std::uniform_int_distribution<size_t> count(1, 10);
+    std::vector<std::pair<Geometry::GeometryObject *, double>> expected, result;
+    std::vector<Geometry::GeometryObject *> selected;
+    size_t failures = 0;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        const Geometry::Point pos(position(rng), position(rng));
+        const double r = radius(rng);
+        const size_t k = count(rng);
+        expected.clear();
+        for (Geometry::GeometryObject *object : objects)
+        {
+            expected.emplace_back(object, Collision::distance(pos, object));
+        }
+        std::sort(expected.begin(), expected.end(), Collision::is_nearer);
+
+        // knn按距离比较,距离相同的对象可互换
+        result.clear();
+        detector.query_knn(pos, k, result);
+        bool passed = result.size() == std::min(k, expected.size());
+        for (size_t j = 0; passed && j < result.size(); ++j)
+        {
+            passed = std::abs(result[j].second - expected[j].second) <= Geometry::EPSILON
+                && std::count_if(result.begin(), result.end(), [&](const std::pair<Geometry::GeometryObject *, double> &item)
+                    { return item.first == result[j].first; }) == 1;
+        }
+        failures += !passed;
+
+        result.clear();
+        detector.query_radius(pos, r, result);
+        failures += result.size() != static_cast<size_t>(std::count_if(expected.begin(), expected.end(),
+            [&](const std::pair<Geometry::GeometryObject *, double> &item) { return item.second <= r; }));
+
+        const Geometry::AABBRect rect(pos.x - r, pos.y + r, pos.x + r, pos.y - r);
+        selected.clear();
+        detector.select(rect, selected);
+        std::sort(selected.begin(), selected.end());
+        failures += std::unique(selected.begin(), selected.end()) != selected.end()
+            || selected.size() != static_cast<size_t>(std::count_if(objects.begin(), objects.end(),
+                [&](const Geometry::GeometryObject *object) { return Collision::GridNode::is_selected(rect, object); }));
+    }
+    return failures;
+}
+
+size_t check_queries(const unsigned int seed)
+{
+    size_t quadtree = 0, loose = 0, gridmap = 0;
+    for (unsigned int i = 0; i < 20; ++i)
+    {
+        std::mt19937 rng(seed + i);
+        std::vector<Geometry::GeometryObject *> objects;
+        generate(rng, objects);
+
+        Collision::QuadTreeConfig config;
+        Collision::QuadTree tree;
+        config.looseness = 0.5;
+        Collision::QuadTree loose_tree(config);
+        Collision::GridMap map;
+        for (Geometry::GeometryObject *object : objects)
+        {
+            tree.append(object);
+            loose_tree.append(object);
+            map.append(object);
+        }
+        quadtree += check_detector(tree, objects, rng);
+        loose += check_detector(loose_tree, objects, rng);
+        gridmap += check_detector(map, objects, rng);
+
+        for (Geometry::GeometryObject *object : objects)
+        {
+            delete object;
+        }
+    }
+    std::printf("\nqueries after append, select/radius/knn mismatches\n");
+    std::printf("QuadTree %zu, loose QuadTree %zu, GridMap %zu\n", quadtree, loose, gridmap);
+    return quadtree + loose + gridmap;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+// 各项检查输出统计结果,返回不一致的数量
+
+// GJK/EPA的冷启动、热启动与参考结果
+size_t check_gjk(const unsigned int seed);
+
+// 逐个append使根节点扩展后,QuadTree与GridMap的select、query_radius与query_knn与逐个检测的结果
+size_t check_queries(const unsigned int seed);
\ No newline at end of file
@@ -0,0 +1,15 @@
+#include <cstdio>
+#include <string>
+#include "Regression.hpp"
+
+
+// 碰撞检测的回归检查,有不一致时返回1
+// 用法: CollisionRegression [随机种子]
+
+int main(int argc, char *argv[])
+{
+    const unsigned int seed = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 5;
+    const size_t failures = check_gjk(seed) + check_queries(seed);
+    std::printf("\n%s\n", failures == 0 ? "passed" : "failed");
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file